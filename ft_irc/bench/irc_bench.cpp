@@ -0,0 +1,538 @@
+/* ************************************************************************** */
+/*                                                                            */
+/*                                                        :::      ::::::::   */
+/*   irc_bench.cpp                                      :+:      :+:    :+:   */
+/*                                                    +:+ +:+         +:+     */
+/*   By: kpourcel <marvin@42.fr>                    +#+  +:+       +#+        */
+/*                                                +#+#+#+#+#+   +#+           */
+/*   Created: 2025/04/14 15:12:40 by kpourcel          #+#    #+#             */
+/*   Updated: 2025/04/14 15:12:40 by kpourcel         ###   ########.fr       */
+/*                                                                            */
+/* ************************************************************************** */
+
+#include "../include/EventLoop.hpp"
+#include "../include/RecvBuffer.hpp"
+
+#include <iostream>
+#include <iomanip>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <cstdio>
+#include <cerrno>
+#include <ctime>
+#include <unistd.h>
+#include <fcntl.h>
+#include <sys/socket.h>
+#include <sys/resource.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <arpa/inet.h>
+
+/**
+ * Générateur de charge pour ircserv.
+ *
+ * Ouvre N clients enregistrés (PASS/NICK/USER puis JOIN d'un channel), puis
+ * envoie à débit constant un mélange de PRIVMSG vers un channel, PRIVMSG
+ * vers un pseudo, PART/JOIN et NICK. Chaque PRIVMSG porte son instant
+ * d'émission (CLOCK_MONOTONIC) : la latence de bout en bout est mesurée à
+ * chaque réception, donc pour chaque membre servi par un broadcast.
+ *
+ * Usage : ./irc_bench [--host=127.0.0.1] [--port=6667] [--password=pw]
+ *                     [--clients=1000] [--channels=50] [--rate=20000]
+ *                     [--duration=10] [--mix=chan:70,user:20,churn:5,nick:5]
+ */
+
+enum OpType {
+    OP_CHAN,
+    OP_USER,
+    OP_CHURN,
+    OP_NICK,
+    OP_COUNT
+};
+
+static const char* OP_NAMES[OP_COUNT] = { "chan", "user", "churn", "nick" };
+
+struct BenchOptions {
+    std::string host;
+    int         port;
+    std::string password;
+    int         clients;
+    int         channels;
+    long        rate;
+    int         duration;
+    int         mix[OP_COUNT];
+};
+
+struct BenchClient {
+    int         fd;
+    int         id;
+    int         generation;
+    std::string nick;
+    int         channel;
+    bool        alive;
+    bool        registered;
+    bool        joined;
+    bool        writeArmed;
+    RecvBuffer  input;
+    std::string output;
+};
+
+struct BenchStats {
+    bool                measuring;
+    long                sent[OP_COUNT];
+    long                delivered;
+    long                errors;
+    long                disconnected;
+    std::vector<long>   latencies;
+};
+
+static EventLoop*                   loop = NULL;
+static std::vector<BenchClient*>    clients;
+static std::vector<BenchClient*>    byFd;
+static BenchStats                   stats;
+static unsigned long                rngState = 88172645463325252UL;
+
+/* -------------------------------------------------------------------------- */
+/*                                Utilitaires                                 */
+/* -------------------------------------------------------------------------- */
+
+static long nowNs() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1000000000L + ts.tv_nsec;
+}
+
+static unsigned long nextRandom() {
+    rngState ^= rngState << 13;
+    rngState ^= rngState >> 7;
+    rngState ^= rngState << 17;
+    return rngState;
+}
+
+static std::string toString(long value) {
+    std::ostringstream out;
+    out << value;
+    return out.str();
+}
+
+static std::string channelName(int channel) {
+    return "#bench" + toString(channel);
+}
+
+/**
+ * @brief Relève la limite de descripteurs au maximum autorisé.
+ */
+static void raiseFileLimit() {
+    struct rlimit limit;
+    if (getrlimit(RLIMIT_NOFILE, &limit) == 0 && limit.rlim_cur < limit.rlim_max) {
+        limit.rlim_cur = limit.rlim_max;
+        setrlimit(RLIMIT_NOFILE, &limit);
+    }
+}
+
+/**
+ * @brief Lit "chan:70,user:20,churn:5,nick:5" (les types absents valent 0).
+ */
+static bool parseMix(const std::string& value, int mix[OP_COUNT]) {
+    for (int i = 0; i < OP_COUNT; ++i)
+        mix[i] = 0;
+    std::istringstream in(value);
+    std::string item;
+    while (std::getline(in, item, ',')) {
+        size_t colon = item.find(':');
+        if (colon == std::string::npos)
+            return false;
+        std::string name = item.substr(0, colon);
+        int weight = std::atoi(item.c_str() + colon + 1);
+        int op = 0;
+        while (op < OP_COUNT && name != OP_NAMES[op])
+            ++op;
+        if (op == OP_COUNT || weight < 0)
+            return false;
+        mix[op] = weight;
+    }
+    int total = 0;
+    for (int i = 0; i < OP_COUNT; ++i)
+        total += mix[i];
+    return total > 0;
+}
+
+static bool parseOptions(int argc, char** argv, BenchOptions& opts) {
+    opts.host = "127.0.0.1";
+    opts.port = 6667;
+    opts.password = "pw";
+    opts.clients = 1000;
+    opts.channels = 50;
+    opts.rate = 20000;
+    opts.duration = 10;
+    parseMix("chan:70,user:20,churn:5,nick:5", opts.mix);
+
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        size_t eq = arg.find('=');
+        if (arg.compare(0, 2, "--") != 0 || eq == std::string::npos)
+            return false;
+        std::string key = arg.substr(2, eq - 2);
+        std::string value = arg.substr(eq + 1);
+        if (key == "host")
+            opts.host = value;
+        else if (key == "port")
+            opts.port = std::atoi(value.c_str());
+        else if (key == "password")
+            opts.password = value;
+        else if (key == "clients")
+            opts.clients = std::atoi(value.c_str());
+        else if (key == "channels")
+            opts.channels = std::atoi(value.c_str());
+        else if (key == "rate")
+            opts.rate = std::atol(value.c_str());
+        else if (key == "duration")
+            opts.duration = std::atoi(value.c_str());
+        else if (key == "mix") {
+            if (!parseMix(value, opts.mix))
+                return false;
+        } else
+            return false;
+    }
+    return opts.port > 0 && opts.clients > 1 && opts.channels > 0 && opts.rate > 0 && opts.duration > 0;
+}
+
+/* -------------------------------------------------------------------------- */
+/*                                Entrées / Sorties                           */
+/* -------------------------------------------------------------------------- */
+
+static void flush(BenchClient* client) {
+    size_t offset = 0;
+    while (offset < client->output.size()) {
+        ssize_t sent = send(client->fd, client->output.data() + offset,
+                            client->output.size() - offset, MSG_NOSIGNAL);
+        if (sent < 0) {
+            if (errno == EINTR)
+                continue;
+            break;
+        }
+        offset += sent;
+    }
+    client->output.erase(0, offset);
+
+    bool wantWrite = !client->output.empty();
+    if (wantWrite != client->writeArmed) {
+        loop->modify(client->fd, wantWrite ? (EVENT_READ | EVENT_WRITE) : EVENT_READ);
+        client->writeArmed = wantWrite;
+    }
+}
+
+static void queue(BenchClient* client, const std::string& line) {
+    if (!client->alive)
+        return;
+    client->output += line;
+    client->output += "\r\n";
+    flush(client);
+}
+
+static void closeClient(BenchClient* client) {
+    if (!client->alive)
+        return;
+    client->alive = false;
+    loop->remove(client->fd);
+    close(client->fd);
+    ++stats.disconnected;
+}
+
+/**
+ * @brief Traite une ligne reçue : enregistrement, JOIN, PING, erreurs et
+ *        mesure de latence des PRIVMSG du benchmark.
+ */
+static void handleLine(BenchClient* client, const char* line, size_t length, long now) {
+    static const char marker[] = " :bench ";
+    const char* end = line + length;
+
+    if (length > 5 && std::memcmp(line, "PING ", 5) == 0) {
+        queue(client, "PONG " + std::string(line + 5, length - 5));
+        return;
+    }
+
+    const char* found = std::search(line, end, marker, marker + sizeof(marker) - 1);
+    if (found != end) {
+        long sentAt = std::strtol(found + sizeof(marker) - 1, NULL, 10);
+        if (stats.measuring) {
+            ++stats.delivered;
+            stats.latencies.push_back(now - sentAt);
+        }
+        return;
+    }
+
+    const char* space = static_cast<const char*>(std::memchr(line, ' ', length));
+    if (!space || end - space < 6) {
+        if (length >= 6 && std::memcmp(line, "ERROR ", 6) == 0 && stats.measuring)
+            ++stats.errors;
+        return;
+    }
+    const char* code = space + 1;
+    if (std::memcmp(code, "001 ", 4) == 0 && code[4] != '*')
+        client->registered = true;
+    else if (std::memcmp(code, "366 ", 4) == 0)
+        client->joined = true;
+    else if ((code[0] == '4' && code[3] == ' ') || std::memcmp(line, "ERROR ", 6) == 0) {
+        if (stats.measuring)
+            ++stats.errors;
+    }
+}
+
+static void readClient(BenchClient* client, long now) {
+    while (client->alive) {
+        size_t room = client->input.prepareWrite();
+        ssize_t received = recv(client->fd, client->input.writePtr(), room, 0);
+        if (received < 0 && errno == EINTR)
+            continue;
+        if (received < 0 && (errno == EAGAIN || errno == EWOULDBLOCK))
+            return;
+        if (received <= 0) {
+            closeClient(client);
+            return;
+        }
+        client->input.commit(received);
+
+        const char* line;
+        size_t length;
+        RecvBuffer::LineStatus status;
+        while ((status = client->input.nextLine(line, length)) != RecvBuffer::LINE_NONE) {
+            if (status == RecvBuffer::LINE_READY)
+                handleLine(client, line, length, now);
+        }
+    }
+}
+
+/**
+ * @brief Traite les événements réseau pendant au plus `timeoutMs`.
+ */
+static void pump(int timeoutMs) {
+    std::vector<IoEvent> events;
+    if (loop->wait(events, timeoutMs) <= 0)
+        return;
+    long now = nowNs();
+    for (size_t i = 0; i < events.size(); ++i) {
+        int fd = events[i].fd;
+        if (fd < 0 || static_cast<size_t>(fd) >= byFd.size() || !byFd[fd])
+            continue;
+        BenchClient* client = byFd[fd];
+        if (events[i].events & (EVENT_READ | EVENT_ERROR))
+            readClient(client, now);
+        if (client->alive && (events[i].events & EVENT_WRITE))
+            flush(client);
+    }
+}
+
+/* -------------------------------------------------------------------------- */
+/*                                Phases                                      */
+/* -------------------------------------------------------------------------- */
+
+static BenchClient* connectClient(const BenchOptions& opts, int id) {
+    struct sockaddr_in addr;
+    std::memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(opts.port);
+    if (inet_pton(AF_INET, opts.host.c_str(), &addr.sin_addr) != 1)
+        return NULL;
+
+    int fd = socket(AF_INET, SOCK_STREAM, 0);
+    if (fd < 0)
+        return NULL;
+    if (connect(fd, (struct sockaddr *)&addr, sizeof(addr)) < 0) {
+        close(fd);
+        return NULL;
+    }
+    int enable = 1;
+    setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &enable, sizeof(enable));
+    fcntl(fd, F_SETFL, O_NONBLOCK);
+
+    BenchClient* client = new BenchClient();
+    client->fd = fd;
+    client->id = id;
+    client->generation = 0;
+    client->nick = "b" + toString(id);
+    client->channel = id % opts.channels;
+    client->alive = true;
+    client->registered = false;
+    client->joined = false;
+    client->writeArmed = false;
+    loop->add(fd, EVENT_READ);
+    if (static_cast<size_t>(fd) >= byFd.size())
+        byFd.resize(fd + 1, NULL);
+    byFd[fd] = client;
+    return client;
+}
+
+/**
+ * @brief Attend que le drapeau `flag` soit levé pour tous les clients vivants.
+ *
+ * @return Nombre de clients prêts.
+ */
+static size_t waitAll(bool BenchClient::*flag, int timeoutSeconds) {
+    long deadline = nowNs() + timeoutSeconds * 1000000000L;
+    size_t ready = 0;
+    while (nowNs() < deadline) {
+        pump(10);
+        ready = 0;
+        size_t alive = 0;
+        for (size_t i = 0; i < clients.size(); ++i) {
+            if (!clients[i]->alive)
+                continue;
+            ++alive;
+            if (clients[i]->*flag)
+                ++ready;
+        }
+        if (ready == alive)
+            break;
+    }
+    return ready;
+}
+
+static int pickOp(const BenchOptions& opts) {
+    int total = 0;
+    for (int i = 0; i < OP_COUNT; ++i)
+        total += opts.mix[i];
+    int roll = static_cast<int>(nextRandom() % total);
+    for (int i = 0; i < OP_COUNT; ++i) {
+        if (roll < opts.mix[i])
+            return i;
+        roll -= opts.mix[i];
+    }
+    return OP_CHAN;
+}
+
+static BenchClient* pickClient() {
+    for (int attempt = 0; attempt < 16; ++attempt) {
+        BenchClient* client = clients[nextRandom() % clients.size()];
+        if (client->alive)
+            return client;
+    }
+    return NULL;
+}
+
+static void runOp(const BenchOptions& opts, int op, BenchClient* client) {
+    std::string stamp = " :bench " + toString(nowNs());
+
+    if (op == OP_CHAN) {
+        queue(client, "PRIVMSG " + channelName(client->channel) + stamp);
+    } else if (op == OP_USER) {
+        BenchClient* target = pickClient();
+        if (!target)
+            return;
+        queue(client, "PRIVMSG " + target->nick + stamp);
+    } else if (op == OP_CHURN) {
+        queue(client, "PART " + channelName(client->channel));
+        client->channel = static_cast<int>(nextRandom() % opts.channels);
+        queue(client, "JOIN " + channelName(client->channel));
+    } else {
+        client->nick = "b" + toString(client->id) + "g" + toString(++client->generation);
+        queue(client, "NICK " + client->nick);
+    }
+    ++stats.sent[op];
+}
+
+static double percentile(const std::vector<long>& sorted, double q) {
+    if (sorted.empty())
+        return 0;
+    size_t index = static_cast<size_t>(q * sorted.size());
+    if (index >= sorted.size())
+        index = sorted.size() - 1;
+    return sorted[index] / 1000.0;
+}
+
+static void report(double seconds) {
+    long sentTotal = 0;
+    for (int i = 0; i < OP_COUNT; ++i)
+        sentTotal += stats.sent[i];
+
+    std::sort(stats.latencies.begin(), stats.latencies.end());
+
+    std::cout << "📤 Envoyés : " << sentTotal << " (" << static_cast<long>(sentTotal / seconds) << "/s) —";
+    for (int i = 0; i < OP_COUNT; ++i)
+        std::cout << " " << OP_NAMES[i] << " " << stats.sent[i];
+    std::cout << std::endl;
+    std::cout << "📥 Livrés : " << stats.delivered << " (" << static_cast<long>(stats.delivered / seconds)
+              << "/s), erreurs : " << stats.errors << ", déconnexions : " << stats.disconnected << std::endl;
+    std::cout << std::fixed << std::setprecision(1);
+    std::cout << "⏱️  Latence (µs) : p50 " << percentile(stats.latencies, 0.50)
+              << "  p99 " << percentile(stats.latencies, 0.99)
+              << "  p999 " << percentile(stats.latencies, 0.999)
+              << "  max " << percentile(stats.latencies, 1.0) << std::endl;
+}
+
+int main(int argc, char** argv) {
+    BenchOptions opts;
+    if (!parseOptions(argc, argv, opts)) {
+        std::cerr << "Usage: ./irc_bench [--host=127.0.0.1] [--port=6667] [--password=pw]"
+                  << " [--clients=1000] [--channels=50] [--rate=20000] [--duration=10]"
+                  << " [--mix=chan:70,user:20,churn:5,nick:5]" << std::endl;
+        return 1;
+    }
+    raiseFileLimit();
+    loop = EventLoop::create("epoll");
+    std::memset(stats.sent, 0, sizeof(stats.sent));
+    stats.measuring = false;
+    stats.delivered = 0;
+    stats.errors = 0;
+    stats.disconnected = 0;
+
+    std::cout << "irc_bench : " << opts.clients << " clients, " << opts.channels << " channels, "
+              << opts.rate << " ops/s pendant " << opts.duration << " s (";
+    for (int i = 0; i < OP_COUNT; ++i)
+        std::cout << (i ? "," : "") << OP_NAMES[i] << ":" << opts.mix[i];
+    std::cout << ")" << std::endl;
+
+    for (int i = 0; i < opts.clients; ++i) {
+        BenchClient* client = connectClient(opts, i);
+        if (!client) {
+            perror("Erreur connexion");
+            return 1;
+        }
+        clients.push_back(client);
+        queue(client, "PASS " + opts.password);
+        queue(client, "NICK " + client->nick);
+        queue(client, "USER " + client->nick + " 0 * :bench");
+        if (i % 256 == 255)
+            pump(0);
+    }
+    size_t registered = waitAll(&BenchClient::registered, 30);
+    std::cout << "🔌 Clients enregistrés : " << registered << "/" << opts.clients << std::endl;
+
+    for (size_t i = 0; i < clients.size(); ++i)
+        queue(clients[i], "JOIN " + channelName(clients[i]->channel));
+    size_t joined = waitAll(&BenchClient::joined, 30);
+    std::cout << "📢 Clients dans un channel : " << joined << "/" << opts.clients << std::endl;
+
+    stats.measuring = true;
+    long start = nowNs();
+    long end = start + opts.duration * 1000000000L;
+    long issued = 0;
+    for (long now = start; now < end; now = nowNs()) {
+        long due = static_cast<long>((now - start) / 1e9 * opts.rate);
+        for (; issued < due; ++issued) {
+            BenchClient* client = pickClient();
+            if (client)
+                runOp(opts, pickOp(opts), client);
+        }
+        pump(1);
+    }
+    double seconds = (nowNs() - start) / 1e9;
+
+    long drainEnd = nowNs() + 1000000000L;
+    while (nowNs() < drainEnd)
+        pump(10);
+    stats.measuring = false;
+
+    report(seconds);
+
+    for (size_t i = 0; i < clients.size(); ++i) {
+        closeClient(clients[i]);
+        delete clients[i];
+    }
+    delete loop;
+    return 0;
+}
@@ -0,0 +1,144 @@
+/* ************************************************************************** */
+/*                                                                            */
+/*                                                        :::      ::::::::   */
+/*   members_bench.cpp                                  :+:      :+:    :+:   */
+/*                                                    +:+ +:+         +:+     */
+/*   By: kpourcel <marvin@42.fr>                    +#+  +:+       +#+        */
+/*                                                +#+#+#+#+#+   +#+           */
+/*   Created: 2025/04/17 11:03:18 by kpourcel          #+#    #+#             */
+/*   Updated: 2025/04/17 11:03:18 by kpourcel         ###   ########.fr       */
+/*                                                                            */
+/* ************************************************************************** */
+
+#include "../include/MemberList.hpp"
+
+#include <iostream>
+#include <map>
+#include <set>
+#include <string>
+#include <cstdlib>
+#include <sys/time.h>
+
+/**
+ * Micro-benchmark de l'appartenance aux channels.
+ *
+ * Compare l'ancienne disposition de Channel (std::map<int, Client*> des
+ * membres + std::set<int> des opérateurs) à MemberList (vecteur trié avec
+ * bits de statut) sur les trois opérations chaudes : parcours de diffusion,
+ * test membre/opérateur, et arrivées/départs.
+ *
+ * Usage : ./bench_members [membres] [itérations]
+ */
+
+static double nowSeconds() {
+    struct timeval tv;
+    gettimeofday(&tv, NULL);
+    return tv.tv_sec + tv.tv_usec / 1e6;
+}
+
+/**
+ * Disposition d'avant MemberList.
+ */
+struct LegacyChannel {
+    std::map<int, Client*>  clients;
+    std::set<int>           operators;
+};
+
+/**
+ * @brief Fds clairsemés et mélangés, comme après des connexions/déconnexions.
+ */
+static std::vector<int> makeFds(size_t count) {
+    std::vector<int> fds;
+    for (size_t i = 0; i < count; ++i)
+        fds.push_back(static_cast<int>(5 + i * 3));
+    srand(42);
+    for (size_t i = fds.size(); i > 1; --i)
+        std::swap(fds[i - 1], fds[rand() % i]);
+    return fds;
+}
+
+static void report(const char* name, double legacy, double flat, size_t checksum) {
+    std::cout << name << " : set " << legacy * 1e3 << " ms, vecteur " << flat * 1e3
+              << " ms (x" << legacy / flat << ", checksum " << checksum << ")" << std::endl;
+}
+
+int main(int argc, char** argv) {
+    long count = (argc > 1) ? std::strtol(argv[1], NULL, 10) : 1000;
+    long iterations = (argc > 2) ? std::strtol(argv[2], NULL, 10) : 2000;
+    if (count <= 0)
+        count = 1000;
+    if (iterations <= 0)
+        iterations = 2000;
+
+    std::vector<int> fds = makeFds(static_cast<size_t>(count));
+    LegacyChannel legacy;
+    MemberList flat;
+    for (size_t i = 0; i < fds.size(); ++i) {
+        legacy.clients[fds[i]] = NULL;
+        flat.insert(fds[i], NULL);
+        if (i % 10 == 0) {
+            legacy.operators.insert(fds[i]);
+            flat.setMode(*flat.find(fds[i]), MEMBER_OP, true);
+        }
+    }
+
+    /* Diffusion : parcours complet des membres */
+    size_t checksum = 0;
+    double start = nowSeconds();
+    for (long it = 0; it < iterations; ++it) {
+        for (std::map<int, Client*>::const_iterator m = legacy.clients.begin(); m != legacy.clients.end(); ++m)
+            checksum += m->first;
+    }
+    double legacySeconds = nowSeconds() - start;
+    start = nowSeconds();
+    for (long it = 0; it < iterations; ++it) {
+        for (MemberList::const_iterator m = flat.begin(); m != flat.end(); ++m)
+            checksum -= m->fd;
+    }
+    report("diffusion", legacySeconds, nowSeconds() - start, checksum);
+
+    /* Membre puis opérateur ? (une recherche par structure vs une seule) */
+    checksum = 0;
+    start = nowSeconds();
+    for (long it = 0; it < iterations; ++it) {
+        for (size_t i = 0; i < fds.size(); ++i) {
+            int fd = fds[i] + (i & 1);
+            if (legacy.clients.find(fd) != legacy.clients.end() && legacy.operators.count(fd))
+                ++checksum;
+        }
+    }
+    legacySeconds = nowSeconds() - start;
+    start = nowSeconds();
+    for (long it = 0; it < iterations; ++it) {
+        for (size_t i = 0; i < fds.size(); ++i) {
+            const ChannelMember* member = flat.find(fds[i] + (i & 1));
+            if (member && (member->modes & MEMBER_OP))
+                --checksum;
+        }
+    }
+    report("membre+op", legacySeconds, nowSeconds() - start, checksum);
+
+    /* Arrivées/départs : un membre sur cent sort puis revient */
+    long churn = iterations / 10 + 1;
+    checksum = 0;
+    start = nowSeconds();
+    for (long it = 0; it < churn; ++it) {
+        for (size_t i = 0; i < fds.size(); i += 100) {
+            legacy.clients.erase(fds[i]);
+            legacy.operators.erase(fds[i]);
+            legacy.clients[fds[i]] = NULL;
+            checksum += legacy.clients.size();
+        }
+    }
+    legacySeconds = nowSeconds() - start;
+    start = nowSeconds();
+    for (long it = 0; it < churn; ++it) {
+        for (size_t i = 0; i < fds.size(); i += 100) {
+            flat.erase(fds[i]);
+            flat.insert(fds[i], NULL);
+            checksum -= flat.size();
+        }
+    }
+    report("arrivées/départs", legacySeconds, nowSeconds() - start, checksum);
+    return 0;
+}
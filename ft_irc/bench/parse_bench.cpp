@@ -0,0 +1,120 @@
+/* ************************************************************************** */
+/*                                                                            */
+/*                                                        :::      ::::::::   */
+/*   parse_bench.cpp                                    :+:      :+:    :+:   */
+/*                                                    +:+ +:+         +:+     */
+/*   By: kpourcel <marvin@42.fr>                    +#+  +:+       +#+        */
+/*                                                +#+#+#+#+#+   +#+           */
+/*   Created: 2025/04/07 18:03:27 by kpourcel          #+#    #+#             */
+/*   Updated: 2025/04/07 18:03:27 by kpourcel         ###   ########.fr       */
+/*                                                                            */
+/* ************************************************************************** */
+
+#include "../include/MessageParser.hpp"
+
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <cstdlib>
+#include <sys/time.h>
+
+/**
+ * Micro-benchmark du découpage des lignes IRC.
+ *
+ * Compare l'ancien chemin de CommandHandler (std::istringstream + operator>>
+ * + std::getline) au MessageParser à base de vues.
+ *
+ * Usage : ./bench_parser [itérations]
+ */
+
+static const char* SAMPLE_LINES[] = {
+    "PRIVMSG #general :Hello everyone, how is the project going today?",
+    "PRIVMSG bob :are you around for a review?",
+    "JOIN #general",
+    "JOIN #secret hunter2",
+    "MODE #general +o alice",
+    "TOPIC #general :Release planning for the next sprint",
+    "KICK #general mallory :spamming",
+    "PING irc.42server.com",
+    "USER alice 0 * :Alice Liddell",
+    "@time=2025-04-07T16:00:00.000Z :alice!alice@localhost PRIVMSG #general :tagged line",
+    NULL
+};
+
+static double nowSeconds() {
+    struct timeval tv;
+    gettimeofday(&tv, NULL);
+    return tv.tv_sec + tv.tv_usec / 1e6;
+}
+
+/**
+ * @brief Reproduit le découpage de l'ancien CommandHandler::handleCommand.
+ */
+static size_t legacyParse(const std::string& line) {
+    std::istringstream iss(line);
+    std::vector<std::string> commands;
+    std::string temp;
+    while (std::getline(iss, temp, '\n')) {
+        if (!temp.empty())
+            commands.push_back(temp);
+    }
+
+    size_t total = 0;
+    for (size_t i = 0; i < commands.size(); ++i) {
+        std::istringstream singleCommand(commands[i]);
+        std::string cmd, first, second, rest;
+        singleCommand >> cmd >> first;
+        singleCommand >> second;
+        std::getline(singleCommand, rest);
+        total += cmd.size() + first.size() + second.size() + rest.size();
+    }
+    return total;
+}
+
+static size_t viewParse(const std::string& line) {
+    IrcMessage msg;
+    if (!MessageParser::parse(line.data(), line.size(), msg))
+        return 0;
+    size_t total = msg.command.length;
+    for (size_t i = 0; i < msg.paramCount; ++i)
+        total += msg.params[i].length;
+    return total;
+}
+
+static void report(const char* name, size_t lines, double seconds, size_t checksum) {
+    std::cout << name << " : " << static_cast<long>(lines / seconds) << " lignes/s"
+              << " (" << seconds << " s, checksum " << checksum << ")" << std::endl;
+}
+
+int main(int argc, char** argv) {
+    long iterations = (argc > 1) ? std::strtol(argv[1], NULL, 10) : 200000;
+    if (iterations <= 0)
+        iterations = 200000;
+
+    std::vector<std::string> lines;
+    for (size_t i = 0; SAMPLE_LINES[i]; ++i)
+        lines.push_back(SAMPLE_LINES[i]);
+    size_t totalLines = static_cast<size_t>(iterations) * lines.size();
+
+    size_t checksum = 0;
+    double start = nowSeconds();
+    for (long it = 0; it < iterations; ++it) {
+        for (size_t i = 0; i < lines.size(); ++i)
+            checksum += legacyParse(lines[i]);
+    }
+    double legacySeconds = nowSeconds() - start;
+    report("istringstream", totalLines, legacySeconds, checksum);
+
+    checksum = 0;
+    start = nowSeconds();
+    for (long it = 0; it < iterations; ++it) {
+        for (size_t i = 0; i < lines.size(); ++i)
+            checksum += viewParse(lines[i]);
+    }
+    double viewSeconds = nowSeconds() - start;
+    report("MessageParser", totalLines, viewSeconds, checksum);
+
+    std::cout << "Gain : x" << legacySeconds / viewSeconds << std::endl;
+    return 0;
+}
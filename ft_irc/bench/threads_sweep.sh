@@ -0,0 +1,83 @@
+#!/bin/bash
+
+# Mesure du mode multi-thread : lance ./ircserv avec --threads=N pour
+# chaque N demandé, le charge avec ./irc_bench puis relève le temps CPU
+# de chaque thread (/proc/<pid>/task).
+#
+# Le temps CPU du cœur (thread principal) est la part sérielle : tant
+# qu'il reste petit devant celui des réacteurs, ajouter des réacteurs (et
+# des cœurs CPU) augmente le débit. Les compteurs de /metrics montrent le
+# regroupement des envois : messages mis en file par commande confiée aux
+# réacteurs, commandes traitées par réveil d'un réacteur, et messages par
+# appel à sendmsg().
+#
+# Usage : ./bench/threads_sweep.sh [port] [threads...] [-- options irc_bench]
+#         ex. : ./bench/threads_sweep.sh 6690 1 2 4 -- --clients=400 --channels=4
+
+cd "$(dirname "$0")/.." || exit 1
+
+PORT=${1:-6690}
+shift
+THREADS=()
+while [ $# -gt 0 ] && [ "$1" != "--" ]; do
+    THREADS+=("$1")
+    shift
+done
+[ "$1" = "--" ] && shift
+[ ${#THREADS[@]} -eq 0 ] && THREADS=(1 2 4)
+BENCH_OPTIONS=("--clients=400" "--channels=4" "--rate=4000" "--duration=5"
+               "--mix=chan:100,user:0,churn:0,nick:0" "$@")
+TICKS=$(getconf CLK_TCK)
+
+if ! make > /dev/null 2>&1 || ! make bench > /dev/null 2>&1; then
+    echo "❌ Erreur : la compilation a échoué."
+    exit 1
+fi
+echo "🖥️  CPU disponibles : $(nproc)"
+
+# metric <texte /metrics> <nom> : valeur d'un compteur
+metric() {
+    awk -v name="$2" '$1 == name { print $2 }' <<< "$1"
+}
+
+# cpu_ms <tâche> : temps CPU (utilisateur + système) d'un thread, en ms
+cpu_ms() {
+    awk -v ticks="$TICKS" '{ print int(($14 + $15) * 1000 / ticks) }' "$1/stat"
+}
+
+for threads in "${THREADS[@]}"; do
+    ./ircserv "$PORT" benchpw --threads="$threads" --flood-rate=0 --log-level=error \
+        --metrics-port=$((PORT + 1000)) > /dev/null 2>&1 &
+    pid=$!
+    sleep 0.5
+    echo ""
+    echo "🧵 --threads=$threads"
+    ./irc_bench --port="$PORT" --password=benchpw "${BENCH_OPTIONS[@]}" | grep -E "Livrés|Latence"
+
+    core=0
+    reactors=0
+    for task in /proc/"$pid"/task/*; do
+        if [ "${task##*/}" = "$pid" ]; then
+            core=$(cpu_ms "$task")
+        else
+            reactors=$((reactors + $(cpu_ms "$task")))
+        fi
+    done
+    echo "⚙️  CPU : cœur $core ms, réacteurs $reactors ms (part sérielle $((core * 100 / (core + reactors + 1))) %)"
+
+    exec 9<>"/dev/tcp/127.0.0.1/$((PORT + 1000))"
+    printf 'GET /metrics HTTP/1.0\r\n\r\n' >&9
+    metrics=$(cat <&9)
+    exec 9>&-
+    queued=$(metric "$metrics" ircserv_messages_queued_total)
+    commands=$(metric "$metrics" ircserv_reactor_commands_total)
+    wakeups=$(metric "$metrics" ircserv_reactor_wakeups_total)
+    sends=$(metric "$metrics" ircserv_send_calls_total)
+    echo "📦 Messages en file : $queued, commandes aux réacteurs : $commands" \
+         "($((queued / (commands + 1))) msg/commande, $((commands / (wakeups + 1))) commandes/réveil)," \
+         "sendmsg : $sends ($((queued / (sends + 1))) msg/appel)"
+
+    kill -INT "$pid"
+    wait "$pid" 2> /dev/null
+    PORT=$((PORT + 1))
+done
@@ -0,0 +1,97 @@
+/* ************************************************************************** */
+/*                                                                            */
+/*                                                        :::      ::::::::   */
+/*   Archive.hpp                                        :+:      :+:    :+:   */
+/*                                                    +:+ +:+         +:+     */
+/*   By: kpourcel <marvin@42.fr>                    +#+  +:+       +#+        */
+/*                                                +#+#+#+#+#+   +#+           */
+/*   Created: 2025/04/18 09:41:27 by kpourcel          #+#    #+#             */
+/*   Updated: 2025/04/18 09:41:27 by kpourcel         ###   ########.fr       */
+/*                                                                            */
+/* ************************************************************************** */
+
+#ifndef ARCHIVE_HPP
+#define ARCHIVE_HPP
+
+#include <string>
+#include <cstddef>
+#include <pthread.h>
+
+#include "Mailbox.hpp"
+#include "ArchiveFormat.hpp"
+
+/* Au-delà, les lots en attente d'écriture sont abandonnés (et comptés) */
+#define ARCHIVE_QUEUE_MAX   (64 * 1024 * 1024)
+/* Octets écrits au-delà desquels un fdatasync est forcé sans attendre */
+#define ARCHIVE_SYNC_BYTES  (4 * 1024 * 1024)
+/* Attente maximale de l'écrivain sans lot ni échéance */
+#define ARCHIVE_IDLE_MS     1000
+
+/**
+ * Réglages de l'archive (--archive-*).
+ */
+struct ArchiveOptions {
+    std::string directory;
+    size_t      segmentBytes;
+    long        segmentAgeMs;
+    long        syncIntervalMs;
+};
+
+/**
+ * Archive des événements de channel dans des segments en ajout seul.
+ *
+ * Le thread principal encode chaque événement dans un lot (copie
+ * d'octets, sans appel système) ; publish(), appelé une fois par itération
+ * de la boucle, remet le lot au thread d'écriture par une Mailbox. Ce thread
+ * calcule les CRC, écrit les lots, change de segment selon la taille ou
+ * l'âge et regroupe les fdatasync (group commit) : un fdatasync couvre tous
+ * les lots écrits depuis le précédent, au plus tard syncIntervalMs après.
+ *
+ * La latence du disque ne remonte jamais dans la boucle d'événements : si
+ * l'écriture prend plus de ARCHIVE_QUEUE_MAX octets de retard, les lots
+ * suivants sont abandonnés et comptés.
+ */
+class Archive {
+private:
+    ArchiveOptions          options;
+    std::string             pending;
+    unsigned long           sequence;
+    Mailbox<std::string*>   batches;
+    pthread_t               writerThread;
+    int                     running;
+    size_t                  queuedBytes;
+    size_t                  droppedBatches;
+
+    /* Thread d'écriture uniquement */
+    int                     segmentFd;
+    size_t                  segmentSize;
+    long                    segmentStartedAt;
+    unsigned long           segmentCount;
+    size_t                  unsyncedBytes;
+    long                    lastSync;
+
+    static void*    writerMain(void* arg);
+    void            writerLoop();
+    size_t          drainBatches();
+    bool            openSegment();
+    void            closeSegment();
+    void            sync();
+    bool            writeAll(const char* data, size_t length);
+
+    Archive(const Archive& other);
+    Archive& operator=(const Archive& other);
+
+public:
+    explicit Archive(const ArchiveOptions& options);
+    ~Archive();
+
+    bool    start();
+    void    stop();
+
+    void    record(int type, const std::string& channel, const std::string& nick, const std::string& text);
+    void    publish();
+
+    size_t  getDropped() const;
+};
+
+#endif
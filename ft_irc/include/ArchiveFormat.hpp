@@ -0,0 +1,75 @@
+/* ************************************************************************** */
+/*                                                                            */
+/*                                                        :::      ::::::::   */
+/*   ArchiveFormat.hpp                                  :+:      :+:    :+:   */
+/*                                                    +:+ +:+         +:+     */
+/*   By: kpourcel <marvin@42.fr>                    +#+  +:+       +#+        */
+/*                                                +#+#+#+#+#+   +#+           */
+/*   Created: 2025/04/18 09:41:27 by kpourcel          #+#    #+#             */
+/*   Updated: 2025/04/18 09:41:27 by kpourcel         ###   ########.fr       */
+/*                                                                            */
+/* ************************************************************************** */
+
+#ifndef ARCHIVEFORMAT_HPP
+#define ARCHIVEFORMAT_HPP
+
+#include <string>
+#include <cstddef>
+
+/**
+ * Format des segments d'archive
+ *
+ * Un segment commence par ARCHIVE_MAGIC (8 octets) puis enchaîne des
+ * enregistrements, entiers en petit-boutiste :
+ *
+ *   u32 longueur du contenu | u32 CRC32 du contenu | contenu
+ *
+ * Contenu : u64 séquence | i64 heure (ms epoch) | u8 type |
+ *           u16 + octets du channel | u16 + octets du pseudo |
+ *           u16 + octets du texte
+ *
+ * Une fin de segment tronquée (arrêt brutal) se détecte par une longueur
+ * qui dépasse le fichier ou un CRC faux.
+ */
+#define ARCHIVE_MAGIC           "IRCARC01"
+#define ARCHIVE_MAGIC_SIZE      8
+#define ARCHIVE_HEADER_SIZE     8
+#define ARCHIVE_FIELD_MAX       65535
+#define ARCHIVE_RECORD_MAX      (1 << 20)
+
+enum ArchiveEventType {
+    ARCHIVE_PRIVMSG = 1,
+    ARCHIVE_JOIN,
+    ARCHIVE_PART,
+    ARCHIVE_KICK
+};
+
+/**
+ * Enregistrement décodé (lecteur d'archive).
+ */
+struct ArchiveRecord {
+    unsigned long   sequence;
+    long            time;
+    int             type;
+    std::string     channel;
+    std::string     nick;
+    std::string     text;
+};
+
+class ArchiveFormat {
+public:
+    static void         append(std::string& out, unsigned long sequence, long time, int type,
+                               const std::string& channel, const std::string& nick, const std::string& text);
+    static size_t       seal(char* data, size_t size);
+    static bool         decode(const char* payload, size_t length, ArchiveRecord& record);
+
+    static void         putInt(std::string& out, unsigned long value, size_t bytes);
+    static void         putField(std::string& out, const std::string& field);
+    static unsigned long readInt(const char* data, size_t bytes);
+    static bool         readField(const char* data, size_t length, size_t& offset, std::string& field);
+    static unsigned int readU32(const char* data);
+    static unsigned int crc32(const char* data, size_t length);
+    static const char*  typeName(int type);
+};
+
+#endif
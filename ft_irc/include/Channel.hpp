@@ -15,29 +15,42 @@
 
 #include <string>
 #include <set>
+#include <vector>
+
+#include "ObjectPool.hpp"
+#include "MemberList.hpp"
+#include "ChannelHistory.hpp"
+
+class Client;
 
 class Channel {
 private:
     std::string name;
-    std::set<int> clients;
-    std::set<int> operators;
+    MemberList clients;
     std::string topic;
     std::string password;
     int userLimit;
     bool inviteOnly;
     bool topicRestricted;
     std::set<int> invitedClients;
-
+    ChannelHistory history;
+    std::vector<std::string> savedOperators;
+    bool snapshotDirty;
+    std::vector<unsigned int> reactorMembers;
 
 public:
     Channel(const std::string& channelName);
-    
-    void addClient(int clientSocket);
+
+    const std::string& getName() const;
+
+    /**
+     * Gestion des membres (tient à jour la liste des channels du client)
+     */
+    void addClient(Client* client);
     void removeClient(int clientSocket);
     bool isClientInChannel(int clientSocket) const;
-    void broadcast(const std::string& message, int excludeSocket);
     bool isEmpty() const;
-    const std::set<int>& getClients() const;
+    const MemberList& getClients() const;
 
     /**
      * Gestion des opérateurs
@@ -45,6 +58,7 @@ public:
     void addOperator(int clientSocket);
     void removeOperator(int clientSocket);
     bool isOperator(int clientSocket) const;
+    void setMemberMode(int clientSocket, unsigned int mode, bool enabled);
 
     /**
      * Gestion des modes
@@ -67,6 +81,42 @@ public:
     void inviteClient(int clientSocket);
     bool isInvited(int clientSocket) const;
     void removeInvitation(int clientSocket);
+    const std::set<int>& getInvitations() const;
+
+    /**
+     * Opérateurs relus de l'instantané, pas encore revenus (par pseudo)
+     */
+    void setSavedOperators(const std::vector<std::string>& nicknames);
+    bool isSavedOperator(const std::string& nickname) const;
+    bool removeSavedOperator(const std::string& nickname);
+    bool hasSavedOperators() const;
+    const std::vector<std::string>& getSavedOperators() const;
+
+    /**
+     * Modifié depuis le dernier instantané
+     */
+    bool isSnapshotDirty() const;
+    void setSnapshotDirty(bool dirty);
+
+    /**
+     * Nombre de membres servis par chaque réacteur (mode multi-thread) :
+     * une diffusion ne vise que les réacteurs qui en ont
+     */
+    void addReactorMember(int reactorId);
+    void removeReactorMember(int reactorId);
+    const std::vector<unsigned int>& getReactorMembers() const;
+
+    /**
+     * Historique des messages (mémoire gérée par le HistoryStore du serveur)
+     */
+    ChannelHistory& getHistory();
+
+    /**
+     * Allocation depuis le pool de channels
+     */
+    static void* operator new(size_t size);
+    static void operator delete(void* ptr, size_t size);
+    static const PoolStats& getPoolStats();
 
 };
 
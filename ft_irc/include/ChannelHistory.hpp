@@ -0,0 +1,129 @@
+/* ************************************************************************** */
+/*                                                                            */
+/*                                                        :::      ::::::::   */
+/*   ChannelHistory.hpp                                 :+:      :+:    :+:   */
+/*                                                    +:+ +:+         +:+     */
+/*   By: kpourcel <marvin@42.fr>                    +#+  +:+       +#+        */
+/*                                                +#+#+#+#+#+   +#+           */
+/*   Created: 2025/04/17 14:36:09 by kpourcel          #+#    #+#             */
+/*   Updated: 2025/04/17 14:36:09 by kpourcel         ###   ########.fr       */
+/*                                                                            */
+/* ************************************************************************** */
+
+#ifndef CHANNELHISTORY_HPP
+#define CHANNELHISTORY_HPP
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+/* Taille moyenne prévue d'une ligne : fixe l'arène d'un channel */
+#define HISTORY_BYTES_PER_LINE 160
+
+class HistoryStore;
+
+/**
+ * Message conservé : identifiant, heure (ms depuis l'epoch) et position de
+ * la ligne dans l'arène du channel.
+ */
+struct HistoryEntry {
+    unsigned long   msgid;
+    long            time;
+    unsigned int    offset;
+    unsigned int    length;
+};
+
+/**
+ * Maillon de la liste LRU des historiques (sentinelle circulaire).
+ */
+struct HistoryLink {
+    HistoryLink*    prev;
+    HistoryLink*    next;
+
+    HistoryLink();
+    void            unlink();
+    bool            linked() const;
+};
+
+/**
+ * Historique d'un channel : anneau d'au plus `capacity` entrées dont les
+ * lignes sont rangées bout à bout dans une arène circulaire de taille fixe.
+ * Les plus anciennes sont écrasées quand l'anneau ou l'arène est plein.
+ *
+ * msgid et heure croissent avec la position : les recherches sont des
+ * dichotomies sur l'anneau. La mémoire n'est réservée qu'au premier
+ * message, auprès du HistoryStore qui peut la reprendre.
+ */
+class ChannelHistory : public HistoryLink {
+private:
+    HistoryStore*               store;
+    std::vector<char>           arena;
+    std::vector<HistoryEntry>   entries;
+    size_t                      head;
+    size_t                      count;
+    unsigned int                writePos;
+
+    void    dropOldest();
+
+    ChannelHistory(const ChannelHistory& other);
+    ChannelHistory& operator=(const ChannelHistory& other);
+
+    friend class HistoryStore;
+
+public:
+    ChannelHistory();
+    ~ChannelHistory();
+
+    size_t              size() const;
+    const HistoryEntry& at(size_t index) const;
+    std::string         line(const HistoryEntry& entry) const;
+
+    size_t              lowerBoundId(unsigned long msgid) const;
+    size_t              lowerBoundTime(long time) const;
+};
+
+/**
+ * Budget mémoire commun à tous les historiques.
+ *
+ * Chaque historique actif coûte son arène plus son anneau. Quand un channel
+ * a besoin du sien et que le budget est atteint, les historiques les moins
+ * récemment utilisés (écriture ou relecture) sont libérés en premier.
+ * Non thread-safe : appartient au thread principal.
+ */
+class HistoryStore {
+private:
+    HistoryLink     lru;
+    size_t          linesPerChannel;
+    size_t          budget;
+    size_t          used;
+    size_t          evictions;
+    unsigned long   lastMsgid;
+
+    size_t  channelCost() const;
+
+    HistoryStore(const HistoryStore& other);
+    HistoryStore& operator=(const HistoryStore& other);
+
+public:
+    HistoryStore(size_t linesPerChannel, size_t budget);
+
+    bool    enabled() const;
+    size_t  maxLines() const;
+    const HistoryEntry* append(ChannelHistory& history, const std::string& line, long time,
+                               unsigned long msgid = 0);
+    void    touch(ChannelHistory& history);
+    void    release(ChannelHistory& history);
+
+    size_t  memoryUsed() const;
+    size_t  evicted() const;
+
+    /**
+     * Heures des messages : ms depuis l'epoch, format IRCv3 server-time
+     * (2025-04-17T14:36:09.000Z)
+     */
+    static long         wallClockMs();
+    static std::string  formatTime(long time);
+    static bool         parseTime(const std::string& text, long& time);
+};
+
+#endif
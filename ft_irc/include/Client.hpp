@@ -16,6 +16,56 @@
 #include <iostream>
 #include <string>
 #include <vector>
+#include <set>
+#include <deque>
+
+#include "MessageBuffer.hpp"
+#include "RecvBuffer.hpp"
+#include "SendQueue.hpp"
+#include "ObjectPool.hpp"
+#include "TimerWheel.hpp"
+#include "TokenBucket.hpp"
+
+/**
+ * Motif de fermeture d'un client parti par QUIT (déconnexion normale,
+ * non journalisée comme un incident).
+ */
+#define CLIENT_QUIT_REASON "Client Quit"
+
+/**
+ * Budget de lecture d'un client pour l'itération en cours (équité entre
+ * clients, voir Server::runReadyClients).
+ */
+struct InputBudget {
+    unsigned long   turn;
+    size_t          lines;
+    size_t          bytes;
+    bool            queued;
+    bool            stalled;
+
+    InputBudget() : turn(0), lines(0), bytes(0), queued(false), stalled(false) {}
+
+    void    refresh(unsigned long current) {
+        if (turn != current) {
+            turn = current;
+            lines = 0;
+            bytes = 0;
+        }
+    }
+};
+
+class Channel;
+class Reactor;
+struct ReactorConnection;
+
+/**
+ * Timers embarqués dans chaque client (voir Server::handleTimer).
+ */
+enum ClientTimer {
+    CLIENT_TIMER_PING,
+    CLIENT_TIMER_REGISTRATION,
+    CLIENT_TIMER_FLOOD
+};
 
 class Client {
 private:
@@ -25,16 +75,35 @@ private:
     std::string     hostname;
     std::string     realname;
     bool            authenticated;
-    std::string     currentChannel;
-    std::string     buffer;
+    std::set<Channel*>          channels;
+    RecvBuffer      recvBuffer;
+    SendQueue       sendQueue;
+    Reactor*        reactor;
+    ReactorConnection*          connection;
+    SendQueue*      stagedBatch;
+    unsigned long   stagedEpoch;
+    bool            closing;
+    std::string     closeReason;
+    bool            serverOperator;
+    Timer           pingTimer;
+    Timer           registrationTimer;
+    long            lastActivity;
+    long            pingSentAt;
+    TokenBucket     floodBucket;
+    Timer           floodTimer;
+    std::deque<MessageBuffer>   pendingLines;
+    InputBudget     inputBudget;
+    bool            writeArmed;
+    unsigned long   visitMark;
 
 public:
     Client(int fd);
     ~Client();
 
     int         getSocketFd() const;
-    std::string getNickname() const;
+    const std::string& getNickname() const;
     std::string getUsername() const;
+    std::string getRealname() const;
     void        setRealname(const std::string& name);
     bool        isAuthenticated() const;
     
@@ -42,14 +111,84 @@ public:
     void        setUsername(const std::string& user);
     void        authenticate();
 
-    void        setCurrentChannel(const std::string& channel);
-    std::string getCurrentChannel() const;
+    /**
+     * Channels rejoints (maintenu par Channel::addClient/removeClient)
+     */
+    void        addChannel(Channel* channel);
+    void        removeChannel(Channel* channel);
+    const std::set<Channel*>& getChannels() const;
 
     bool        isFullyRegistered() const;
 
-    std::string& getBufferRef();
-    void appendToBuffer(const char* receiveBuffer, size_t length);
-    std::string extractNextMessage();
+    RecvBuffer& getRecvBuffer();
+
+    /**
+     * File d'envoi (vidée quand le socket est inscriptible)
+     */
+    SendQueue&  getSendQueue();
+
+    /**
+     * Socket surveillé en écriture (mode mono-thread, file bloquée)
+     */
+    void        setWriteArmed(bool armed);
+    bool        isWriteArmed() const;
+
+    /**
+     * Réacteur propriétaire du socket (mode multi-thread uniquement)
+     */
+    void        attachReactor(Reactor* owner, ReactorConnection* conn);
+    Reactor*    getReactor() const;
+    ReactorConnection* getConnection() const;
+
+    /**
+     * Lot en cours de remplissage pour le réacteur, valable tant que
+     * l'époque de sa file de commandes n'a pas changé
+     */
+    SendQueue*  getStagedBatch(unsigned long epoch) const;
+    void        setStagedBatch(SendQueue* batch, unsigned long epoch);
+
+    void        markClosing(const std::string& reason);
+    bool        isClosing() const;
+    std::string getCloseReason() const;
+
+    /**
+     * Opérateur du serveur (accordé par OPER)
+     */
+    void        setServerOperator(bool enabled);
+    bool        isServerOperator() const;
+
+    /**
+     * Activité et timers (heures en millisecondes monotones)
+     */
+    void        touch(long now);
+    long        getLastActivity() const;
+    void        setPingSentAt(long when);
+    long        getPingSentAt() const;
+    Timer&      getPingTimer();
+    Timer&      getRegistrationTimer();
+
+    /**
+     * Contrôle de flood : seau à jetons, timer de reprise et lignes en
+     * attente (mode multi-thread ; en mono-thread elles restent dans le
+     * tampon de réception)
+     */
+    TokenBucket&    getFloodBucket();
+    Timer&          getFloodTimer();
+    std::deque<MessageBuffer>&  getPendingLines();
+    InputBudget&    getInputBudget();
+
+    /**
+     * Marque de visite (diffusion aux pairs) : vrai au premier passage
+     * pour une époque donnée
+     */
+    bool            visit(unsigned long epoch);
+
+    /**
+     * Allocation depuis le pool de clients
+     */
+    static void*    operator new(size_t size);
+    static void     operator delete(void* ptr, size_t size);
+    static const PoolStats& getPoolStats();
 
 };
 
@@ -0,0 +1,46 @@
+/* ************************************************************************** */
+/*                                                                            */
+/*                                                        :::      ::::::::   */
+/*   ClientTable.hpp                                    :+:      :+:    :+:   */
+/*                                                    +:+ +:+         +:+     */
+/*   By: kpourcel <marvin@42.fr>                    +#+  +:+       +#+        */
+/*                                                +#+#+#+#+#+   +#+           */
+/*   Created: 2025/04/12 10:22:51 by kpourcel          #+#    #+#             */
+/*   Updated: 2025/04/12 10:22:51 by kpourcel         ###   ########.fr       */
+/*                                                                            */
+/* ************************************************************************** */
+
+#ifndef CLIENTTABLE_HPP
+#define CLIENTTABLE_HPP
+
+#include <vector>
+#include <cstddef>
+
+class Client;
+
+/**
+ * Table des clients indexée directement par descripteur de fichier.
+ *
+ * Le noyau attribue toujours le plus petit fd libre : les numéros restent
+ * denses et un vecteur remplace avantageusement un arbre (recherche en
+ * O(1), sans allocation par client ni poursuite de pointeurs).
+ */
+class ClientTable {
+private:
+    std::vector<Client*>    slots;
+    size_t                  count;
+
+public:
+    ClientTable();
+
+    Client* find(int fd) const;
+    Client* operator[](int fd) const;
+    void    insert(int fd, Client* client);
+    void    erase(int fd);
+    void    clear();
+
+    size_t  size() const;
+    int     limit() const;
+};
+
+#endif
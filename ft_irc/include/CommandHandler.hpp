@@ -14,28 +14,87 @@
 #define COMMANDHANDLER_HPP
 
 #include <string>
+#include "MessageParser.hpp"
 
 class Server;
+class CommandHandler;
+
+/**
+ * Niveau d'enregistrement requis avant d'accepter une commande.
+ */
+enum RegistrationLevel {
+    REG_NONE,
+    REG_PASS,
+    REG_FULL
+};
+
+typedef void (CommandHandler::*CommandFn)(int clientSocket, const IrcMessage &msg);
+
+/**
+ * Entrée de la table de dispatch : la commande et ses métadonnées.
+ * Les vérifications communes (enregistrement, nombre de paramètres) sont
+ * faites une seule fois par handleCommand avant d'appeler le handler.
+ */
+struct CommandEntry {
+    const char*         name;
+    CommandFn           handler;
+    size_t              minParams;
+    RegistrationLevel   registration;
+    unsigned int        cost;
+};
+
+/**
+ * Ligne reçue, découpée et cherchée dans la table une seule fois : le
+ * contrôle de flood (coût) puis l'exécution partagent le résultat. Les vues
+ * de `message` pointent dans la ligne, qui doit lui survivre.
+ */
+struct ParsedLine {
+    IrcMessage          message;
+    const CommandEntry* entry;
+    bool                valid;
+
+    ParsedLine();
+    unsigned int cost() const;
+};
+
+#define COMMAND_NAME_MAX 16
 
 class CommandHandler {
 private:
     Server& server;
-    void handlePassCmd(int clientSocket, std::istringstream &iss);
-    void handleNickCmd(int clientSocket, std::istringstream &iss);
-    void handleUserCmd(int clientSocket, std::istringstream &iss);
-    void handleJoinCmd(int clientSocket, std::istringstream &iss);
-    void handleQuitCmd(int clientSocket, std::istringstream &iss);
-    void handlePartCmd(int clientSocket, std::istringstream &iss);
-    void handleListCmd(int clientSocket);
-    void handlePrivMsgCmd(int clientSocket, std::istringstream &iss);
-    void handleKickCmd(int clientSocket, std::istringstream &iss);
-    void handleInviteCmd(int clientSocket, std::istringstream &iss);
-    void handleTopicCmd(int clientSocket, std::istringstream &iss);
-    void handleModeCmd(int clientSocket, std::istringstream &iss);
-    void handlePingCmd(int clientSocket, std::istringstream &iss);
+
+    static const CommandEntry   commandTable[];
+    static const size_t         commandCount;
+
+    void handleCapCmd(int clientSocket, const IrcMessage &msg);
+    void handlePassCmd(int clientSocket, const IrcMessage &msg);
+    void handleNickCmd(int clientSocket, const IrcMessage &msg);
+    void handleUserCmd(int clientSocket, const IrcMessage &msg);
+    void handleJoinCmd(int clientSocket, const IrcMessage &msg);
+    void handleQuitCmd(int clientSocket, const IrcMessage &msg);
+    void handlePartCmd(int clientSocket, const IrcMessage &msg);
+    void handleListCmd(int clientSocket, const IrcMessage &msg);
+    void handlePrivMsgCmd(int clientSocket, const IrcMessage &msg);
+    void handleKickCmd(int clientSocket, const IrcMessage &msg);
+    void handleInviteCmd(int clientSocket, const IrcMessage &msg);
+    void handleTopicCmd(int clientSocket, const IrcMessage &msg);
+    void handleModeCmd(int clientSocket, const IrcMessage &msg);
+    void handlePingCmd(int clientSocket, const IrcMessage &msg);
+    void handlePongCmd(int clientSocket, const IrcMessage &msg);
+    void handleWhoisCmd(int clientSocket, const IrcMessage &msg);
+    void handleNamesCmd(int clientSocket, const IrcMessage &msg);
+    void handleOperCmd(int clientSocket, const IrcMessage &msg);
+    void handleStatsCmd(int clientSocket, const IrcMessage &msg);
+    void handleUpgradeCmd(int clientSocket, const IrcMessage &msg);
+    void handleChatHistoryCmd(int clientSocket, const IrcMessage &msg);
+
+    void dispatch(int clientSocket, const IrcMessage& msg, const CommandEntry* entry);
 public:
     CommandHandler(Server& srv);
-    void handleCommand(int clientSocket, const std::string& command);
+    void handleCommand(int clientSocket, const ParsedLine& parsed);
+
+    static const CommandEntry*  findCommand(const StringView& verb);
+    static void                 parseLine(const char* line, size_t length, ParsedLine& parsed);
 };
 
 #endif
@@ -0,0 +1,69 @@
+/* ************************************************************************** */
+/*                                                                            */
+/*                                                        :::      ::::::::   */
+/*   Config.hpp                                         :+:      :+:    :+:   */
+/*                                                    +:+ +:+         +:+     */
+/*   By: kpourcel <marvin@42.fr>                    +#+  +:+       +#+        */
+/*                                                +#+#+#+#+#+   +#+           */
+/*   Created: 2025/04/03 11:02:16 by kpourcel          #+#    #+#             */
+/*   Updated: 2025/04/03 11:02:16 by kpourcel         ###   ########.fr       */
+/*                                                                            */
+/* ************************************************************************** */
+
+#ifndef CONFIG_HPP
+#define CONFIG_HPP
+
+#include <string>
+#include <cstddef>
+#include <vector>
+
+#define DEFAULT_SENDQ_LIMIT 1048576
+#define MAX_REACTOR_THREADS 64
+#define DEFAULT_PING_INTERVAL 120
+#define DEFAULT_PING_TIMEOUT 60
+#define DEFAULT_REGISTER_TIMEOUT 30
+#define DEFAULT_FLOOD_RATE 10
+#define DEFAULT_FLOOD_BURST 20
+#define DEFAULT_HISTORY_LINES 100
+#define DEFAULT_HISTORY_MEMORY 8388608
+#define MAX_HISTORY_LINES 10000
+#define DEFAULT_ARCHIVE_SEGMENT_BYTES 67108864
+#define DEFAULT_ARCHIVE_SEGMENT_AGE 3600
+#define DEFAULT_ARCHIVE_SYNC_MS 100
+#define DEFAULT_SNAPSHOT_INTERVAL 10
+
+/**
+ * Options facultatives passées après <port> <password> sous la forme
+ * --clé=valeur.
+ */
+struct ServerConfig {
+    std::string backend;
+    size_t      sendQueueLimit;
+    size_t      threads;
+    int         logLevel;
+    std::string logFile;
+    int         metricsPort;
+    std::string operName;
+    std::string operPassword;
+    long        pingInterval;
+    long        pingTimeout;
+    long        registerTimeout;
+    long        floodRate;
+    long        floodBurst;
+    size_t      historyLines;
+    size_t      historyMemory;
+    std::string archiveDir;
+    size_t      archiveSegmentBytes;
+    long        archiveSegmentAge;
+    long        archiveSyncMs;
+    std::string snapshotFile;
+    long        snapshotInterval;
+    int         upgradeFd;
+    std::vector<std::string> commandLine;
+
+    ServerConfig();
+};
+
+bool parseConfigOption(const std::string& arg, ServerConfig& config);
+
+#endif
@@ -0,0 +1,48 @@
+/* ************************************************************************** */
+/*                                                                            */
+/*                                                        :::      ::::::::   */
+/*   EpollEventLoop.hpp                                 :+:      :+:    :+:   */
+/*                                                    +:+ +:+         +:+     */
+/*   By: kpourcel <marvin@42.fr>                    +#+  +:+       +#+        */
+/*                                                +#+#+#+#+#+   +#+           */
+/*   Created: 2025/04/03 10:15:37 by kpourcel          #+#    #+#             */
+/*   Updated: 2025/04/03 10:15:37 by kpourcel         ###   ########.fr       */
+/*                                                                            */
+/* ************************************************************************** */
+
+#ifndef EPOLLEVENTLOOP_HPP
+#define EPOLLEVENTLOOP_HPP
+
+#include "EventLoop.hpp"
+
+#ifdef __linux__
+
+#include <sys/epoll.h>
+
+/**
+ * Backend epoll en mode edge-triggered : le coût d'un réveil ne dépend que
+ * du nombre de descripteurs prêts, pas du nombre de clients connectés.
+ */
+class EpollEventLoop : public EventLoop {
+private:
+    int                             epollFd;
+    std::vector<struct epoll_event> readyEvents;
+
+    static unsigned int toEpollEvents(int events);
+
+public:
+    EpollEventLoop();
+    virtual ~EpollEventLoop();
+
+    bool                isValid() const;
+
+    virtual bool        add(int fd, int events);
+    virtual bool        modify(int fd, int events);
+    virtual void        remove(int fd);
+    virtual int         wait(std::vector<IoEvent>& events, int timeoutMs);
+    virtual const char* getName() const;
+};
+
+#endif
+
+#endif
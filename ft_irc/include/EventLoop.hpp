@@ -0,0 +1,52 @@
+/* ************************************************************************** */
+/*                                                                            */
+/*                                                        :::      ::::::::   */
+/*   EventLoop.hpp                                      :+:      :+:    :+:   */
+/*                                                    +:+ +:+         +:+     */
+/*   By: kpourcel <marvin@42.fr>                    +#+  +:+       +#+        */
+/*                                                +#+#+#+#+#+   +#+           */
+/*   Created: 2025/04/03 10:12:44 by kpourcel          #+#    #+#             */
+/*   Updated: 2025/04/03 10:12:44 by kpourcel         ###   ########.fr       */
+/*                                                                            */
+/* ************************************************************************** */
+
+#ifndef EVENTLOOP_HPP
+#define EVENTLOOP_HPP
+
+#include <string>
+#include <vector>
+
+/**
+ * Masque d'événements commun à tous les backends.
+ */
+#define EVENT_READ  0x01
+#define EVENT_WRITE 0x02
+#define EVENT_ERROR 0x04
+
+struct IoEvent {
+    int fd;
+    int events;
+};
+
+/**
+ * Interface d'une boucle d'événements : les backends (poll, epoll) ne
+ * renvoient que les descripteurs prêts, le serveur n'a plus à parcourir
+ * l'ensemble des clients à chaque réveil.
+ *
+ * Les backends peuvent être déclenchés sur front (epoll) : les appelants
+ * doivent donc toujours vider un socket jusqu'à EAGAIN.
+ */
+class EventLoop {
+public:
+    virtual ~EventLoop();
+
+    virtual bool        add(int fd, int events) = 0;
+    virtual bool        modify(int fd, int events) = 0;
+    virtual void        remove(int fd) = 0;
+    virtual int         wait(std::vector<IoEvent>& events, int timeoutMs) = 0;
+    virtual const char* getName() const = 0;
+
+    static EventLoop*   create(const std::string& backend);
+};
+
+#endif
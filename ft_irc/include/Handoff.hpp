@@ -0,0 +1,79 @@
+/* ************************************************************************** */
+/*                                                                            */
+/*                                                        :::      ::::::::   */
+/*   Handoff.hpp                                        :+:      :+:    :+:   */
+/*                                                    +:+ +:+         +:+     */
+/*   By: kpourcel <marvin@42.fr>                    +#+  +:+       +#+        */
+/*                                                +#+#+#+#+#+   +#+           */
+/*   Created: 2025/04/19 16:37:05 by kpourcel          #+#    #+#             */
+/*   Updated: 2025/04/19 16:37:05 by kpourcel         ###   ########.fr       */
+/*                                                                            */
+/* ************************************************************************** */
+
+#ifndef HANDOFF_HPP
+#define HANDOFF_HPP
+
+#include <string>
+#include <vector>
+#include <sys/types.h>
+
+/**
+ * Transmission de l'état au nouveau processus (mise à jour à chaud)
+ *
+ * Sur la paire de sockets AF_UNIX qui relie l'ancien processus au nouveau :
+ *
+ *   en-tête : HANDOFF_MAGIC | u32 nombre de fds | u32 taille de l'état
+ *   fds     : un octet par message, avec au plus HANDOFF_FDS_PER_MESSAGE
+ *             descripteurs en SCM_RIGHTS
+ *   état    : les octets de l'état sérialisé
+ *
+ * puis le nouveau processus répond HANDOFF_READY quand il a tout repris.
+ */
+#define HANDOFF_MAGIC           "IRCUPG01"
+#define HANDOFF_MAGIC_SIZE      8
+#define HANDOFF_HEADER_SIZE     16
+#define HANDOFF_FDS_PER_MESSAGE 250
+#define HANDOFF_READY           'R'
+#define HANDOFF_TIMEOUT_MS      10000
+
+/**
+ * Drapeaux d'un client dans l'état transmis
+ */
+#define HANDOFF_AUTHENTICATED   1
+#define HANDOFF_SERVER_OPERATOR 2
+
+class Handoff {
+public:
+    static pid_t    spawn(const std::vector<std::string>& commandLine, int& channel);
+    static bool     send(int channel, const std::vector<int>& fds, const std::string& state);
+    static bool     receive(int channel, std::vector<int>& fds, std::string& state);
+    static bool     waitReady(int channel, int timeoutMs);
+    static bool     signalReady(int channel);
+
+    static void     putBytes(std::string& out, const char* data, size_t length);
+};
+
+/**
+ * Lecture de l'état sérialisé : entiers big-endian, champs (u16 + octets)
+ * et blocs (u32 + octets). Une lecture hors limites renvoie une valeur vide
+ * et passe le lecteur en échec.
+ */
+class HandoffReader {
+private:
+    const std::string&  data;
+    size_t              offset;
+    bool                failed;
+
+    bool    reserve(size_t length);
+
+public:
+    HandoffReader(const std::string& data);
+
+    unsigned long   readInt(size_t bytes);
+    std::string     readField();
+    std::string     readBytes();
+    bool            ok() const;
+    bool            atEnd() const;
+};
+
+#endif
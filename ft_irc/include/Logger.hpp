@@ -0,0 +1,128 @@
+/* ************************************************************************** */
+/*                                                                            */
+/*                                                        :::      ::::::::   */
+/*   Logger.hpp                                         :+:      :+:    :+:   */
+/*                                                    +:+ +:+         +:+     */
+/*   By: kpourcel <marvin@42.fr>                    +#+  +:+       +#+        */
+/*                                                +#+#+#+#+#+   +#+           */
+/*   Created: 2025/04/13 11:08:45 by kpourcel          #+#    #+#             */
+/*   Updated: 2025/04/13 11:08:45 by kpourcel         ###   ########.fr       */
+/*                                                                            */
+/* ************************************************************************** */
+
+#ifndef LOGGER_HPP
+#define LOGGER_HPP
+
+#include <string>
+#include <cstddef>
+
+#define LOG_LEVEL_DEBUG 0
+#define LOG_LEVEL_INFO  1
+#define LOG_LEVEL_WARN  2
+#define LOG_LEVEL_ERROR 3
+
+/**
+ * Niveau minimal compilé : les appels en dessous disparaissent du binaire,
+ * arguments compris (make LOG_LEVEL=1 retire tous les LOG_DEBUG).
+ */
+#ifndef IRC_LOG_LEVEL
+# define IRC_LOG_LEVEL LOG_LEVEL_DEBUG
+#endif
+
+#define LOG_RECORD_MAX  512
+#define LOG_RING_SIZE   2048
+
+/**
+ * Journal asynchrone.
+ *
+ * Les threads du serveur ne font que formater dans un tampon fixe et déposer
+ * l'enregistrement dans un anneau borné sans verrou ; un thread d'écriture le
+ * vide par lots (un write() par lot) vers stdout ou un fichier. Si l'anneau
+ * est plein, l'enregistrement est abandonné et compté : le serveur ne
+ * bloque jamais sur ses logs.
+ *
+ * Avant start() et après stop(), les enregistrements sont écrits directement.
+ */
+class Logger {
+private:
+    static int  minLevel;
+
+public:
+    static bool     start(int level, const std::string& path);
+    static void     stop();
+
+    static bool     isEnabled(int level) {
+        return level >= minLevel;
+    }
+    static void     submit(int level, const char* text, size_t length);
+    static size_t   getDropped();
+    static int      parseLevel(const std::string& name);
+};
+
+/**
+ * Données brutes (non terminées par '\0') à insérer dans une ligne de log.
+ */
+struct LogBytes {
+    const char* data;
+    size_t      length;
+
+    LogBytes(const char* data, size_t length) : data(data), length(length) {}
+};
+
+/**
+ * Formateur à tampon fixe, sans allocation : la ligne est tronquée à
+ * LOG_RECORD_MAX octets et transmise au Logger à la destruction.
+ */
+class LogLine {
+private:
+    int     level;
+    size_t  length;
+    char    text[LOG_RECORD_MAX];
+
+    LogLine(const LogLine& other);
+    LogLine& operator=(const LogLine& other);
+
+public:
+    explicit LogLine(int level);
+    ~LogLine();
+
+    LogLine&    append(const char* data, size_t size);
+    LogLine&    operator<<(const char* value);
+    LogLine&    operator<<(const std::string& value);
+    LogLine&    operator<<(const LogBytes& value);
+    LogLine&    operator<<(char value);
+    LogLine&    operator<<(int value);
+    LogLine&    operator<<(unsigned int value);
+    LogLine&    operator<<(long value);
+    LogLine&    operator<<(unsigned long value);
+};
+
+#define LOG_AT(level, expr) \
+    do { \
+        if (Logger::isEnabled(level)) { \
+            LogLine logLine_(level); \
+            logLine_ << expr; \
+        } \
+    } while (0)
+
+#if IRC_LOG_LEVEL <= LOG_LEVEL_DEBUG
+# define LOG_DEBUG(expr) LOG_AT(LOG_LEVEL_DEBUG, expr)
+#else
+# define LOG_DEBUG(expr) do {} while (0)
+#endif
+
+#if IRC_LOG_LEVEL <= LOG_LEVEL_INFO
+# define LOG_INFO(expr) LOG_AT(LOG_LEVEL_INFO, expr)
+#else
+# define LOG_INFO(expr) do {} while (0)
+#endif
+
+#if IRC_LOG_LEVEL <= LOG_LEVEL_WARN
+# define LOG_WARN(expr) LOG_AT(LOG_LEVEL_WARN, expr)
+#else
+# define LOG_WARN(expr) do {} while (0)
+#endif
+
+#define LOG_ERROR(expr) LOG_AT(LOG_LEVEL_ERROR, expr)
+
+#endif
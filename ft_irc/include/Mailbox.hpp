@@ -0,0 +1,121 @@
+/* ************************************************************************** */
+/*                                                                            */
+/*                                                        :::      ::::::::   */
+/*   Mailbox.hpp                                        :+:      :+:    :+:   */
+/*                                                    +:+ +:+         +:+     */
+/*   By: kpourcel <marvin@42.fr>                    +#+  +:+       +#+        */
+/*                                                +#+#+#+#+#+   +#+           */
+/*   Created: 2025/04/11 10:05:12 by kpourcel          #+#    #+#             */
+/*   Updated: 2025/04/11 10:05:12 by kpourcel         ###   ########.fr       */
+/*                                                                            */
+/* ************************************************************************** */
+
+#ifndef MAILBOX_HPP
+#define MAILBOX_HPP
+
+#include <cstddef>
+#include <cerrno>
+#include <unistd.h>
+#include <fcntl.h>
+
+/**
+ * File MPSC (plusieurs producteurs, un consommateur) sans verrou.
+ *
+ * Algorithme de D. Vyukov : un producteur publie son nœud par un échange
+ * atomique sur la tête puis le chaîne à son prédécesseur ; le consommateur
+ * avance seul sur la queue. Aucun producteur ne bloque jamais un autre.
+ *
+ * Le consommateur est réveillé par un pipe surveillé dans son EventLoop ;
+ * un seul octet est écrit tant qu'il n'a pas vidé la file (signaled).
+ */
+template <typename T>
+class Mailbox {
+private:
+    struct Node {
+        Node*   next;
+        T       value;
+
+        Node() : next(NULL), value() {}
+    };
+
+    Node*   head;
+    Node*   tail;
+    int     signaled;
+    int     wakePipe[2];
+
+    Mailbox(const Mailbox& other);
+    Mailbox& operator=(const Mailbox& other);
+
+public:
+    Mailbox() : signaled(0) {
+        head = new Node();
+        tail = head;
+        wakePipe[0] = -1;
+        wakePipe[1] = -1;
+        if (pipe(wakePipe) == 0) {
+            fcntl(wakePipe[0], F_SETFL, O_NONBLOCK);
+            fcntl(wakePipe[1], F_SETFL, O_NONBLOCK);
+        }
+    }
+
+    ~Mailbox() {
+        T value;
+        while (pop(value)) {}
+        delete tail;
+        if (wakePipe[0] >= 0)
+            close(wakePipe[0]);
+        if (wakePipe[1] >= 0)
+            close(wakePipe[1]);
+    }
+
+    /**
+     * @brief Publie une valeur (appelable depuis n'importe quel thread).
+     */
+    void push(const T& value) {
+        Node* node = new Node();
+        node->value = value;
+        Node* prev = __atomic_exchange_n(&head, node, __ATOMIC_ACQ_REL);
+        __atomic_store_n(&prev->next, node, __ATOMIC_RELEASE);
+    }
+
+    /**
+     * @brief Retire la plus ancienne valeur (thread consommateur uniquement).
+     *
+     * @return false si la file est vide (ou si un push est en cours de publication).
+     */
+    bool pop(T& value) {
+        Node* next = __atomic_load_n(&tail->next, __ATOMIC_ACQUIRE);
+        if (!next)
+            return false;
+        value = next->value;
+        next->value = T();
+        delete tail;
+        tail = next;
+        return true;
+    }
+
+    /**
+     * @brief Réveille le consommateur si ce n'est pas déjà fait.
+     */
+    void wake() {
+        if (__atomic_exchange_n(&signaled, 1, __ATOMIC_ACQ_REL) == 0) {
+            char byte = 1;
+            while (write(wakePipe[1], &byte, 1) < 0 && errno == EINTR) {}
+        }
+    }
+
+    /**
+     * @brief Acquitte le réveil ; à appeler avant de vider la file.
+     */
+    void acknowledge() {
+        char drain[64];
+        while (read(wakePipe[0], drain, sizeof(drain)) > 0) {}
+        __atomic_store_n(&signaled, 0, __ATOMIC_RELEASE);
+    }
+
+    int getWakeFd() const {
+        return wakePipe[0];
+    }
+};
+
+#endif
@@ -0,0 +1,68 @@
+/* ************************************************************************** */
+/*                                                                            */
+/*                                                        :::      ::::::::   */
+/*   MemberList.hpp                                     :+:      :+:    :+:   */
+/*                                                    +:+ +:+         +:+     */
+/*   By: kpourcel <marvin@42.fr>                    +#+  +:+       +#+        */
+/*                                                +#+#+#+#+#+   +#+           */
+/*   Created: 2025/04/17 10:12:41 by kpourcel          #+#    #+#             */
+/*   Updated: 2025/04/17 10:12:41 by kpourcel         ###   ########.fr       */
+/*                                                                            */
+/* ************************************************************************** */
+
+#ifndef MEMBERLIST_HPP
+#define MEMBERLIST_HPP
+
+#include <vector>
+#include <cstddef>
+
+class Client;
+
+/**
+ * Statut d'un membre dans un channel (bits de ChannelMember::modes).
+ */
+enum MemberMode {
+    MEMBER_OP    = 1 << 0,
+    MEMBER_VOICE = 1 << 1
+};
+
+/**
+ * Entrée d'un membre : son fd, ses modes, le préfixe NAMES qui en découle
+ * ('@', '+' ou 0) et le client. Pas de chaîne : l'entrée reste un POD de
+ * 16 octets, déplacée par memmove.
+ */
+struct ChannelMember {
+    int             fd;
+    unsigned short  modes;
+    char            prefix;
+    Client*         client;
+};
+
+/**
+ * Membres d'un channel dans un vecteur contigu trié par fd.
+ *
+ * Les diffusions parcourent la mémoire linéairement, et appartenance et
+ * statut se lisent en une seule recherche dichotomique.
+ */
+class MemberList {
+private:
+    std::vector<ChannelMember> members;
+
+public:
+    typedef std::vector<ChannelMember>::const_iterator const_iterator;
+
+    ChannelMember*          find(int fd);
+    const ChannelMember*    find(int fd) const;
+    ChannelMember&          insert(int fd, Client* client);
+    bool                    erase(int fd);
+    void                    setMode(ChannelMember& member, unsigned int mode, bool enabled);
+
+    const_iterator          begin() const;
+    const_iterator          end() const;
+    const ChannelMember&    front() const;
+    size_t                  size() const;
+    bool                    empty() const;
+
+};
+
+#endif
@@ -0,0 +1,55 @@
+/* ************************************************************************** */
+/*                                                                            */
+/*                                                        :::      ::::::::   */
+/*   MessageBuffer.hpp                                  :+:      :+:    :+:   */
+/*                                                    +:+ +:+         +:+     */
+/*   By: kpourcel <marvin@42.fr>                    +#+  +:+       +#+        */
+/*                                                +#+#+#+#+#+   +#+           */
+/*   Created: 2025/04/04 14:08:31 by kpourcel          #+#    #+#             */
+/*   Updated: 2025/04/04 14:08:31 by kpourcel         ###   ########.fr       */
+/*                                                                            */
+/* ************************************************************************** */
+
+#ifndef MESSAGEBUFFER_HPP
+#define MESSAGEBUFFER_HPP
+
+#include <string>
+#include <cstddef>
+
+/**
+ * Ligne IRC immuable partagée par compteur de références.
+ *
+ * Un message envoyé à un channel est encodé une seule fois : la file
+ * d'envoi de chaque destinataire ne garde qu'une référence vers le même
+ * bloc, copier un MessageBuffer ne copie jamais le contenu.
+ *
+ * Le compteur est atomique : en mode multi-thread, un même message peut
+ * être libéré par plusieurs réacteurs à la fois.
+ */
+class MessageBuffer {
+private:
+    struct Block {
+        unsigned int    refCount;
+        size_t          length;
+    };
+
+    Block*  block;
+
+    void    init(const char* text, size_t length);
+    void    release();
+
+public:
+    MessageBuffer();
+    explicit MessageBuffer(const std::string& text);
+    MessageBuffer(const char* text, size_t length);
+    MessageBuffer(const MessageBuffer& other);
+    MessageBuffer& operator=(const MessageBuffer& other);
+    ~MessageBuffer();
+
+    const char*     data() const;
+    size_t          size() const;
+    bool            empty() const;
+    unsigned int    useCount() const;
+};
+
+#endif
@@ -0,0 +1,65 @@
+/* ************************************************************************** */
+/*                                                                            */
+/*                                                        :::      ::::::::   */
+/*   MessageParser.hpp                                  :+:      :+:    :+:   */
+/*                                                    +:+ +:+         +:+     */
+/*   By: kpourcel <marvin@42.fr>                    +#+  +:+       +#+        */
+/*                                                +#+#+#+#+#+   +#+           */
+/*   Created: 2025/04/07 16:22:40 by kpourcel          #+#    #+#             */
+/*   Updated: 2025/04/07 16:22:40 by kpourcel         ###   ########.fr       */
+/*                                                                            */
+/* ************************************************************************** */
+
+#ifndef MESSAGEPARSER_HPP
+#define MESSAGEPARSER_HPP
+
+#include <string>
+#include <cstddef>
+
+#define IRC_MAX_PARAMS 15
+
+/**
+ * Vue (pointeur + longueur) sur une partie de la ligne reçue.
+ * Ne possède pas la mémoire : valide tant que la ligne d'origine l'est.
+ */
+struct StringView {
+    const char* data;
+    size_t      length;
+
+    StringView();
+    StringView(const char* str, size_t len);
+
+    bool        empty() const;
+    bool        equals(const char* literal) const;
+    std::string str() const;
+};
+
+/**
+ * Message IRC découpé selon la RFC 1459 et les tags IRCv3 :
+ *   [@tags] [:prefix] COMMAND [params...] [:trailing]
+ *
+ * Le trailing, s'il existe, est le dernier paramètre (hasTrailing).
+ */
+struct IrcMessage {
+    StringView  tags;
+    StringView  prefix;
+    StringView  command;
+    StringView  params[IRC_MAX_PARAMS];
+    size_t      paramCount;
+    bool        hasTrailing;
+
+    IrcMessage();
+
+    StringView  param(size_t index) const;
+    std::string paramStr(size_t index) const;
+};
+
+/**
+ * Analyseur sans allocation : toutes les vues pointent dans la ligne fournie.
+ */
+class MessageParser {
+public:
+    static bool parse(const char* line, size_t length, IrcMessage& message);
+};
+
+#endif
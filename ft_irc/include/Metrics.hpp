@@ -0,0 +1,122 @@
+/* ************************************************************************** */
+/*                                                                            */
+/*                                                        :::      ::::::::   */
+/*   Metrics.hpp                                        :+:      :+:    :+:   */
+/*                                                    +:+ +:+         +:+     */
+/*   By: kpourcel <marvin@42.fr>                    +#+  +:+       +#+        */
+/*                                                +#+#+#+#+#+   +#+           */
+/*   Created: 2025/04/15 10:14:22 by kpourcel          #+#    #+#             */
+/*   Updated: 2025/04/15 10:14:22 by kpourcel         ###   ########.fr       */
+/*                                                                            */
+/* ************************************************************************** */
+
+#ifndef METRICS_HPP
+#define METRICS_HPP
+
+#include <string>
+#include <cstddef>
+
+#define METRICS_MAX_SHARDS      80
+#define METRICS_MAX_VERBS       32
+#define HISTOGRAM_SUB_BITS      3
+#define HISTOGRAM_SUB_COUNT     (1 << HISTOGRAM_SUB_BITS)
+#define HISTOGRAM_BUCKETS       384
+
+/**
+ * Compteurs globaux (cumulés depuis le démarrage).
+ */
+enum MetricCounter {
+    METRIC_BYTES_RECEIVED,
+    METRIC_BYTES_SENT,
+    METRIC_RECV_CALLS,
+    METRIC_SEND_CALLS,
+    METRIC_LINES_RECEIVED,
+    METRIC_MESSAGES_QUEUED,
+    METRIC_CONNECTIONS,
+    METRIC_DISCONNECTIONS,
+    METRIC_FLOOD_THROTTLES,
+    METRIC_REACTOR_COMMANDS,
+    METRIC_REACTOR_WAKEUPS,
+    METRIC_COUNTER_COUNT
+};
+
+/**
+ * Durées mesurées sur les chemins de réception et d'envoi (appels système).
+ */
+enum MetricTimer {
+    TIMER_RECV,
+    TIMER_SEND,
+    TIMER_COUNT
+};
+
+/**
+ * Histogramme log-linéaire façon HDR, en nanosecondes.
+ *
+ * Chaque puissance de deux est découpée en HISTOGRAM_SUB_COUNT cases :
+ * erreur relative bornée (12,5 %) de la nanoseconde à plusieurs heures,
+ * enregistrement en O(1) (une instruction clz), mémoire fixe.
+ *
+ * Un seul thread écrit dans un histogramme donné ; les lectures des autres
+ * threads sont atomiques mais sans verrou.
+ */
+class LatencyHistogram {
+private:
+    unsigned long   buckets[HISTOGRAM_BUCKETS];
+    unsigned long   count;
+    unsigned long   sum;
+    unsigned long   max;
+
+public:
+    LatencyHistogram();
+
+    void            record(unsigned long value);
+    void            merge(const LatencyHistogram& other);
+
+    unsigned long   getCount() const;
+    unsigned long   getSum() const;
+    unsigned long   getMax() const;
+    unsigned long   percentile(double quantile) const;
+    unsigned long   countAtOrBelow(unsigned long bound) const;
+
+    static size_t           bucketIndex(unsigned long value);
+    static unsigned long    bucketUpperBound(size_t index);
+};
+
+/**
+ * Métriques d'un thread (ou fusion de tous les threads).
+ */
+struct MetricsShard {
+    unsigned long       counters[METRIC_COUNTER_COUNT];
+    unsigned long       commandCounts[METRICS_MAX_VERBS];
+    LatencyHistogram    commandTimes[METRICS_MAX_VERBS];
+    LatencyHistogram    timers[TIMER_COUNT];
+
+    MetricsShard();
+};
+
+/**
+ * Registre des métriques.
+ *
+ * Chaque thread écrit dans son propre shard (créé au premier
+ * enregistrement) : aucun verrou ni instruction atomique de type
+ * lecture-modification-écriture sur le chemin chaud. Une lecture
+ * (STATS, scrape HTTP) additionne les shards.
+ */
+class Metrics {
+public:
+    static long         now();
+
+    static void         add(MetricCounter counter, unsigned long amount);
+    static void         recordTime(MetricTimer timer, unsigned long nanoseconds);
+    static void         recordCommand(size_t verb, unsigned long nanoseconds);
+
+    static void         registerVerb(size_t verb, const char* name);
+    static size_t       getVerbCount();
+    static const char*  getVerbName(size_t verb);
+
+    static void         snapshot(MetricsShard& out);
+    static long         getUptimeSeconds();
+    static std::string  renderPrometheus();
+};
+
+#endif
@@ -0,0 +1,70 @@
+/* ************************************************************************** */
+/*                                                                            */
+/*                                                        :::      ::::::::   */
+/*   MetricsEndpoint.hpp                                :+:      :+:    :+:   */
+/*                                                    +:+ +:+         +:+     */
+/*   By: kpourcel <marvin@42.fr>                    +#+  +:+       +#+        */
+/*                                                +#+#+#+#+#+   +#+           */
+/*   Created: 2025/04/15 14:02:51 by kpourcel          #+#    #+#             */
+/*   Updated: 2025/04/15 14:02:51 by kpourcel         ###   ########.fr       */
+/*                                                                            */
+/* ************************************************************************** */
+
+#ifndef METRICSENDPOINT_HPP
+#define METRICSENDPOINT_HPP
+
+#include <map>
+#include <string>
+
+#include "EventLoop.hpp"
+
+#define METRICS_REQUEST_MAX 4096
+
+class Server;
+
+/**
+ * Une requête HTTP en cours sur l'endpoint de métriques.
+ */
+struct MetricsRequest {
+    std::string input;
+    std::string output;
+    size_t      sent;
+
+    MetricsRequest() : sent(0) {}
+};
+
+/**
+ * Endpoint HTTP minimal pour Prometheus (GET /metrics), en écoute sur
+ * 127.0.0.1 uniquement.
+ *
+ * Ses sockets sont surveillés par la boucle d'événements du cœur : la
+ * réponse est rendue entre deux itérations, sans thread ni verrou.
+ * Une connexion = une requête, fermée après la réponse.
+ */
+class MetricsEndpoint {
+private:
+    Server&                         server;
+    EventLoop*                      eventLoop;
+    int                             listenSocket;
+    std::map<int, MetricsRequest>   requests;
+
+    void    acceptRequests();
+    void    readRequest(int fd);
+    void    writeResponse(int fd);
+    void    closeRequest(int fd);
+
+    MetricsEndpoint(const MetricsEndpoint&);
+    MetricsEndpoint& operator=(const MetricsEndpoint&);
+
+public:
+    MetricsEndpoint(Server& server, EventLoop* loop);
+    ~MetricsEndpoint();
+
+    bool    open(int port);
+    bool    adopt(int socket);
+    int     getListenSocket() const;
+    bool    owns(int fd) const;
+    void    handleEvent(int fd, int events);
+};
+
+#endif
@@ -0,0 +1,61 @@
+/* ************************************************************************** */
+/*                                                                            */
+/*                                                        :::      ::::::::   */
+/*   NickIndex.hpp                                      :+:      :+:    :+:   */
+/*                                                    +:+ +:+         +:+     */
+/*   By: kpourcel <marvin@42.fr>                    +#+  +:+       +#+        */
+/*                                                +#+#+#+#+#+   +#+           */
+/*   Created: 2025/04/05 09:41:57 by kpourcel          #+#    #+#             */
+/*   Updated: 2025/04/05 09:41:57 by kpourcel         ###   ########.fr       */
+/*                                                                            */
+/* ************************************************************************** */
+
+#ifndef NICKINDEX_HPP
+#define NICKINDEX_HPP
+
+#include <string>
+#include <vector>
+#include <cstddef>
+
+class Client;
+
+/**
+ * Table de hachage pseudo -> Client.
+ *
+ * Les clés sont comparées selon le casemapping RFC 1459 : en plus de A-Z,
+ * les caractères []\^ sont les majuscules de {}|~. Ainsi "Nick[1]" et
+ * "nick{1}" désignent le même utilisateur.
+ */
+class NickIndex {
+private:
+    struct Node {
+        std::string key;
+        size_t      hash;
+        Client*     client;
+        Node*       next;
+    };
+
+    std::vector<Node*>  buckets;
+    size_t              count;
+
+    Node*   findNode(const std::string& nickname, size_t hash) const;
+    void    rehash(size_t newBucketCount);
+
+    NickIndex(const NickIndex& other);
+    NickIndex& operator=(const NickIndex& other);
+
+public:
+    NickIndex();
+    ~NickIndex();
+
+    bool    insert(const std::string& nickname, Client* client);
+    bool    erase(const std::string& nickname);
+    Client* find(const std::string& nickname) const;
+    size_t  size() const;
+
+    static char         foldChar(char c);
+    static bool         equals(const std::string& a, const std::string& b);
+    static size_t       hashNick(const std::string& nickname);
+};
+
+#endif
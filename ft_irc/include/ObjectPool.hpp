@@ -0,0 +1,121 @@
+/* ************************************************************************** */
+/*                                                                            */
+/*                                                        :::      ::::::::   */
+/*   ObjectPool.hpp                                     :+:      :+:    :+:   */
+/*                                                    +:+ +:+         +:+     */
+/*   By: kpourcel <marvin@42.fr>                    +#+  +:+       +#+        */
+/*                                                +#+#+#+#+#+   +#+           */
+/*   Created: 2025/04/12 09:40:27 by kpourcel          #+#    #+#             */
+/*   Updated: 2025/04/12 09:40:27 by kpourcel         ###   ########.fr       */
+/*                                                                            */
+/* ************************************************************************** */
+
+#ifndef OBJECTPOOL_HPP
+#define OBJECTPOOL_HPP
+
+#include <cstddef>
+#include <vector>
+#include <new>
+
+#define POOL_SLAB_OBJECTS 64
+
+/**
+ * Occupation d'un pool (pour les statistiques du serveur).
+ */
+struct PoolStats {
+    size_t  slabs;
+    size_t  capacity;
+    size_t  inUse;
+    size_t  peak;
+    size_t  allocations;
+    size_t  reuses;
+
+    PoolStats() : slabs(0), capacity(0), inUse(0), peak(0), allocations(0), reuses(0) {}
+};
+
+/**
+ * Allocateur par slabs d'objets de taille fixe.
+ *
+ * La mémoire est réservée par blocs de POOL_SLAB_OBJECTS emplacements et
+ * n'est jamais rendue au système : un emplacement libéré est chaîné dans une
+ * free-list et réutilisé en priorité (le plus récemment libéré d'abord,
+ * encore chaud dans le cache). Les objets d'un même type restent regroupés
+ * au lieu d'être dispersés dans le tas.
+ *
+ * Le pool ne fournit que la mémoire : il sert d'`operator new/delete` de
+ * classe (voir Client et Channel). Il n'est pas thread-safe ; ces objets ne
+ * sont créés et détruits que par le thread principal.
+ */
+template <typename T>
+class ObjectPool {
+private:
+    union Slot {
+        Slot*       next;
+        char        object[sizeof(T)];
+        long double alignDouble;
+        long long   alignLong;
+        void*       alignPointer;
+    };
+
+    std::vector<Slot*>  slabs;
+    Slot*               freeList;
+    size_t              untouched;
+    PoolStats           stats;
+
+    ObjectPool(const ObjectPool& other);
+    ObjectPool& operator=(const ObjectPool& other);
+
+public:
+    ObjectPool() : freeList(NULL), untouched(0) {}
+
+    ~ObjectPool() {
+        for (size_t i = 0; i < slabs.size(); ++i)
+            ::operator delete(slabs[i]);
+    }
+
+    /**
+     * @brief Fournit un emplacement non initialisé pour un objet T.
+     *
+     * La free-list est servie en premier ; sinon l'emplacement suivant du
+     * dernier slab, et un nouveau slab n'est réservé que s'il est plein.
+     */
+    void* allocate() {
+        Slot* slot;
+        if (freeList) {
+            slot = freeList;
+            freeList = slot->next;
+            ++stats.reuses;
+        } else {
+            if (untouched == 0) {
+                slabs.push_back(static_cast<Slot*>(::operator new(sizeof(Slot) * POOL_SLAB_OBJECTS)));
+                untouched = POOL_SLAB_OBJECTS;
+                stats.slabs = slabs.size();
+                stats.capacity += POOL_SLAB_OBJECTS;
+            }
+            slot = slabs.back() + (POOL_SLAB_OBJECTS - untouched);
+            --untouched;
+        }
+        ++stats.allocations;
+        if (++stats.inUse > stats.peak)
+            stats.peak = stats.inUse;
+        return slot->object;
+    }
+
+    /**
+     * @brief Rend un emplacement (objet déjà détruit) à la free-list.
+     */
+    void release(void* ptr) {
+        if (!ptr)
+            return;
+        Slot* slot = static_cast<Slot*>(ptr);
+        slot->next = freeList;
+        freeList = slot;
+        --stats.inUse;
+    }
+
+    const PoolStats& getStats() const {
+        return stats;
+    }
+};
+
+#endif
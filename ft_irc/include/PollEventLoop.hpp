@@ -0,0 +1,43 @@
+/* ************************************************************************** */
+/*                                                                            */
+/*                                                        :::      ::::::::   */
+/*   PollEventLoop.hpp                                  :+:      :+:    :+:   */
+/*                                                    +:+ +:+         +:+     */
+/*   By: kpourcel <marvin@42.fr>                    +#+  +:+       +#+        */
+/*                                                +#+#+#+#+#+   +#+           */
+/*   Created: 2025/04/03 10:14:02 by kpourcel          #+#    #+#             */
+/*   Updated: 2025/04/03 10:14:02 by kpourcel         ###   ########.fr       */
+/*                                                                            */
+/* ************************************************************************** */
+
+#ifndef POLLEVENTLOOP_HPP
+#define POLLEVENTLOOP_HPP
+
+#include <poll.h>
+#include "EventLoop.hpp"
+
+/**
+ * Backend de repli basé sur poll().
+ *
+ * Les pollfd sont gardés compacts : un index fd -> position permet de
+ * retirer un descripteur en O(1) en le remplaçant par le dernier.
+ */
+class PollEventLoop : public EventLoop {
+private:
+    std::vector<struct pollfd>  pollFds;
+    std::vector<int>            slots;
+
+    static short    toPollEvents(int events);
+
+public:
+    PollEventLoop();
+    virtual ~PollEventLoop();
+
+    virtual bool        add(int fd, int events);
+    virtual bool        modify(int fd, int events);
+    virtual void        remove(int fd);
+    virtual int         wait(std::vector<IoEvent>& events, int timeoutMs);
+    virtual const char* getName() const;
+};
+
+#endif
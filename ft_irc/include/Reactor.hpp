@@ -0,0 +1,195 @@
+/* ************************************************************************** */
+/*                                                                            */
+/*                                                        :::      ::::::::   */
+/*   Reactor.hpp                                        :+:      :+:    :+:   */
+/*                                                    +:+ +:+         +:+     */
+/*   By: kpourcel <marvin@42.fr>                    +#+  +:+       +#+        */
+/*                                                +#+#+#+#+#+   +#+           */
+/*   Created: 2025/04/11 14:20:44 by kpourcel          #+#    #+#             */
+/*   Updated: 2025/04/11 14:20:44 by kpourcel         ###   ########.fr       */
+/*                                                                            */
+/* ************************************************************************** */
+
+#ifndef REACTOR_HPP
+#define REACTOR_HPP
+
+#include <map>
+#include <string>
+#include <vector>
+#include <pthread.h>
+
+#include "EventLoop.hpp"
+#include "Mailbox.hpp"
+#include "MessageBuffer.hpp"
+#include "RecvBuffer.hpp"
+#include "SendQueue.hpp"
+
+/**
+ * Nombre de lignes transmises au cœur et pas encore traitées au-delà
+ * duquel un réacteur cesse de lire la connexion (reprise à la moitié).
+ */
+#define REACTOR_INFLIGHT_LINES 64
+
+class Reactor;
+class Channel;
+
+/**
+ * Connexion détenue par un réacteur.
+ *
+ * Seuls `inflight` et `paused` sont partagés avec le cœur (accès atomiques) ;
+ * le reste n'est touché que par le thread du réacteur.
+ */
+struct ReactorConnection {
+    int         fd;
+    RecvBuffer  input;
+    SendQueue   output;
+    bool        writeArmed;
+    bool        dead;
+    bool        flushPending;
+    int         inflight;
+    int         paused;
+    std::vector<const Channel*> channels;
+
+    explicit ReactorConnection(int socketFd);
+};
+
+/**
+ * Événement réacteur → cœur.
+ */
+struct ReactorEvent {
+    enum Type {
+        CONNECTED,
+        LINE,
+        LINE_TOO_LONG,
+        CLOSED
+    };
+
+    Type                type;
+    int                 fd;
+    Reactor*            reactor;
+    ReactorConnection*  connection;
+    MessageBuffer       payload;
+
+    ReactorEvent();
+};
+
+/**
+ * Commande cœur → réacteur.
+ *
+ * Pour FANOUT, `fd` est le membre exclu de la diffusion (-1 pour aucun).
+ * `channel` n'est qu'une clé : le réacteur ne le déréférence jamais.
+ */
+struct ReactorCommand {
+    enum Type {
+        SEND,
+        FANOUT,
+        JOIN,
+        PART,
+        CLOSE,
+        RESUME,
+        STOP
+    };
+
+    Type            type;
+    int             fd;
+    SendQueue*      batch;
+    const Channel*  channel;
+    MessageBuffer   message;
+
+    ReactorCommand();
+};
+
+/**
+ * Connexions d'un réacteur membres d'un channel, triées par fd (comme
+ * MemberList : parcours linéaire, recherche dichotomique).
+ */
+typedef std::vector<ReactorConnection*> FanoutMembers;
+
+/**
+ * Thread d'entrées/sorties du mode multi-thread (--threads=N).
+ *
+ * Chaque réacteur possède son socket d'écoute (SO_REUSEPORT, le noyau
+ * répartit les connexions), sa boucle d'événements et ses connexions :
+ * accept, recv, découpage des lignes et send se font sans aucun verrou.
+ *
+ * L'état IRC (pseudos, channels) reste sur le thread principal, le cœur,
+ * qui reçoit les lignes par sa boîte aux lettres et renvoie les réponses
+ * par celle du réacteur propriétaire du destinataire.
+ *
+ * Chaque réacteur garde une copie des appartenances de ses connexions
+ * (JOIN/PART envoyés par le cœur) : une diffusion sur un channel coûte au
+ * cœur un message par réacteur (FANOUT), et chaque réacteur sert lui-même
+ * ses membres, en parallèle des autres.
+ *
+ * Le cœur prépare les commandes d'une itération dans `outbox`, dans l'ordre
+ * où il les produit, et les confie en fin d'itération (flushQueued). Les
+ * réponses directes d'un client s'accumulent dans un seul lot SEND tant
+ * qu'aucune diffusion n'est placée après lui : l'ordre reçu par chaque
+ * client est celui du cœur, et le regroupement par itération est gardé.
+ *
+ * Un socket n'est fermé que sur ordre du cœur (CLOSE) : un numéro de fd ne
+ * peut pas être réattribué tant que le cœur le croit encore utilisé. Les
+ * commandes d'un réacteur ne viennent que du cœur, dans l'ordre : le PART
+ * d'un membre précède toujours son CLOSE et la suppression du channel.
+ */
+class Reactor {
+private:
+    int                                 id;
+    int                                 listenSocket;
+    size_t                              sendQueueLimit;
+    EventLoop*                          eventLoop;
+    pthread_t                           thread;
+    bool                                started;
+    bool                                running;
+    bool                                notifyCore;
+    Mailbox<ReactorCommand>             commands;
+    Mailbox<ReactorEvent>&              coreInbox;
+    std::map<int, ReactorConnection*>   connections;
+    std::map<const Channel*, FanoutMembers> channelMembers;
+    std::vector<int>                    flushList;
+    std::vector<ReactorCommand>         outbox;
+    unsigned long                       outboxEpoch;
+
+    Reactor(const Reactor& other);
+    Reactor& operator=(const Reactor& other);
+
+    static void*    threadMain(void* arg);
+    void            loop();
+    void            acceptConnections();
+    void            readConnection(ReactorConnection* conn);
+    void            flushConnection(ReactorConnection* conn);
+    void            handleCommands();
+    void            deliver(ReactorConnection* conn, const MessageBuffer& message);
+    void            scheduleFlush(ReactorConnection* conn);
+    void            fanoutMessage(const ReactorCommand& cmd);
+    void            joinChannel(ReactorConnection* conn, const Channel* channel);
+    void            partChannel(ReactorConnection* conn, const Channel* channel);
+    void            dropConnection(ReactorConnection* conn, const std::string& reason);
+    void            destroyConnection(ReactorConnection* conn);
+    void            post(ReactorEvent::Type type, ReactorConnection* conn, const MessageBuffer& payload);
+    void            command(ReactorCommand::Type type, int fd, SendQueue* batch);
+    void            submit(const ReactorCommand& cmd);
+
+public:
+    Reactor(int id, int listenSocket, const std::string& backend, size_t sendQueueLimit,
+            Mailbox<ReactorEvent>& coreInbox);
+    ~Reactor();
+
+    bool    start();
+    void    stop();
+    int     getId() const;
+
+    /**
+     * Appelés depuis le cœur (mis dans `outbox` jusqu'à flushQueued)
+     */
+    SendQueue*      stageBatch(int fd);
+    unsigned long   getOutboxEpoch() const;
+    void    fanout(const Channel* channel, const MessageBuffer& message, int excludeFd);
+    void    addMember(int fd, const Channel* channel);
+    void    removeMember(int fd, const Channel* channel);
+    void    closeConnection(int fd);
+    void    flushQueued();
+    void    lineDone(ReactorConnection* conn);
+};
+
+#endif
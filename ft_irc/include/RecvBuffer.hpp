@@ -0,0 +1,58 @@
+/* ************************************************************************** */
+/*                                                                            */
+/*                                                        :::      ::::::::   */
+/*   RecvBuffer.hpp                                     :+:      :+:    :+:   */
+/*                                                    +:+ +:+         +:+     */
+/*   By: kpourcel <marvin@42.fr>                    +#+  +:+       +#+        */
+/*                                                +#+#+#+#+#+   +#+           */
+/*   Created: 2025/04/09 11:37:20 by kpourcel          #+#    #+#             */
+/*   Updated: 2025/04/09 11:37:20 by kpourcel         ###   ########.fr       */
+/*                                                                            */
+/* ************************************************************************** */
+
+#ifndef RECVBUFFER_HPP
+#define RECVBUFFER_HPP
+
+#include <cstddef>
+
+#define RECV_BUFFER_SIZE    4096
+#define IRC_LINE_MAX        512
+
+/**
+ * Tampon de réception à capacité fixe (fenêtre glissante).
+ *
+ * Les données reçues sont ajoutées en fin de fenêtre ; les lignes sont
+ * extraites en place (pointeur + longueur) sans copie ni erase. La fenêtre
+ * n'est recompactée (memmove de ce qui n'a pas été consommé) que lorsqu'il
+ * manque de la place à la fin. Une ligne de plus de 512 octets (CRLF compris) est
+ * signalée puis ignorée jusqu'au prochain saut de ligne.
+ */
+class RecvBuffer {
+private:
+    char    data[RECV_BUFFER_SIZE];
+    size_t  start;
+    size_t  end;
+    size_t  scanned;
+    bool    discarding;
+
+public:
+    enum LineStatus {
+        LINE_NONE,
+        LINE_READY,
+        LINE_TOO_LONG
+    };
+
+    RecvBuffer();
+
+    char*       writePtr();
+    size_t      prepareWrite();
+    void        commit(size_t length);
+
+    LineStatus  nextLine(const char*& line, size_t& length);
+    void        unread(const char* line);
+    size_t      size() const;
+    bool        empty() const;
+    const char* peek() const;
+};
+
+#endif
@@ -0,0 +1,49 @@
+/* ************************************************************************** */
+/*                                                                            */
+/*                                                        :::      ::::::::   */
+/*   SendQueue.hpp                                      :+:      :+:    :+:   */
+/*                                                    +:+ +:+         +:+     */
+/*   By: kpourcel <marvin@42.fr>                    +#+  +:+       +#+        */
+/*                                                +#+#+#+#+#+   +#+           */
+/*   Created: 2025/04/11 10:48:36 by kpourcel          #+#    #+#             */
+/*   Updated: 2025/04/11 10:48:36 by kpourcel         ###   ########.fr       */
+/*                                                                            */
+/* ************************************************************************** */
+
+#ifndef SENDQUEUE_HPP
+#define SENDQUEUE_HPP
+
+#include <deque>
+#include <string>
+#include <cstddef>
+#include <sys/types.h>
+
+#include "MessageBuffer.hpp"
+
+#define SEND_IOV_MAX 64
+
+/**
+ * File d'envoi d'une connexion : références vers des MessageBuffer
+ * partagés, avec suivi des écritures partielles.
+ */
+class SendQueue {
+private:
+    std::deque<MessageBuffer>   queue;
+    size_t                      offset;
+    size_t                      bytes;
+
+public:
+    SendQueue();
+
+    bool        push(const MessageBuffer& message, size_t limit);
+    void        append(SendQueue& other);
+    void        clear();
+
+    bool        empty() const;
+    size_t      size() const;
+    void        copyTo(std::string& out) const;
+    void        consume(size_t length);
+    ssize_t     writeTo(int fd);
+};
+
+#endif
@@ -15,6 +15,7 @@
 
 #include <iostream>
 #include <vector>
+#include <deque>
 #include <map>
 #include <string>
 #include <cstring>
@@ -24,39 +25,183 @@
 #include <sys/socket.h>
 #include <netinet/in.h>
 #include <arpa/inet.h>
-#include <poll.h>
+#include <fcntl.h>
+#include <cerrno>
 #include <sstream>
 #include <csignal>
+#include <cctype>
+#include <sys/wait.h>
 
 #include "Client.hpp"
 #include "Channel.hpp"
 #include "CommandHandler.hpp"
+#include "EventLoop.hpp"
+#include "Config.hpp"
+#include "MessageBuffer.hpp"
+#include "NickIndex.hpp"
+#include "ClientTable.hpp"
+#include "Reactor.hpp"
+#include "Logger.hpp"
+#include "Metrics.hpp"
+#include "MetricsEndpoint.hpp"
+#include "TimerWheel.hpp"
+#include "ChannelHistory.hpp"
+#include "Archive.hpp"
+#include "Snapshot.hpp"
+#include "Handoff.hpp"
 
-#define MAX_CLIENTS 100
+#define LISTEN_BACKLOG SOMAXCONN
+#define INPUT_BUDGET_LINES 16
+#define INPUT_BUDGET_BYTES 2048
+#define REACTOR_EVENTS_PER_TURN 4096
 
 class Client;
 class CommandHandler;
+class Server;
+struct ChannelModeDef;
+
+typedef bool (Server::*ChannelModeFn)(Channel* channel, int clientSocket, const ChannelModeDef& mode,
+                                      bool adding, std::string& param);
+
+/**
+ * Entrée de la table des modes de channel : la lettre, quand elle consomme
+ * un paramètre, le bit de statut membre concerné (o, v) et la fonction qui
+ * l'applique (renvoie false si rien n'a changé ou si le mode est refusé).
+ */
+struct ChannelModeDef {
+    char            letter;
+    bool            paramOnSet;
+    bool            paramOnUnset;
+    unsigned int    memberMode;
+    ChannelModeFn   apply;
+};
 
 class Server {
     private:
         int                             serverSocket;
         int                             port;
         std::string                     password;
-        std::vector<struct pollfd>      pollFds;
-        std::map<int, Client*>          clients;
+        EventLoop*                      eventLoop;
+        size_t                          sendQueueLimit;
+        std::vector<int>                pendingDisconnects;
+        std::vector<int>                listenSockets;
+        std::vector<Reactor*>           reactors;
+        Mailbox<ReactorEvent>           reactorEvents;
+        std::vector<int>                dirtyClients;
+        ClientTable                     clients;
         std::map<std::string, Channel*> channels;
+        NickIndex                       nicknames;
         CommandHandler                  commandHandler;
+        MetricsEndpoint*                metrics;
+        Archive*                        archive;
+        Snapshot*                       snapshot;
+        std::string                     operName;
+        std::string                     operPassword;
+        TimerWheel                      timers;
+        Timer                           snapshotTimer;
+        long                            snapshotIntervalMs;
+        std::vector<std::string>        dirtyChannels;
+        std::vector<std::string>        commandLine;
+        volatile sig_atomic_t           upgradeRequested;
+        volatile sig_atomic_t           upgradeRequester;
+        volatile sig_atomic_t           shutdownRequested;
+        int                             wakePipe[2];
+        long                            pingIntervalMs;
+        long                            pingTimeoutMs;
+        long                            registerTimeoutMs;
+        long                            floodRate;
+        long                            floodBurst;
+        std::deque<int>                 readyClients;
+        unsigned long                   loopTurn;
+        unsigned long                   visitEpoch;
+        unsigned long                   historyBatch;
+        bool                            reactorBacklog;
+        HistoryStore                    history;
 
         /**
          * Gestion des Connexions
          */
+        int     createListenSocket(bool reusePort);
         void    handleNewConnection();
-        void    removeClient(int clientSocket);
+        void    registerClient(int clientSocket, const std::string& address,
+                               Reactor* reactor = NULL, ReactorConnection* connection = NULL);
+        void    removeClient(int clientSocket, const std::string& reason = "Client disconnected");
+        void    closeClientSocket(int clientSocket);
+        void    reapClients();
+        void    leaveChannel(Channel* channel, int clientSocket);
+        void    leaveAllChannels(int clientSocket, const MessageBuffer& message);
+        void    shareMembership(Channel* channel, Client* client, bool joined);
+        void    expireClient(int clientSocket, const std::string& reason);
+
+        /**
+         * Timers (PING, délai d'enregistrement, reprise après flood)
+         */
+        void    runTimers();
+        void    handleTimer(Timer& timer);
+        void    handlePingTimer(Client* client);
+
+        /**
+         * Instantanés de l'état des channels
+         */
+        void    loadSnapshot();
+        void    markChannelDirty(Channel* channel);
+        void    snapshotChannels();
+
+        /**
+         * Mise à jour à chaud (SIGUSR2 ou UPGRADE)
+         */
+        void    upgrade();
+        void    serializeState(std::string& state, std::vector<int>& fds);
+        bool    restoreState(const std::string& state, const std::vector<int>& fds);
+        void    stopWriters();
+        void    startWriters();
         
         /**
          * Gestion des Messages
          */
         void    handleClientMessage(int clientSocket);
+        bool    processClientLines(int clientSocket, bool budgeted = true);
+        void    flushClient(int clientSocket);
+        void    flushOutput();
+        void    executeLine(int clientSocket, const char* line, size_t length, const ParsedLine& parsed);
+        bool    admitLine(Client* client, const ParsedLine& parsed);
+        void    resumeClient(Client* client);
+        bool    hasInputBudget(Client* client);
+        void    spendInputBudget(Client* client, size_t length);
+        void    markReady(Client* client);
+        void    runReadyClients();
+        int     nextWaitTimeout() const;
+        void    broadcast(Channel* channel, const MessageBuffer& message, int excludeSocket);
+        void    broadcastToPeers(Client* client, const MessageBuffer& message);
+        void    sendNames(int clientSocket, Channel* channel);
+
+        /**
+         * Modes de channel
+         */
+        static const ChannelModeDef channelModeTable[];
+        static const size_t         channelModeCount;
+
+        static const ChannelModeDef* findChannelMode(char letter);
+        void    sendChannelModes(int clientSocket, Channel* channel);
+        static bool findHistoryReference(const ChannelHistory& log, const std::string& reference,
+                                         size_t& position, size_t& after);
+        bool    applyInviteOnly(Channel* channel, int clientSocket, const ChannelModeDef& mode, bool adding, std::string& param);
+        bool    applyTopicRestricted(Channel* channel, int clientSocket, const ChannelModeDef& mode, bool adding, std::string& param);
+        bool    applyKey(Channel* channel, int clientSocket, const ChannelModeDef& mode, bool adding, std::string& param);
+        bool    applyUserLimit(Channel* channel, int clientSocket, const ChannelModeDef& mode, bool adding, std::string& param);
+        bool    applyMemberMode(Channel* channel, int clientSocket, const ChannelModeDef& mode, bool adding, std::string& param);
+
+        /**
+         * Mode multi-thread (réacteurs)
+         */
+        void    runReactors();
+        void    stopReactors();
+        void    shutdownServer();
+        void    handleRequests();
+        void    wakeLoop();
+        void    drainWakePipe();
+        void    drainReactorEvents();
+        void    handleReactorEvent(const ReactorEvent& event);
     
     public:
         std::string     serverName;
@@ -65,18 +210,21 @@ class Server {
          * Constructeur / Destructeur
          */
         Server();
-        Server(int port, std::string password);
+        Server(int port, std::string password, const ServerConfig& config);
         ~Server();
     
         /**
          * Gestion du Serveur
          */
         void    run();
-        void    shutdownServer();
+        void    requestShutdown(int signum);
+        void    requestUpgrade(int clientSocket);
 
         /**
          * Gestion des Messages
          */
+        void    sendToClient(int clientSocket, const MessageBuffer& message);
+        void    sendToClient(int clientSocket, const std::string& message);
         void    handlePrivMsg(int clientSocket, const std::string& target, const std::string& message);
 
         /**
@@ -90,6 +238,14 @@ class Server {
         void    handleList(int clientSocket);
         void    handleQuit(int clientSocket, const std::string& quitMessage);
         void    handlePing(int clientSocket, const std::string& token);
+        void    handleWhois(int clientSocket, const std::string& targetNick);
+        void    handleNames(int clientSocket, const std::string& channelName);
+        void    handleOper(int clientSocket, const std::string& name, const std::string& password);
+        void    handleStats(int clientSocket, const std::string& query);
+        void    handleUpgrade(int clientSocket);
+        void    handleChatHistory(int clientSocket, const std::string& subcommand, const std::string& target,
+                                  const std::string& first, const std::string& second,
+                                  const std::string& third);
 
         /**
          * Gestion des Commandes Opérateurs
@@ -97,13 +253,16 @@ class Server {
         void    handleKick(int clientSocket, const std::string& channelName, const std::string& targetNick);
         void    handleInvite(int clientSocket, const std::string& channelName, const std::string& targetNick);
         void    handleTopic(int clientSocket, const std::string& channelName, const std::string& topic);
-        void    handleMode(int clientSocket, const std::string& channelName, const std::string& mode, const std::string& param);
+        void    handleMode(int clientSocket, const std::string& channelName, const std::string& modes,
+                           const std::vector<std::string>& params);
 
         /**
          * Utilitaires
          */
         int     getClientSocketByNickname(const std::string& nickname) const;
-        std::map<int, Client*>& getClients();
+        ClientTable&    getClients();
+        void    logPoolStats() const;
+        std::string     renderMetrics() const;
     };
 
 
@@ -0,0 +1,127 @@
+/* ************************************************************************** */
+/*                                                                            */
+/*                                                        :::      ::::::::   */
+/*   Snapshot.hpp                                       :+:      :+:    :+:   */
+/*                                                    +:+ +:+         +:+     */
+/*   By: kpourcel <marvin@42.fr>                    +#+  +:+       +#+        */
+/*                                                +#+#+#+#+#+   +#+           */
+/*   Created: 2025/04/19 10:12:44 by kpourcel          #+#    #+#             */
+/*   Updated: 2025/04/19 10:12:44 by kpourcel         ###   ########.fr       */
+/*                                                                            */
+/* ************************************************************************** */
+
+#ifndef SNAPSHOT_HPP
+#define SNAPSHOT_HPP
+
+#include <string>
+#include <vector>
+#include <map>
+#include <cstddef>
+#include <pthread.h>
+
+#include "Mailbox.hpp"
+
+/**
+ * Format du fichier d'état des channels
+ *
+ * En-tête de SNAPSHOT_HEADER_SIZE octets, entiers en petit-boutiste :
+ *
+ *   SNAPSHOT_MAGIC | u32 nombre de channels | u32 taille du corps |
+ *   u32 CRC32 du corps
+ *
+ * Corps : les channels triés par nom, chacun encodé ainsi :
+ *
+ *   u16 + octets du nom | u8 drapeaux (SnapshotFlag) | u32 limite |
+ *   u16 + octets de la clé | u16 + octets du topic |
+ *   u16 nombre d'opérateurs | u16 + octets de chaque pseudo
+ *
+ * Le fichier est remplacé d'un bloc (.tmp, fdatasync, rename) : il est
+ * toujours soit l'ancien, soit le nouveau, jamais un mélange des deux.
+ */
+#define SNAPSHOT_MAGIC          "IRCSNP01"
+#define SNAPSHOT_MAGIC_SIZE     8
+#define SNAPSHOT_HEADER_SIZE    20
+
+enum SnapshotFlag {
+    SNAPSHOT_INVITE_ONLY = 1,
+    SNAPSHOT_TOPIC_RESTRICTED = 2
+};
+
+/**
+ * État d'un channel relu au démarrage.
+ */
+struct SnapshotChannel {
+    std::string                 name;
+    unsigned int                flags;
+    int                         userLimit;
+    std::string                 key;
+    std::string                 topic;
+    std::vector<std::string>    operators;
+};
+
+/**
+ * Channel modifié : son enregistrement encodé, vide s'il n'existe plus.
+ */
+struct SnapshotEntry {
+    std::string name;
+    std::string record;
+};
+
+typedef std::vector<SnapshotEntry> SnapshotDelta;
+
+/**
+ * Instantanés de l'état des channels (topic, clé, +i/+t/+l, opérateurs).
+ *
+ * Incrémentaux et sans fork : à chaque intervalle, le thread principal
+ * n'encode que les channels modifiés depuis l'instantané précédent (copie
+ * cohérente, prise entre deux itérations de la boucle) et remet ce delta au
+ * thread d'écriture par une Mailbox. Ce thread tient l'image complète (nom ->
+ * enregistrement encodé), y applique les deltas et réécrit le fichier.
+ *
+ * Au démarrage, open() projette le fichier en mémoire (mmap) et vérifie le
+ * CRC, puis next() décode les channels un à un dans la même structure (sans
+ * allocation une fois ses chaînes dimensionnées). La projection est ensuite
+ * confiée au thread d'écriture, qui en tire son image initiale : la boucle
+ * ne paie que le décodage.
+ */
+class Snapshot {
+private:
+    std::string                         path;
+    const char*                         mapped;
+    size_t                              mappedSize;
+    size_t                              readOffset;
+    Mailbox<SnapshotDelta*>             deltas;
+    pthread_t                           writerThread;
+    int                                 running;
+
+    /* Thread d'écriture uniquement */
+    std::map<std::string, std::string>  image;
+    std::string                         buffer;
+
+    static void*    writerMain(void* arg);
+    void            writerLoop();
+    void            loadImage();
+    void            unmap();
+    bool            applyDeltas();
+    bool            writeFile();
+
+    Snapshot(const Snapshot& other);
+    Snapshot& operator=(const Snapshot& other);
+
+public:
+    explicit Snapshot(const std::string& path);
+    ~Snapshot();
+
+    bool    open();
+    bool    next(SnapshotChannel& channel);
+    bool    start();
+    void    stop();
+    void    publish(SnapshotDelta* delta);
+
+    static void encode(std::string& out, const std::string& name, unsigned int flags, int userLimit,
+                       const std::string& key, const std::string& topic,
+                       const std::vector<std::string>& operators);
+    static bool decode(const char* data, size_t length, size_t& offset, SnapshotChannel& channel);
+};
+
+#endif
@@ -0,0 +1,105 @@
+/* ************************************************************************** */
+/*                                                                            */
+/*                                                        :::      ::::::::   */
+/*   TimerWheel.hpp                                     :+:      :+:    :+:   */
+/*                                                    +:+ +:+         +:+     */
+/*   By: kpourcel <marvin@42.fr>                    +#+  +:+       +#+        */
+/*                                                +#+#+#+#+#+   +#+           */
+/*   Created: 2025/04/16 09:41:07 by kpourcel          #+#    #+#             */
+/*   Updated: 2025/04/16 09:41:07 by kpourcel         ###   ########.fr       */
+/*                                                                            */
+/* ************************************************************************** */
+
+#ifndef TIMERWHEEL_HPP
+#define TIMERWHEEL_HPP
+
+#include <cstddef>
+
+#define TIMER_TICK_MS       100
+#define TIMER_LEVEL_BITS    6
+#define TIMER_SLOTS         (1 << TIMER_LEVEL_BITS)
+#define TIMER_LEVELS        4
+
+class TimerWheel;
+
+/**
+ * Maillon d'une liste circulaire doublement chaînée (sentinelle des cases).
+ */
+struct TimerLink {
+    TimerLink*  prev;
+    TimerLink*  next;
+
+    TimerLink();
+    void        unlink();
+    bool        linked() const;
+};
+
+/**
+ * Timer intrusif : il est embarqué dans l'objet qui l'utilise (Client),
+ * aucune allocation n'est faite pour l'armer ou l'annuler. Il se désarme
+ * tout seul à sa destruction.
+ *
+ * `owner` et `kind` permettent à l'appelant de retrouver quoi faire du
+ * timer quand il expire.
+ */
+class Timer : public TimerLink {
+private:
+    TimerWheel*     wheel;
+    unsigned long   expires;
+    int             owner;
+    int             kind;
+
+    Timer(const Timer& other);
+    Timer& operator=(const Timer& other);
+
+    friend class TimerWheel;
+
+public:
+    Timer(int owner, int kind);
+    ~Timer();
+
+    bool    pending() const;
+    int     getOwner() const;
+    int     getKind() const;
+};
+
+/**
+ * Roue de timers hiérarchique (Varghese & Lauck), tic de TIMER_TICK_MS.
+ *
+ * TIMER_LEVELS niveaux de TIMER_SLOTS cases : le niveau n couvre
+ * 64^(n+1) tics (6,4 s, 6,8 min, 7,3 h, 19 jours). Armer et annuler un timer
+ * sont en O(1) ; un tic ne touche qu'une case, et les timers des niveaux
+ * supérieurs ne redescendent (cascade) qu'une fois par niveau. Aucun
+ * parcours des connexions, quel que soit leur nombre.
+ *
+ * Non thread-safe : la roue appartient au thread principal.
+ */
+class TimerWheel {
+private:
+    TimerLink       slots[TIMER_LEVELS][TIMER_SLOTS];
+    TimerLink       expired;
+    unsigned long   currentTick;
+    long            origin;
+    size_t          active;
+
+    void    place(Timer& timer);
+    void    cascade(size_t level);
+
+    TimerWheel(const TimerWheel& other);
+    TimerWheel& operator=(const TimerWheel& other);
+
+public:
+    TimerWheel();
+
+    void    schedule(Timer& timer, long delayMs);
+    void    cancel(Timer& timer);
+
+    void    advance();
+    Timer*  popExpired();
+    int     nextTimeoutMs() const;
+    long    now() const;
+
+    static long monotonicMs();
+};
+
+#endif
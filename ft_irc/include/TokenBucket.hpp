@@ -0,0 +1,35 @@
+/* ************************************************************************** */
+/*                                                                            */
+/*                                                        :::      ::::::::   */
+/*   TokenBucket.hpp                                    :+:      :+:    :+:   */
+/*                                                    +:+ +:+         +:+     */
+/*   By: kpourcel <marvin@42.fr>                    +#+  +:+       +#+        */
+/*                                                +#+#+#+#+#+   +#+           */
+/*   Created: 2025/04/16 15:26:40 by kpourcel          #+#    #+#             */
+/*   Updated: 2025/04/16 15:26:40 by kpourcel         ###   ########.fr       */
+/*                                                                            */
+/* ************************************************************************** */
+
+#ifndef TOKENBUCKET_HPP
+#define TOKENBUCKET_HPP
+
+/**
+ * Seau à jetons d'un client (contrôle de flood).
+ *
+ * Le seau se remplit de `rate` jetons par seconde jusqu'à `burst` jetons ;
+ * chaque commande en consomme selon son coût. Le remplissage est calculé
+ * paresseusement à chaque demande : aucun timer ni parcours périodique.
+ * Les jetons sont comptés en millièmes pour rester en arithmétique entière.
+ */
+class TokenBucket {
+private:
+    long    tokens;
+    long    updated;
+
+public:
+    TokenBucket();
+
+    long    take(long now, unsigned int cost, long rate, long burst);
+};
+
+#endif
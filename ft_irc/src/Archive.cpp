@@ -0,0 +1,254 @@
+/* ************************************************************************** */
+/*                                                                            */
+/*                                                        :::      ::::::::   */
+/*   Archive.cpp                                        :+:      :+:    :+:   */
+/*                                                    +:+ +:+         +:+     */
+/*   By: kpourcel <marvin@42.fr>                    +#+  +:+       +#+        */
+/*                                                +#+#+#+#+#+   +#+           */
+/*   Created: 2025/04/18 09:41:27 by kpourcel          #+#    #+#             */
+/*   Updated: 2025/04/18 09:41:27 by kpourcel         ###   ########.fr       */
+/*                                                                            */
+/* ************************************************************************** */
+
+#include "../include/Archive.hpp"
+#include "../include/ChannelHistory.hpp"
+#include "../include/TimerWheel.hpp"
+#include "../include/Logger.hpp"
+
+#include <cerrno>
+#include <cstdio>
+#include <csignal>
+#include <cstring>
+#include <fcntl.h>
+#include <poll.h>
+#include <unistd.h>
+#include <sys/stat.h>
+
+Archive::Archive(const ArchiveOptions& options)
+    : options(options), sequence(0), running(0), queuedBytes(0), droppedBatches(0),
+      segmentFd(-1), segmentSize(0), segmentStartedAt(0), segmentCount(0),
+      unsyncedBytes(0), lastSync(0) {}
+
+Archive::~Archive() {
+    stop();
+}
+
+/* -------------------------------------------------------------------------- */
+/*                              Thread principal                              */
+/* -------------------------------------------------------------------------- */
+
+/**
+ * @brief Crée le répertoire et le premier segment, puis lance l'écrivain.
+ *
+ * @return false si le répertoire, le segment ou le thread n'a pu être créé.
+ */
+bool Archive::start() {
+    if (mkdir(options.directory.c_str(), 0750) < 0 && errno != EEXIST)
+        return false;
+    if (!openSegment())
+        return false;
+
+    ArchiveFormat::crc32(NULL, 0);
+    sigset_t all;
+    sigset_t previous;
+    sigfillset(&all);
+    pthread_sigmask(SIG_SETMASK, &all, &previous);
+    __atomic_store_n(&running, 1, __ATOMIC_RELEASE);
+    int err = pthread_create(&writerThread, NULL, &Archive::writerMain, this);
+    pthread_sigmask(SIG_SETMASK, &previous, NULL);
+    if (err != 0) {
+        __atomic_store_n(&running, 0, __ATOMIC_RELEASE);
+        closeSegment();
+        return false;
+    }
+    return true;
+}
+
+/**
+ * @brief Publie le dernier lot, attend que l'écrivain ait tout écrit et
+ * synchronisé, puis ferme le segment.
+ */
+void Archive::stop() {
+    if (!__atomic_load_n(&running, __ATOMIC_ACQUIRE))
+        return;
+    publish();
+    __atomic_store_n(&running, 0, __ATOMIC_RELEASE);
+    batches.wake();
+    pthread_join(writerThread, NULL);
+    if (droppedBatches > 0)
+        LOG_WARN("⚠️  Archive : " << droppedBatches << " lot(s) abandonné(s) (écriture trop lente)");
+}
+
+/**
+ * @brief Encode un événement de channel dans le lot courant.
+ */
+void Archive::record(int type, const std::string& channel, const std::string& nick, const std::string& text) {
+    ArchiveFormat::append(pending, ++sequence, HistoryStore::wallClockMs(), type, channel, nick, text);
+}
+
+/**
+ * @brief Remet le lot courant au thread d'écriture (une fois par itération).
+ */
+void Archive::publish() {
+    if (pending.empty() || !__atomic_load_n(&running, __ATOMIC_ACQUIRE))
+        return;
+    size_t size = pending.size();
+    if (__atomic_load_n(&queuedBytes, __ATOMIC_ACQUIRE) + size > ARCHIVE_QUEUE_MAX) {
+        if (droppedBatches++ == 0)
+            LOG_ERROR("❌ Archive : écriture en retard, lots abandonnés");
+        pending.clear();
+        return;
+    }
+    std::string* batch = new std::string;
+    batch->swap(pending);
+    __atomic_add_fetch(&queuedBytes, size, __ATOMIC_ACQ_REL);
+    batches.push(batch);
+    batches.wake();
+}
+
+size_t Archive::getDropped() const {
+    return droppedBatches;
+}
+
+/* -------------------------------------------------------------------------- */
+/*                             Thread d'écriture                              */
+/* -------------------------------------------------------------------------- */
+
+void* Archive::writerMain(void* arg) {
+    static_cast<Archive*>(arg)->writerLoop();
+    return NULL;
+}
+
+/**
+ * @brief Boucle de l'écrivain : attend un lot ou l'échéance du prochain
+ * fdatasync / changement de segment.
+ *
+ * L'âge d'un segment part de son premier enregistrement : un segment vide
+ * n'est jamais remplacé, et le suivant n'est ouvert qu'au lot suivant.
+ */
+void Archive::writerLoop() {
+    lastSync = TimerWheel::monotonicMs();
+    while (true) {
+        bool stopping = !__atomic_load_n(&running, __ATOMIC_ACQUIRE);
+        long now = TimerWheel::monotonicMs();
+        long timeout = ARCHIVE_IDLE_MS;
+        if (segmentSize > ARCHIVE_MAGIC_SIZE && segmentStartedAt + options.segmentAgeMs - now < timeout)
+            timeout = segmentStartedAt + options.segmentAgeMs - now;
+        if (unsyncedBytes > 0 && lastSync + options.syncIntervalMs - now < timeout)
+            timeout = lastSync + options.syncIntervalMs - now;
+        if (timeout < 0)
+            timeout = 0;
+
+        struct pollfd wake;
+        wake.fd = batches.getWakeFd();
+        wake.events = POLLIN;
+        if (!stopping)
+            poll(&wake, 1, static_cast<int>(timeout));
+        batches.acknowledge();
+        drainBatches();
+
+        now = TimerWheel::monotonicMs();
+        if (unsyncedBytes > 0 && (stopping || now - lastSync >= options.syncIntervalMs))
+            sync();
+        if (stopping)
+            break;
+        if (segmentSize > ARCHIVE_MAGIC_SIZE && now - segmentStartedAt >= options.segmentAgeMs)
+            closeSegment();
+    }
+    closeSegment();
+}
+
+/**
+ * @brief Écrit les lots en attente (CRC calculés ici).
+ *
+ * Le changement de segment pour taille se fait entre deux lots.
+ *
+ * @return Nombre de lots écrits.
+ */
+size_t Archive::drainBatches() {
+    size_t count = 0;
+    std::string* batch;
+    while (batches.pop(batch)) {
+        if (segmentFd >= 0 && segmentSize >= options.segmentBytes) {
+            closeSegment();
+            openSegment();
+        }
+        if (!batch->empty()) {
+            ArchiveFormat::seal(&(*batch)[0], batch->size());
+            if (segmentFd < 0 && !openSegment()) {
+                LOG_ERROR("❌ Archive : aucun segment ouvert, lot perdu");
+            } else if (writeAll(batch->data(), batch->size())) {
+                if (segmentSize <= ARCHIVE_MAGIC_SIZE)
+                    segmentStartedAt = TimerWheel::monotonicMs();
+                segmentSize += batch->size();
+                unsyncedBytes += batch->size();
+            }
+        }
+        __atomic_sub_fetch(&queuedBytes, batch->size(), __ATOMIC_ACQ_REL);
+        delete batch;
+        ++count;
+        if (unsyncedBytes >= ARCHIVE_SYNC_BYTES)
+            sync();
+    }
+    return count;
+}
+
+/**
+ * @brief Ouvre un nouveau segment : segment-<ms epoch>-<n>.arc.
+ */
+bool Archive::openSegment() {
+    char name[64];
+    int fd = -1;
+    for (int attempt = 0; attempt < 100 && fd < 0; ++attempt) {
+        snprintf(name, sizeof(name), "/segment-%013ld-%04lu.arc", HistoryStore::wallClockMs(), segmentCount++);
+        fd = open((options.directory + name).c_str(), O_WRONLY | O_CREAT | O_EXCL | O_APPEND, 0640);
+        if (fd < 0 && errno != EEXIST)
+            break;
+    }
+    if (fd < 0) {
+        LOG_ERROR("❌ Archive : ouverture de segment impossible dans " << options.directory
+                  << " : " << std::strerror(errno));
+        return false;
+    }
+    segmentFd = fd;
+    segmentSize = 0;
+    if (writeAll(ARCHIVE_MAGIC, ARCHIVE_MAGIC_SIZE))
+        segmentSize = ARCHIVE_MAGIC_SIZE;
+    LOG_INFO("🗄️  Archive : nouveau segment " << options.directory << name);
+    return true;
+}
+
+void Archive::closeSegment() {
+    if (segmentFd < 0)
+        return;
+    sync();
+    close(segmentFd);
+    segmentFd = -1;
+    segmentSize = 0;
+}
+
+/**
+ * @brief Group commit : un fdatasync pour tout ce qui a été écrit depuis
+ * le précédent.
+ */
+void Archive::sync() {
+    if (segmentFd >= 0 && unsyncedBytes > 0 && fdatasync(segmentFd) < 0)
+        LOG_ERROR("❌ Archive : fdatasync : " << std::strerror(errno));
+    unsyncedBytes = 0;
+    lastSync = TimerWheel::monotonicMs();
+}
+
+bool Archive::writeAll(const char* data, size_t length) {
+    while (length > 0) {
+        ssize_t written = write(segmentFd, data, length);
+        if (written < 0) {
+            if (errno == EINTR)
+                continue;
+            LOG_ERROR("❌ Archive : écriture : " << std::strerror(errno));
+            return false;
+        }
+        data += written;
+        length -= static_cast<size_t>(written);
+    }
+    return true;
+}
@@ -0,0 +1,165 @@
+/* ************************************************************************** */
+/*                                                                            */
+/*                                                        :::      ::::::::   */
+/*   ArchiveFormat.cpp                                  :+:      :+:    :+:   */
+/*                                                    +:+ +:+         +:+     */
+/*   By: kpourcel <marvin@42.fr>                    +#+  +:+       +#+        */
+/*                                                +#+#+#+#+#+   +#+           */
+/*   Created: 2025/04/18 09:41:27 by kpourcel          #+#    #+#             */
+/*   Updated: 2025/04/18 09:41:27 by kpourcel         ###   ########.fr       */
+/*                                                                            */
+/* ************************************************************************** */
+
+#include "../include/ArchiveFormat.hpp"
+
+/* -------------------------------------------------------------------------- */
+/*                                  Encodage                                  */
+/* -------------------------------------------------------------------------- */
+
+void ArchiveFormat::putInt(std::string& out, unsigned long value, size_t bytes) {
+    for (size_t i = 0; i < bytes; ++i)
+        out += static_cast<char>((value >> (8 * i)) & 0xff);
+}
+
+void ArchiveFormat::putField(std::string& out, const std::string& field) {
+    size_t length = field.size() < ARCHIVE_FIELD_MAX ? field.size() : ARCHIVE_FIELD_MAX;
+    putInt(out, length, 2);
+    out.append(field, 0, length);
+}
+
+/**
+ * @brief Ajoute un enregistrement à un lot, CRC laissé à zéro.
+ *
+ * Le CRC est calculé par le thread d'écriture (seal) : le thread principal
+ * ne fait que copier les octets.
+ */
+void ArchiveFormat::append(std::string& out, unsigned long sequence, long time, int type,
+                           const std::string& channel, const std::string& nick, const std::string& text) {
+    size_t start = out.size();
+    putInt(out, 0, 4);
+    putInt(out, 0, 4);
+    putInt(out, sequence, 8);
+    putInt(out, static_cast<unsigned long>(time), 8);
+    putInt(out, static_cast<unsigned long>(type), 1);
+    putField(out, channel);
+    putField(out, nick);
+    putField(out, text);
+
+    size_t length = out.size() - start - ARCHIVE_HEADER_SIZE;
+    for (size_t i = 0; i < 4; ++i)
+        out[start + i] = static_cast<char>((length >> (8 * i)) & 0xff);
+}
+
+/**
+ * @brief Calcule le CRC de chaque enregistrement d'un lot.
+ *
+ * @return Nombre d'enregistrements scellés.
+ */
+size_t ArchiveFormat::seal(char* data, size_t size) {
+    size_t offset = 0;
+    size_t count = 0;
+    while (offset + ARCHIVE_HEADER_SIZE <= size) {
+        size_t length = readU32(data + offset);
+        unsigned int crc = crc32(data + offset + ARCHIVE_HEADER_SIZE, length);
+        for (size_t i = 0; i < 4; ++i)
+            data[offset + 4 + i] = static_cast<char>((crc >> (8 * i)) & 0xff);
+        offset += ARCHIVE_HEADER_SIZE + length;
+        ++count;
+    }
+    return count;
+}
+
+/* -------------------------------------------------------------------------- */
+/*                                  Décodage                                  */
+/* -------------------------------------------------------------------------- */
+
+unsigned int ArchiveFormat::readU32(const char* data) {
+    const unsigned char* bytes = reinterpret_cast<const unsigned char*>(data);
+    return bytes[0] | (bytes[1] << 8) | (bytes[2] << 16) | (static_cast<unsigned int>(bytes[3]) << 24);
+}
+
+unsigned long ArchiveFormat::readInt(const char* data, size_t bytes) {
+    const unsigned char* raw = reinterpret_cast<const unsigned char*>(data);
+    unsigned long value = 0;
+    for (size_t i = 0; i < bytes; ++i)
+        value |= static_cast<unsigned long>(raw[i]) << (8 * i);
+    return value;
+}
+
+bool ArchiveFormat::readField(const char* data, size_t length, size_t& offset, std::string& field) {
+    if (offset + 2 > length)
+        return false;
+    size_t size = readInt(data + offset, 2);
+    offset += 2;
+    if (offset + size > length)
+        return false;
+    field.assign(data + offset, size);
+    offset += size;
+    return true;
+}
+
+/**
+ * @brief Décode le contenu d'un enregistrement (CRC déjà vérifié).
+ */
+bool ArchiveFormat::decode(const char* payload, size_t length, ArchiveRecord& record) {
+    if (length < 17)
+        return false;
+    record.sequence = readInt(payload, 8);
+    record.time = static_cast<long>(readInt(payload + 8, 8));
+    record.type = static_cast<int>(readInt(payload + 16, 1));
+    size_t offset = 17;
+    return readField(payload, length, offset, record.channel)
+        && readField(payload, length, offset, record.nick)
+        && readField(payload, length, offset, record.text)
+        && offset == length;
+}
+
+/**
+ * @brief CRC32 IEEE 802.3 (polynôme réfléchi 0xEDB88320), par tables
+ * (slicing-by-8 : huit octets par tour au lieu d'un).
+ *
+ * Les tables sont construites au premier appel, qui doit précéder le
+ * lancement des threads d'écriture (Archive::start et Snapshot::start
+ * s'en chargent).
+ */
+unsigned int ArchiveFormat::crc32(const char* data, size_t length) {
+    static unsigned int table[8][256];
+    static bool ready = false;
+    if (!ready) {
+        for (unsigned int i = 0; i < 256; ++i) {
+            unsigned int crc = i;
+            for (int bit = 0; bit < 8; ++bit)
+                crc = (crc & 1) ? (crc >> 1) ^ 0xEDB88320u : crc >> 1;
+            table[0][i] = crc;
+        }
+        for (unsigned int i = 0; i < 256; ++i) {
+            for (int slice = 1; slice < 8; ++slice)
+                table[slice][i] = (table[slice - 1][i] >> 8) ^ table[0][table[slice - 1][i] & 0xff];
+        }
+        ready = true;
+    }
+
+    const unsigned char* bytes = reinterpret_cast<const unsigned char*>(data);
+    unsigned int crc = 0xFFFFFFFFu;
+    for (; length >= 8; length -= 8, bytes += 8) {
+        unsigned int low = crc ^ readU32(reinterpret_cast<const char*>(bytes));
+        unsigned int high = readU32(reinterpret_cast<const char*>(bytes + 4));
+        crc = table[7][low & 0xff] ^ table[6][(low >> 8) & 0xff]
+            ^ table[5][(low >> 16) & 0xff] ^ table[4][low >> 24]
+            ^ table[3][high & 0xff] ^ table[2][(high >> 8) & 0xff]
+            ^ table[1][(high >> 16) & 0xff] ^ table[0][high >> 24];
+    }
+    for (; length > 0; --length, ++bytes)
+        crc = table[0][(crc ^ *bytes) & 0xff] ^ (crc >> 8);
+    return crc ^ 0xFFFFFFFFu;
+}
+
+const char* ArchiveFormat::typeName(int type) {
+    switch (type) {
+        case ARCHIVE_PRIVMSG:   return "PRIVMSG";
+        case ARCHIVE_JOIN:      return "JOIN";
+        case ARCHIVE_PART:      return "PART";
+        case ARCHIVE_KICK:      return "KICK";
+        default:                return "UNKNOWN";
+    }
+}
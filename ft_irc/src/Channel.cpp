@@ -11,53 +11,69 @@
 /* ************************************************************************** */
 
 #include "../include/Channel.hpp"
-#include <sys/socket.h>
+#include "../include/Client.hpp"
+#include "../include/NickIndex.hpp"
 #include <iostream>
 
 Channel::Channel(const std::string& channelName)
-    : name(channelName), userLimit(0), inviteOnly(false), topicRestricted(false) {}
+    : name(channelName), userLimit(0), inviteOnly(false), topicRestricted(false),
+      snapshotDirty(false) {}
 
-void Channel::addClient(int clientSocket) {
-    clients.insert(clientSocket);
+const std::string& Channel::getName() const {
+    return name;
+}
+
+/**
+ * Gestion des membres
+ * Chaque ajout/retrait est reflété dans Client::getChannels() pour que
+ * QUIT et la déconnexion ne parcourent que les channels du client.
+ */
+void Channel::addClient(Client* client) {
+    clients.insert(client->getSocketFd(), client);
+    client->addChannel(this);
 }
 
 void Channel::removeClient(int clientSocket) {
+    ChannelMember* member = clients.find(clientSocket);
+    if (!member)
+        return;
+    member->client->removeChannel(this);
     clients.erase(clientSocket);
 }
 
 bool Channel::isClientInChannel(int clientSocket) const {
-    return clients.find(clientSocket) != clients.end();
-}
-
-void Channel::broadcast(const std::string& message, int excludeSocket) {
-    for (std::set<int>::iterator it = clients.begin(); it != clients.end(); ++it) {
-        if (*it != excludeSocket) {
-            send(*it, message.c_str(), message.length(), 0);
-        }
-    }
+    return clients.find(clientSocket) != NULL;
 }
 
 bool Channel::isEmpty() const {
     return clients.empty();
 }
 
-const std::set<int>& Channel::getClients() const {
+const MemberList& Channel::getClients() const {
     return clients;
 }
 
 /**
  * Gestion des opérateurs
+ * Le statut est un bit de l'entrée du membre : il disparaît avec elle.
  */
 void Channel::addOperator(int clientSocket) {
-    operators.insert(clientSocket);
+    setMemberMode(clientSocket, MEMBER_OP, true);
 }
 
 void Channel::removeOperator(int clientSocket) {
-    operators.erase(clientSocket);
+    setMemberMode(clientSocket, MEMBER_OP, false);
 }
 
 bool Channel::isOperator(int clientSocket) const {
-    return operators.find(clientSocket) != operators.end();
+    const ChannelMember* member = clients.find(clientSocket);
+    return member && (member->modes & MEMBER_OP);
+}
+
+void Channel::setMemberMode(int clientSocket, unsigned int mode, bool enabled) {
+    ChannelMember* member = clients.find(clientSocket);
+    if (member)
+        clients.setMode(*member, mode, enabled);
 }
 
 /**
@@ -117,3 +133,99 @@ void Channel::removeInvitation(int clientSocket) {
     invitedClients.erase(clientSocket);
 }
 
+const std::set<int>& Channel::getInvitations() const {
+    return invitedClients;
+}
+
+/**
+ * Opérateurs restaurés
+ * Un instantané ne connaît que les pseudos : l'opérateur retrouve son statut
+ * en rejoignant le channel sous le même pseudo (casemapping RFC 1459).
+ */
+void Channel::setSavedOperators(const std::vector<std::string>& nicknames) {
+    savedOperators = nicknames;
+}
+
+bool Channel::isSavedOperator(const std::string& nickname) const {
+    for (size_t i = 0; i < savedOperators.size(); ++i) {
+        if (NickIndex::equals(savedOperators[i], nickname))
+            return true;
+    }
+    return false;
+}
+
+bool Channel::removeSavedOperator(const std::string& nickname) {
+    for (size_t i = 0; i < savedOperators.size(); ++i) {
+        if (NickIndex::equals(savedOperators[i], nickname)) {
+            savedOperators.erase(savedOperators.begin() + i);
+            return true;
+        }
+    }
+    return false;
+}
+
+bool Channel::hasSavedOperators() const {
+    return !savedOperators.empty();
+}
+
+const std::vector<std::string>& Channel::getSavedOperators() const {
+    return savedOperators;
+}
+
+bool Channel::isSnapshotDirty() const {
+    return snapshotDirty;
+}
+
+void Channel::setSnapshotDirty(bool dirty) {
+    snapshotDirty = dirty;
+}
+
+/**
+ * Membres par réacteur
+ */
+void Channel::addReactorMember(int reactorId) {
+    if (reactorMembers.size() <= static_cast<size_t>(reactorId))
+        reactorMembers.resize(reactorId + 1, 0);
+    ++reactorMembers[reactorId];
+}
+
+void Channel::removeReactorMember(int reactorId) {
+    if (static_cast<size_t>(reactorId) < reactorMembers.size() && reactorMembers[reactorId] > 0)
+        --reactorMembers[reactorId];
+}
+
+const std::vector<unsigned int>& Channel::getReactorMembers() const {
+    return reactorMembers;
+}
+
+ChannelHistory& Channel::getHistory() {
+    return history;
+}
+
+/**
+ * Pool de channels
+ * Les objets de la même taille que Channel viennent du pool ; toute autre
+ * taille (classe dérivée) retombe sur l'allocateur général.
+ */
+static ObjectPool<Channel>& channelPool() {
+    static ObjectPool<Channel> pool;
+    return pool;
+}
+
+void* Channel::operator new(size_t size) {
+    if (size != sizeof(Channel))
+        return ::operator new(size);
+    return channelPool().allocate();
+}
+
+void Channel::operator delete(void* ptr, size_t size) {
+    if (size != sizeof(Channel)) {
+        ::operator delete(ptr);
+        return;
+    }
+    channelPool().release(ptr);
+}
+
+const PoolStats& Channel::getPoolStats() {
+    return channelPool().getStats();
+}
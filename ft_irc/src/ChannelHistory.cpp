@@ -0,0 +1,268 @@
+/* ************************************************************************** */
+/*                                                                            */
+/*                                                        :::      ::::::::   */
+/*   ChannelHistory.cpp                                 :+:      :+:    :+:   */
+/*                                                    +:+ +:+         +:+     */
+/*   By: kpourcel <marvin@42.fr>                    +#+  +:+       +#+        */
+/*                                                +#+#+#+#+#+   +#+           */
+/*   Created: 2025/04/17 14:36:09 by kpourcel          #+#    #+#             */
+/*   Updated: 2025/04/17 14:36:09 by kpourcel         ###   ########.fr       */
+/*                                                                            */
+/* ************************************************************************** */
+
+#include "../include/ChannelHistory.hpp"
+#include "../include/RecvBuffer.hpp"
+
+#include <cstdio>
+#include <cstring>
+#include <ctime>
+#include <sys/time.h>
+
+/* -------------------------------------------------------------------------- */
+/*                                 HistoryLink                                */
+/* -------------------------------------------------------------------------- */
+
+HistoryLink::HistoryLink() : prev(this), next(this) {}
+
+void HistoryLink::unlink() {
+    prev->next = next;
+    next->prev = prev;
+    prev = this;
+    next = this;
+}
+
+bool HistoryLink::linked() const {
+    return next != this;
+}
+
+/* -------------------------------------------------------------------------- */
+/*                               ChannelHistory                               */
+/* -------------------------------------------------------------------------- */
+
+ChannelHistory::ChannelHistory() : store(NULL), head(0), count(0), writePos(0) {}
+
+ChannelHistory::~ChannelHistory() {
+    if (store)
+        store->release(*this);
+}
+
+size_t ChannelHistory::size() const {
+    return count;
+}
+
+/**
+ * @brief Entrée d'indice logique `index` (0 = la plus ancienne).
+ */
+const HistoryEntry& ChannelHistory::at(size_t index) const {
+    return entries[(head + index) % entries.size()];
+}
+
+std::string ChannelHistory::line(const HistoryEntry& entry) const {
+    return std::string(&arena[entry.offset], entry.length);
+}
+
+void ChannelHistory::dropOldest() {
+    head = (head + 1) % entries.size();
+    --count;
+    if (count == 0) {
+        head = 0;
+        writePos = 0;
+    }
+}
+
+/**
+ * @brief Premier indice dont le msgid est >= msgid (size() si aucun).
+ */
+size_t ChannelHistory::lowerBoundId(unsigned long msgid) const {
+    size_t low = 0;
+    size_t high = count;
+    while (low < high) {
+        size_t mid = low + (high - low) / 2;
+        if (at(mid).msgid < msgid)
+            low = mid + 1;
+        else
+            high = mid;
+    }
+    return low;
+}
+
+/**
+ * @brief Premier indice dont l'heure est >= time (size() si aucun).
+ */
+size_t ChannelHistory::lowerBoundTime(long time) const {
+    size_t low = 0;
+    size_t high = count;
+    while (low < high) {
+        size_t mid = low + (high - low) / 2;
+        if (at(mid).time < time)
+            low = mid + 1;
+        else
+            high = mid;
+    }
+    return low;
+}
+
+/* -------------------------------------------------------------------------- */
+/*                                HistoryStore                                */
+/* -------------------------------------------------------------------------- */
+
+HistoryStore::HistoryStore(size_t linesPerChannel, size_t budget)
+    : linesPerChannel(linesPerChannel), budget(budget), used(0), evictions(0), lastMsgid(0) {}
+
+/**
+ * @brief Mémoire réservée par un historique actif.
+ */
+size_t HistoryStore::channelCost() const {
+    size_t bytes = linesPerChannel * HISTORY_BYTES_PER_LINE;
+    if (bytes < IRC_LINE_MAX)
+        bytes = IRC_LINE_MAX;
+    return bytes + linesPerChannel * sizeof(HistoryEntry);
+}
+
+bool HistoryStore::enabled() const {
+    return linesPerChannel > 0 && budget >= channelCost();
+}
+
+size_t HistoryStore::maxLines() const {
+    return linesPerChannel;
+}
+
+/**
+ * @brief Ajoute une ligne (sans CRLF) à l'historique d'un channel.
+ *
+ * Au premier message, l'arène est réservée en libérant au besoin les
+ * historiques les plus froids. Dans l'arène, la ligne est écrite à la suite
+ * de la précédente (ou au début si elle ne tient pas avant la fin) ; les
+ * entrées les plus anciennes qui occupaient cette place sont retirées.
+ *
+ * @param msgid Identifiant à reprendre (mise à jour à chaud) ; 0 pour le
+ *              suivant.
+ * @return L'entrée créée, ou NULL si l'historique est désactivé.
+ */
+const HistoryEntry* HistoryStore::append(ChannelHistory& history, const std::string& line, long time,
+                                         unsigned long msgid) {
+    if (!enabled() || line.empty())
+        return NULL;
+
+    if (!history.store) {
+        while (used + channelCost() > budget && lru.prev != &lru) {
+            release(*static_cast<ChannelHistory*>(lru.prev));
+            ++evictions;
+        }
+        size_t cost = channelCost();
+        history.arena.resize(cost - linesPerChannel * sizeof(HistoryEntry));
+        history.entries.resize(linesPerChannel);
+        history.store = this;
+        used += cost;
+    }
+    touch(history);
+
+    size_t arenaSize = history.arena.size();
+    size_t length = line.size() < arenaSize ? line.size() : arenaSize;
+    unsigned int pos = history.writePos;
+    if (pos + length > arenaSize)
+        pos = 0;
+    size_t span = (pos == history.writePos) ? length : (arenaSize - history.writePos) + length;
+    while (history.count > 0) {
+        const HistoryEntry& oldest = history.at(0);
+        size_t distance = (oldest.offset + arenaSize - history.writePos) % arenaSize;
+        if (history.count < history.entries.size() && distance >= span)
+            break;
+        history.dropOldest();
+        if (history.count == 0) {
+            pos = 0;
+            break;
+        }
+    }
+
+    HistoryEntry& entry = history.entries[(history.head + history.count) % history.entries.size()];
+    if (msgid > lastMsgid)
+        lastMsgid = msgid;
+    entry.msgid = msgid ? msgid : ++lastMsgid;
+    entry.time = (history.count > 0 && history.at(history.count - 1).time > time)
+                 ? history.at(history.count - 1).time : time;
+    entry.offset = pos;
+    entry.length = static_cast<unsigned int>(length);
+    line.copy(&history.arena[pos], length);
+    ++history.count;
+    history.writePos = static_cast<unsigned int>((pos + length) % arenaSize);
+    return &entry;
+}
+
+/**
+ * @brief Place l'historique en tête de la liste LRU.
+ */
+void HistoryStore::touch(ChannelHistory& history) {
+    if (!history.store)
+        return;
+    history.unlink();
+    history.next = lru.next;
+    history.prev = &lru;
+    lru.next->prev = &history;
+    lru.next = &history;
+}
+
+/**
+ * @brief Libère la mémoire d'un historique (channel supprimé ou évincé).
+ */
+void HistoryStore::release(ChannelHistory& history) {
+    if (!history.store)
+        return;
+    history.unlink();
+    used -= channelCost();
+    std::vector<char>().swap(history.arena);
+    std::vector<HistoryEntry>().swap(history.entries);
+    history.store = NULL;
+    history.head = 0;
+    history.count = 0;
+    history.writePos = 0;
+}
+
+size_t HistoryStore::memoryUsed() const {
+    return used;
+}
+
+size_t HistoryStore::evicted() const {
+    return evictions;
+}
+
+long HistoryStore::wallClockMs() {
+    struct timeval now;
+    gettimeofday(&now, NULL);
+    return now.tv_sec * 1000L + now.tv_usec / 1000;
+}
+
+std::string HistoryStore::formatTime(long time) {
+    time_t seconds = static_cast<time_t>(time / 1000);
+    struct tm utc;
+    gmtime_r(&seconds, &utc);
+    char out[32];
+    size_t used = strftime(out, sizeof(out), "%Y-%m-%dT%H:%M:%S", &utc);
+    snprintf(out + used, sizeof(out) - used, ".%03ldZ", time % 1000);
+    return out;
+}
+
+/**
+ * @brief Lit une heure server-time (millisecondes facultatives).
+ */
+bool HistoryStore::parseTime(const std::string& text, long& time) {
+    struct tm utc;
+    int millis = 0;
+    char zone = 0;
+    std::memset(&utc, 0, sizeof(utc));
+    int fields = sscanf(text.c_str(), "%4d-%2d-%2dT%2d:%2d:%2d.%3d%c", &utc.tm_year, &utc.tm_mon,
+                        &utc.tm_mday, &utc.tm_hour, &utc.tm_min, &utc.tm_sec, &millis, &zone);
+    if (fields < 6)
+        return false;
+    if (fields == 6 && sscanf(text.c_str(), "%*d-%*d-%*dT%*d:%*d:%*d%c", &zone) != 1)
+        zone = 0;
+    if (zone != 'Z' || millis < 0)
+        return false;
+    utc.tm_year -= 1900;
+    utc.tm_mon -= 1;
+    time_t seconds = timegm(&utc);
+    if (seconds == static_cast<time_t>(-1))
+        return false;
+    time = static_cast<long>(seconds) * 1000L + millis;
+    return true;
+}
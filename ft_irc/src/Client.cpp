@@ -11,16 +11,22 @@
 /* ************************************************************************** */
 
 #include "../include/Client.hpp"
+#include "../include/Logger.hpp"
 
 /**
  * Constructeur & destructeurs
  */
-Client::Client(int fd) : socketFd(fd), authenticated(false), buffer("") {
-    std::cout << "👤 Création d'un nouveau client (fd: " << fd << ")" << std::endl;
+Client::Client(int fd)
+    : socketFd(fd), authenticated(false), reactor(NULL), connection(NULL),
+      stagedBatch(NULL), stagedEpoch(0), closing(false),
+      serverOperator(false), pingTimer(fd, CLIENT_TIMER_PING),
+      registrationTimer(fd, CLIENT_TIMER_REGISTRATION), lastActivity(0), pingSentAt(0),
+      floodTimer(fd, CLIENT_TIMER_FLOOD), writeArmed(false), visitMark(0) {
+    LOG_DEBUG("👤 Création d'un nouveau client (fd: " << fd << ")");
 }
 
 Client::~Client() {
-    std::cout << "👋 Déconnexion du client (fd: " << socketFd << ")" << std::endl;
+    LOG_DEBUG("👋 Déconnexion du client (fd: " << socketFd << ")");
 }
 
 /**
@@ -30,7 +36,7 @@ int Client::getSocketFd() const {
     return socketFd;
 }
 
-std::string Client::getNickname() const {
+const std::string& Client::getNickname() const {
     return nickname;
 }
 
@@ -38,6 +44,10 @@ std::string Client::getUsername() const {
     return username;
 }
 
+std::string Client::getRealname() const {
+    return realname;
+}
+
 
 void Client::setNickname(const std::string& nick) {
     nickname = nick;
@@ -60,49 +70,175 @@ bool Client::isAuthenticated() const {
 
 void Client::authenticate() {
     authenticated = true;
-    std::cout << "✅ Client (fd: " << socketFd << ") authentifié !" << std::endl;
-    std::cout << std::endl;
+    LOG_INFO("✅ Client (fd: " << socketFd << ") authentifié !");
 }
 
 bool Client::isFullyRegistered() const {
     return !nickname.empty() && !username.empty() && !realname.empty() && isAuthenticated();
 }
 
-void Client::setCurrentChannel(const std::string& channel) {
-    currentChannel = channel;
+/**
+ * Channels rejoints
+ */
+void Client::addChannel(Channel* channel) {
+    channels.insert(channel);
+}
+
+void Client::removeChannel(Channel* channel) {
+    channels.erase(channel);
+}
+
+const std::set<Channel*>& Client::getChannels() const {
+    return channels;
 }
 
 /**
  * Gestion des autorisation et messages incomplet
  */
-std::string Client::getCurrentChannel() const {
-    return currentChannel;
+
+RecvBuffer& Client::getRecvBuffer() {
+    return recvBuffer;
 }
 
+/**
+ * Gestion de la file d'envoi
+ */
 
-std::string& Client::getBufferRef() {
-    return this->buffer;
+SendQueue& Client::getSendQueue() {
+    return sendQueue;
 }
 
-void Client::appendToBuffer(const char* receiveBuffer, size_t length) {
-    this->buffer.append(receiveBuffer, length);
+/**
+ * Réacteur propriétaire du socket
+ */
+void Client::attachReactor(Reactor* owner, ReactorConnection* conn) {
+    reactor = owner;
+    connection = conn;
 }
 
-std::string Client::extractNextMessage() {
-    size_t pos = this->buffer.find("\r\n");
-    bool foundCRLF = true;
-    if (pos == std::string::npos) {
-        pos = this->buffer.find("\n");
-        foundCRLF = false;
-    }
-    if (pos == std::string::npos) {
-        return "";
-    }
-    std::string message = this->buffer.substr(0, pos);
-    if (foundCRLF) {
-        this->buffer.erase(0, pos + 2);
-    } else {
-        this->buffer.erase(0, pos + 1);
+SendQueue* Client::getStagedBatch(unsigned long epoch) const {
+    return (stagedEpoch == epoch) ? stagedBatch : NULL;
+}
+
+void Client::setStagedBatch(SendQueue* batch, unsigned long epoch) {
+    stagedBatch = batch;
+    stagedEpoch = epoch;
+}
+
+void Client::setWriteArmed(bool armed) {
+    writeArmed = armed;
+}
+
+bool Client::isWriteArmed() const {
+    return writeArmed;
+}
+
+Reactor* Client::getReactor() const {
+    return reactor;
+}
+
+ReactorConnection* Client::getConnection() const {
+    return connection;
+}
+
+void Client::markClosing(const std::string& reason) {
+    if (closing)
+        return;
+    closing = true;
+    closeReason = reason;
+}
+
+bool Client::isClosing() const {
+    return closing;
+}
+
+std::string Client::getCloseReason() const {
+    return closeReason;
+}
+
+void Client::setServerOperator(bool enabled) {
+    serverOperator = enabled;
+}
+
+bool Client::isServerOperator() const {
+    return serverOperator;
+}
+
+/**
+ * @brief Note une activité du client : le timer de PING n'est pas réarmé
+ * ici, il relit cette heure quand il expire (une simple écriture par ligne).
+ */
+void Client::touch(long now) {
+    lastActivity = now;
+}
+
+long Client::getLastActivity() const {
+    return lastActivity;
+}
+
+void Client::setPingSentAt(long when) {
+    pingSentAt = when;
+}
+
+long Client::getPingSentAt() const {
+    return pingSentAt;
+}
+
+Timer& Client::getPingTimer() {
+    return pingTimer;
+}
+
+Timer& Client::getRegistrationTimer() {
+    return registrationTimer;
+}
+
+TokenBucket& Client::getFloodBucket() {
+    return floodBucket;
+}
+
+Timer& Client::getFloodTimer() {
+    return floodTimer;
+}
+
+std::deque<MessageBuffer>& Client::getPendingLines() {
+    return pendingLines;
+}
+
+InputBudget& Client::getInputBudget() {
+    return inputBudget;
+}
+
+bool Client::visit(unsigned long epoch) {
+    if (visitMark == epoch)
+        return false;
+    visitMark = epoch;
+    return true;
+}
+
+/**
+ * Pool de clients
+ * Les objets de la même taille que Client viennent du pool ; toute autre
+ * taille (classe dérivée) retombe sur l'allocateur général.
+ */
+static ObjectPool<Client>& clientPool() {
+    static ObjectPool<Client> pool;
+    return pool;
+}
+
+void* Client::operator new(size_t size) {
+    if (size != sizeof(Client))
+        return ::operator new(size);
+    return clientPool().allocate();
+}
+
+void Client::operator delete(void* ptr, size_t size) {
+    if (size != sizeof(Client)) {
+        ::operator delete(ptr);
+        return;
     }
-    return message;
-}
\ No newline at end of file
+    clientPool().release(ptr);
+}
+
+const PoolStats& Client::getPoolStats() {
+    return clientPool().getStats();
+}
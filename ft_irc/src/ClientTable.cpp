@@ -0,0 +1,68 @@
+/* ************************************************************************** */
+/*                                                                            */
+/*                                                        :::      ::::::::   */
+/*   ClientTable.cpp                                    :+:      :+:    :+:   */
+/*                                                    +:+ +:+         +:+     */
+/*   By: kpourcel <marvin@42.fr>                    +#+  +:+       +#+        */
+/*                                                +#+#+#+#+#+   +#+           */
+/*   Created: 2025/04/12 10:31:08 by kpourcel          #+#    #+#             */
+/*   Updated: 2025/04/12 10:31:08 by kpourcel         ###   ########.fr       */
+/*                                                                            */
+/* ************************************************************************** */
+
+#include "../include/ClientTable.hpp"
+
+ClientTable::ClientTable() : count(0) {}
+
+/**
+ * @return Le client du descripteur, ou NULL s'il n'y en a pas.
+ */
+Client* ClientTable::find(int fd) const {
+    if (fd < 0 || static_cast<size_t>(fd) >= slots.size())
+        return NULL;
+    return slots[fd];
+}
+
+Client* ClientTable::operator[](int fd) const {
+    return find(fd);
+}
+
+/**
+ * @brief Enregistre un client ; la table grandit (par doublement) si besoin.
+ */
+void ClientTable::insert(int fd, Client* client) {
+    if (fd < 0)
+        return;
+    if (static_cast<size_t>(fd) >= slots.size()) {
+        size_t newSize = slots.empty() ? 64 : slots.size();
+        while (newSize <= static_cast<size_t>(fd))
+            newSize *= 2;
+        slots.resize(newSize, NULL);
+    }
+    if (!slots[fd])
+        ++count;
+    slots[fd] = client;
+}
+
+void ClientTable::erase(int fd) {
+    if (fd < 0 || static_cast<size_t>(fd) >= slots.size() || !slots[fd])
+        return;
+    slots[fd] = NULL;
+    --count;
+}
+
+void ClientTable::clear() {
+    slots.clear();
+    count = 0;
+}
+
+size_t ClientTable::size() const {
+    return count;
+}
+
+/**
+ * @brief Borne (exclue) des descripteurs à parcourir pour itérer sur la table.
+ */
+int ClientTable::limit() const {
+    return static_cast<int>(slots.size());
+}
@@ -12,198 +12,267 @@
 
 #include "../include/CommandHandler.hpp"
 #include "../include/Server.hpp"
+#include "../include/Metrics.hpp"
+#include <cctype>
+
+/**
+ * @brief Table de dispatch, triée par nom pour la recherche dichotomique.
+ *
+ * Ajouter une commande = ajouter une ligne ici (en respectant l'ordre).
+ * Champs : nom, handler, paramètres minimum, enregistrement requis, coût.
+ */
+const CommandEntry CommandHandler::commandTable[] = {
+    { "CAP",         &CommandHandler::handleCapCmd,         0, REG_NONE, 1 },
+    { "CHATHISTORY", &CommandHandler::handleChatHistoryCmd, 4, REG_FULL, 3 },
+    { "INVITE",      &CommandHandler::handleInviteCmd,      2, REG_FULL, 1 },
+    { "JOIN",        &CommandHandler::handleJoinCmd,        1, REG_FULL, 2 },
+    { "KICK",        &CommandHandler::handleKickCmd,        2, REG_FULL, 1 },
+    { "LIST",        &CommandHandler::handleListCmd,        0, REG_FULL, 2 },
+    { "MODE",        &CommandHandler::handleModeCmd,        1, REG_FULL, 1 },
+    { "NAMES",       &CommandHandler::handleNamesCmd,       0, REG_FULL, 2 },
+    { "NICK",        &CommandHandler::handleNickCmd,        0, REG_PASS, 2 },
+    { "OPER",        &CommandHandler::handleOperCmd,        2, REG_FULL, 2 },
+    { "PART",        &CommandHandler::handlePartCmd,        1, REG_FULL, 2 },
+    { "PASS",        &CommandHandler::handlePassCmd,        1, REG_NONE, 1 },
+    { "PING",        &CommandHandler::handlePingCmd,        0, REG_NONE, 1 },
+    { "PONG",        &CommandHandler::handlePongCmd,        0, REG_NONE, 0 },
+    { "PRIVMSG",     &CommandHandler::handlePrivMsgCmd,     2, REG_FULL, 1 },
+    { "QUIT",        &CommandHandler::handleQuitCmd,        0, REG_NONE, 0 },
+    { "STATS",       &CommandHandler::handleStatsCmd,       0, REG_FULL, 2 },
+    { "TOPIC",       &CommandHandler::handleTopicCmd,       1, REG_FULL, 1 },
+    { "UPGRADE",     &CommandHandler::handleUpgradeCmd,     0, REG_FULL, 2 },
+    { "USER",        &CommandHandler::handleUserCmd,        4, REG_PASS, 1 },
+    { "WHOIS",       &CommandHandler::handleWhoisCmd,       1, REG_FULL, 2 }
+};
+
+const size_t CommandHandler::commandCount = sizeof(commandTable) / sizeof(commandTable[0]);
 
 /**
  * @brief Constructeur du gestionnaire de commandes.
  *
  * @param srv Référence vers le serveur IRC.
  */
-CommandHandler::CommandHandler(Server &srv) : server(srv) {}
+CommandHandler::CommandHandler(Server &srv) : server(srv) {
+    for (size_t i = 0; i < commandCount; ++i)
+        Metrics::registerVerb(i, commandTable[i].name);
+    Metrics::registerVerb(commandCount, "UNKNOWN");
+}
+
+/**
+ * @brief Cherche une commande dans la table (insensible à la casse).
+ *
+ * Le verbe est mis en majuscules dans un tampon fixe puis recherché par
+ * dichotomie : au plus log2(commandCount) comparaisons, sans allocation.
+ *
+ * @return L'entrée trouvée, ou NULL si la commande est inconnue.
+ */
+const CommandEntry* CommandHandler::findCommand(const StringView& verb) {
+    char name[COMMAND_NAME_MAX];
+    if (verb.length == 0 || verb.length >= COMMAND_NAME_MAX)
+        return NULL;
+    for (size_t i = 0; i < verb.length; ++i)
+        name[i] = std::toupper(static_cast<unsigned char>(verb.data[i]));
+    name[verb.length] = '\0';
+
+    size_t low = 0;
+    size_t high = commandCount;
+    while (low < high) {
+        size_t mid = (low + high) / 2;
+        int cmp = std::strcmp(name, commandTable[mid].name);
+        if (cmp == 0)
+            return &commandTable[mid];
+        if (cmp < 0)
+            high = mid;
+        else
+            low = mid + 1;
+    }
+    return NULL;
+}
+
+ParsedLine::ParsedLine() : entry(NULL), valid(false) {}
+
+/**
+ * @brief Coût de la ligne pour le contrôle de flood : celui de sa commande
+ * dans la table, 1 pour une commande inconnue, 0 pour une ligne vide.
+ */
+unsigned int ParsedLine::cost() const {
+    if (!valid)
+        return 0;
+    return entry ? entry->cost : 1;
+}
+
+/**
+ * @brief Découpe une ligne reçue (sans CRLF) et cherche sa commande.
+ *
+ * Un '/' initial (saisie façon client IRC) est ignoré. La ligne est
+ * découpée par `MessageParser` sans allocation.
+ */
+void CommandHandler::parseLine(const char* line, size_t length, ParsedLine& parsed) {
+    if (length > 0 && line[0] == '/') {
+        ++line;
+        --length;
+    }
+    parsed.valid = MessageParser::parse(line, length, parsed.message);
+    parsed.entry = parsed.valid ? findCommand(parsed.message.command) : NULL;
+}
 
 /**
  * @brief Gère une commande envoyée par un client.
  *
+ * La ligne a déjà été découpée et sa commande cherchée dans la table de
+ * dispatch (`parseLine`). Le traitement est chronométré et compté par
+ * verbe (les verbes inconnus partagent un compteur commun).
+ *
  * @param clientSocket Descripteur de fichier du client.
- * @param command La commande complète envoyée par le client.
+ * @param parsed La ligne découpée.
  */
-void CommandHandler::handleCommand(int clientSocket, const std::string &command) {
-    std::istringstream iss(command);
-    std::string cmd;
-
-    std::vector<std::string> commands;
-    std::string temp;
-    while (std::getline(iss, temp, '\n')) {
-        if (!temp.empty()) {
-            commands.push_back(temp);
-        }
+void CommandHandler::handleCommand(int clientSocket, const ParsedLine& parsed) {
+    if (!parsed.valid)
+        return;
+
+    const IrcMessage& msg = parsed.message;
+    LOG_DEBUG("📌 CommandHandler : [" << LogBytes(msg.command.data, msg.command.length) << "] reçue du client " << clientSocket);
+
+    const CommandEntry* entry = parsed.entry;
+    long start = Metrics::now();
+    dispatch(clientSocket, msg, entry);
+    Metrics::recordCommand(entry ? static_cast<size_t>(entry - commandTable) : commandCount,
+                           Metrics::now() - start);
+}
+
+/**
+ * @brief Vérifications communes (enregistrement, nombre de paramètres)
+ * faites à partir des métadonnées de l'entrée, puis appel du handler.
+ */
+void CommandHandler::dispatch(int clientSocket, const IrcMessage& msg, const CommandEntry* entry) {
+    Client* client = server.getClients().find(clientSocket);
+    if (!client) {
+        return;
     }
 
-    for (size_t i = 0; i < commands.size(); i++) {
-        std::istringstream singleCommand(commands[i]);
-        singleCommand >> cmd;
-
-        std::cout << "📌 CommandHandler : [" << cmd << "] reçue du client " << clientSocket << std::endl;
-
-        if (cmd == "CAP") {
-            continue;
-        }
-
-        if (server.getClients().find(clientSocket) == server.getClients().end()) {
-            send(clientSocket, ":irc.42server.com 451 * :You must specify a password first\r\n", 58, 0);
-            return;
-        }
-
-        Client* client = server.getClients()[clientSocket];
-
-        if (!client->isFullyRegistered() && cmd != "NICK" && cmd != "USER" && cmd != "PASS") {
-            send(clientSocket, ":irc.42server.com 451 * :You must register with NICK and USER first\r\n", 70, 0);
-            return;
-        }
-
-        if (cmd == "PASS") 
-            handlePassCmd(clientSocket, singleCommand);
-        else if (cmd == "NICK") 
-            handleNickCmd(clientSocket, singleCommand);
-        else if (cmd == "USER")
-            handleUserCmd(clientSocket, singleCommand);
-        else if (cmd == "JOIN")
-            handleJoinCmd(clientSocket, singleCommand);
-        else if (cmd == "QUIT")
-            handleQuitCmd(clientSocket, singleCommand);
-        else if (cmd == "PART")
-            handlePartCmd(clientSocket, singleCommand);
-        else if (cmd == "LIST")
-            handleListCmd(clientSocket);
-        else if (cmd == "PRIVMSG")
-            handlePrivMsgCmd(clientSocket, singleCommand);
-        else if (cmd == "KICK")
-            handleKickCmd(clientSocket, singleCommand);
-        else if (cmd == "INVITE")
-            handleInviteCmd(clientSocket, singleCommand);
-        else if (cmd == "TOPIC")
-            handleTopicCmd(clientSocket, singleCommand);
-        else if (cmd == "MODE")
-            handleModeCmd(clientSocket, singleCommand);
-        else if (cmd == "PING")
-            handlePingCmd(clientSocket, singleCommand);
-        else {
-            std::cout << "❌ Commande inconnue : [" << cmd << "]\n";
-            std::string errorMsg = ":irc.42server.com 421 " + client->getNickname() + " " + cmd + " :Unknown command\r\n";
-            send(clientSocket, errorMsg.c_str(), errorMsg.length(), 0);
-        }
+    if (entry && entry->registration == REG_PASS && !client->isAuthenticated()) {
+        server.sendToClient(clientSocket, ":irc.42server.com 451 * :You must specify a password first\r\n");
+        return;
+    }
+    if ((!entry || entry->registration == REG_FULL) && !client->isFullyRegistered()) {
+        server.sendToClient(clientSocket, ":irc.42server.com 451 * :You must register with NICK and USER first\r\n");
+        return;
     }
-}
 
+    std::string nick = client->getNickname().empty() ? "*" : client->getNickname();
+    if (!entry) {
+        std::string cmd = msg.command.str();
+        LOG_DEBUG("❌ Commande inconnue : [" << cmd << "]");
+        server.sendToClient(clientSocket, ":irc.42server.com 421 " + nick + " " + cmd + " :Unknown command\r\n");
+        return;
+    }
+    if (msg.paramCount < entry->minParams) {
+        server.sendToClient(clientSocket, ":irc.42server.com 461 " + nick + " " + entry->name + " :Not enough parameters\r\n");
+        return;
+    }
 
-void CommandHandler::handlePassCmd(int clientSocket, std::istringstream &iss) {
-    std::string password;
-    iss >> password;
-    server.handlePass(clientSocket, password);
+    (this->*(entry->handler))(clientSocket, msg);
 }
 
-void CommandHandler::handleNickCmd(int clientSocket, std::istringstream &iss) {
-    std::string nickname;
-    iss >> nickname;
-    server.handleNick(clientSocket, nickname);
+
+void CommandHandler::handleCapCmd(int clientSocket, const IrcMessage &msg) {
+    (void)clientSocket;
+    (void)msg;
 }
 
-void CommandHandler::handleUserCmd(int clientSocket, std::istringstream &iss) {
-    std::string username, mode, unused, realname;
-    iss >> username >> mode >> unused;
-    std::getline(iss, realname);
+void CommandHandler::handlePassCmd(int clientSocket, const IrcMessage &msg) {
+    std::string password = msg.paramStr(0);
+    server.handlePass(clientSocket, password);
+}
 
-    realname.erase(0, realname.find_first_not_of(" \t"));
-    if (!realname.empty() && realname[0] == ':') {
-        realname.erase(0, 1);
-    }
-    realname.erase(0, realname.find_first_not_of(" \t"));
+void CommandHandler::handleNickCmd(int clientSocket, const IrcMessage &msg) {
+    server.handleNick(clientSocket, msg.paramStr(0));
+}
 
-    server.handleUser(clientSocket, username, realname);
+void CommandHandler::handleUserCmd(int clientSocket, const IrcMessage &msg) {
+    server.handleUser(clientSocket, msg.paramStr(0), msg.paramStr(3));
 }
 
-void CommandHandler::handleJoinCmd(int clientSocket, std::istringstream &iss) {
-    std::string channel, password;
-    iss >> channel;
-    if (iss >> password) {
-        server.handleJoin(clientSocket, channel, password);
-    } else {
-        server.handleJoin(clientSocket, channel, "");
-    }
+void CommandHandler::handleJoinCmd(int clientSocket, const IrcMessage &msg) {
+    server.handleJoin(clientSocket, msg.paramStr(0), msg.paramStr(1));
 }
 
-void CommandHandler::handleQuitCmd(int clientSocket, std::istringstream &iss) {
-    std::string quitMessage;
-    std::getline(iss, quitMessage);
-    if (!quitMessage.empty() && quitMessage[0] == ':') {
-        quitMessage.erase(0, 1);
-    }
-    server.handleQuit(clientSocket, quitMessage);
+void CommandHandler::handleQuitCmd(int clientSocket, const IrcMessage &msg) {
+    server.handleQuit(clientSocket, msg.paramStr(0));
 }
 
-void CommandHandler::handlePartCmd(int clientSocket, std::istringstream &iss) {
-    std::string channel;
-    iss >> channel;
-    server.handlePart(clientSocket, channel);
+void CommandHandler::handlePartCmd(int clientSocket, const IrcMessage &msg) {
+    server.handlePart(clientSocket, msg.paramStr(0));
 }
 
-void CommandHandler::handleListCmd(int clientSocket) {
+void CommandHandler::handleListCmd(int clientSocket, const IrcMessage &msg) {
+    (void)msg;
     server.handleList(clientSocket);
 }
 
-void CommandHandler::handlePrivMsgCmd(int clientSocket, std::istringstream &iss) {
-    std::string target, message;
-    iss >> target;
-    std::getline(iss, message);
-    if (!message.empty() && message[0] == ':') message.erase(0, 1);
+void CommandHandler::handlePrivMsgCmd(int clientSocket, const IrcMessage &msg) {
+    server.handlePrivMsg(clientSocket, msg.paramStr(0), msg.paramStr(1));
+}
 
-    server.handlePrivMsg(clientSocket, target, message);
+void CommandHandler::handleKickCmd(int clientSocket, const IrcMessage &msg) {
+    server.handleKick(clientSocket, msg.paramStr(0), msg.paramStr(1));
 }
 
-void CommandHandler::handleKickCmd(int clientSocket, std::istringstream &iss) {
-    std::string channel, targetNick;
-    iss >> channel >> targetNick;
-    server.handleKick(clientSocket, channel, targetNick);
+void CommandHandler::handleInviteCmd(int clientSocket, const IrcMessage &msg) {
+    server.handleInvite(clientSocket, msg.paramStr(0), msg.paramStr(1));
 }
 
-void CommandHandler::handleInviteCmd(int clientSocket, std::istringstream &iss) {
-    std::string channel, targetNick;
-    iss >> channel >> targetNick;
-    server.handleInvite(clientSocket, channel, targetNick);
+void CommandHandler::handleTopicCmd(int clientSocket, const IrcMessage &msg) {
+    server.handleTopic(clientSocket, msg.paramStr(0), msg.paramStr(1));
 }
 
-void CommandHandler::handleTopicCmd(int clientSocket, std::istringstream &iss) {
-    std::string channel, topic;
-    iss >> channel;
-    std::getline(iss, topic);
+void CommandHandler::handleModeCmd(int clientSocket, const IrcMessage &msg) {
+    std::vector<std::string> params;
+    for (size_t i = 2; i < msg.paramCount; ++i)
+        params.push_back(msg.paramStr(i));
+    server.handleMode(clientSocket, msg.paramStr(0), msg.paramStr(1), params);
+}
 
-    topic.erase(0, topic.find_first_not_of(" \t"));
+void CommandHandler::handlePingCmd(int clientSocket, const IrcMessage &msg) {
+    std::string token = msg.paramStr(0);
 
-    if (!topic.empty() && topic[0] == ':') {
-        topic.erase(0, 1);
+    if (token.empty()) {
+        token = "*";
     }
 
-    server.handleTopic(clientSocket, channel, topic);
+    server.handlePing(clientSocket, token);
+}
+
+/**
+ * @brief PONG : rien à faire, toute ligne reçue compte déjà comme activité
+ * pour le timer de PING (Server::executeLine).
+ */
+void CommandHandler::handlePongCmd(int clientSocket, const IrcMessage &msg) {
+    (void)clientSocket;
+    (void)msg;
 }
 
+void CommandHandler::handleNamesCmd(int clientSocket, const IrcMessage &msg) {
+    server.handleNames(clientSocket, msg.paramStr(0));
+}
 
+void CommandHandler::handleWhoisCmd(int clientSocket, const IrcMessage &msg) {
+    server.handleWhois(clientSocket, msg.paramStr(0));
+}
 
-void CommandHandler::handleModeCmd(int clientSocket, std::istringstream &iss) {
-    std::string channel, mode, param;
-    iss >> channel >> mode;
-    if (iss >> param) {
-        server.handleMode(clientSocket, channel, mode, param);
-    } else {
-        server.handleMode(clientSocket, channel, mode, "");
-    }
+void CommandHandler::handleOperCmd(int clientSocket, const IrcMessage &msg) {
+    server.handleOper(clientSocket, msg.paramStr(0), msg.paramStr(1));
 }
 
-void CommandHandler::handlePingCmd(int clientSocket, std::istringstream &iss) {
-    std::string token;
-    iss >> token;
-    
-    if (token.empty()) {
-        token = "*";
-    }
-    
-    server.handlePing(clientSocket, token);
+void CommandHandler::handleChatHistoryCmd(int clientSocket, const IrcMessage &msg) {
+    server.handleChatHistory(clientSocket, msg.paramStr(0), msg.paramStr(1), msg.paramStr(2), msg.paramStr(3),
+                             msg.paramStr(4));
+}
+
+void CommandHandler::handleStatsCmd(int clientSocket, const IrcMessage &msg) {
+    server.handleStats(clientSocket, msg.paramStr(0));
+}
+
+void CommandHandler::handleUpgradeCmd(int clientSocket, const IrcMessage &) {
+    server.handleUpgrade(clientSocket);
 }
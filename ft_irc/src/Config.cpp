@@ -0,0 +1,180 @@
+/* ************************************************************************** */
+/*                                                                            */
+/*                                                        :::      ::::::::   */
+/*   Config.cpp                                         :+:      :+:    :+:   */
+/*                                                    +:+ +:+         +:+     */
+/*   By: kpourcel <marvin@42.fr>                    +#+  +:+       +#+        */
+/*                                                +#+#+#+#+#+   +#+           */
+/*   Created: 2025/04/03 11:05:51 by kpourcel          #+#    #+#             */
+/*   Updated: 2025/04/03 11:05:51 by kpourcel         ###   ########.fr       */
+/*                                                                            */
+/* ************************************************************************** */
+
+#include "../include/Config.hpp"
+#include "../include/Logger.hpp"
+#include <cstdlib>
+
+ServerConfig::ServerConfig() : backend("epoll"), sendQueueLimit(DEFAULT_SENDQ_LIMIT), threads(0),
+      logLevel(LOG_LEVEL_INFO), metricsPort(0),
+      pingInterval(DEFAULT_PING_INTERVAL), pingTimeout(DEFAULT_PING_TIMEOUT),
+      registerTimeout(DEFAULT_REGISTER_TIMEOUT), floodRate(DEFAULT_FLOOD_RATE),
+      floodBurst(DEFAULT_FLOOD_BURST), historyLines(DEFAULT_HISTORY_LINES),
+      historyMemory(DEFAULT_HISTORY_MEMORY), archiveSegmentBytes(DEFAULT_ARCHIVE_SEGMENT_BYTES),
+      archiveSegmentAge(DEFAULT_ARCHIVE_SEGMENT_AGE), archiveSyncMs(DEFAULT_ARCHIVE_SYNC_MS),
+      snapshotInterval(DEFAULT_SNAPSHOT_INTERVAL), upgradeFd(-1) {}
+
+/**
+ * @brief Applique une option --clé=valeur à la configuration.
+ *
+ * @return false si l'option est inconnue ou sa valeur invalide.
+ */
+bool parseConfigOption(const std::string& arg, ServerConfig& config) {
+    if (arg.compare(0, 2, "--") != 0)
+        return false;
+    size_t eq = arg.find('=');
+    if (eq == std::string::npos)
+        return false;
+    std::string key = arg.substr(2, eq - 2);
+    std::string value = arg.substr(eq + 1);
+
+    if (key == "backend") {
+        if (value != "epoll" && value != "poll")
+            return false;
+        config.backend = value;
+        return true;
+    }
+    if (key == "sendq") {
+        char* end;
+        long limit = std::strtol(value.c_str(), &end, 10);
+        if (value.empty() || *end != '\0' || limit < 512)
+            return false;
+        config.sendQueueLimit = static_cast<size_t>(limit);
+        return true;
+    }
+    if (key == "threads") {
+        char* end;
+        long count = std::strtol(value.c_str(), &end, 10);
+        if (value.empty() || *end != '\0' || count < 1 || count > MAX_REACTOR_THREADS)
+            return false;
+        config.threads = static_cast<size_t>(count);
+        return true;
+    }
+    if (key == "log-level") {
+        int level = Logger::parseLevel(value);
+        if (level < 0)
+            return false;
+        config.logLevel = level;
+        return true;
+    }
+    if (key == "log-file") {
+        if (value.empty())
+            return false;
+        config.logFile = value;
+        return true;
+    }
+    if (key == "metrics-port") {
+        char* end;
+        long port = std::strtol(value.c_str(), &end, 10);
+        if (value.empty() || *end != '\0' || port < 1 || port > 65535)
+            return false;
+        config.metricsPort = static_cast<int>(port);
+        return true;
+    }
+    if (key == "ping-interval" || key == "ping-timeout" || key == "register-timeout") {
+        char* end;
+        long seconds = std::strtol(value.c_str(), &end, 10);
+        if (value.empty() || *end != '\0' || seconds < 1 || seconds > 86400)
+            return false;
+        if (key == "ping-interval")
+            config.pingInterval = seconds;
+        else if (key == "ping-timeout")
+            config.pingTimeout = seconds;
+        else
+            config.registerTimeout = seconds;
+        return true;
+    }
+    if (key == "flood-rate" || key == "flood-burst") {
+        char* end;
+        long amount = std::strtol(value.c_str(), &end, 10);
+        long minimum = (key == "flood-rate") ? 0 : 2;
+        if (value.empty() || *end != '\0' || amount < minimum || amount > 100000)
+            return false;
+        if (key == "flood-rate")
+            config.floodRate = amount;
+        else
+            config.floodBurst = amount;
+        return true;
+    }
+    if (key == "history-lines") {
+        char* end;
+        long lines = std::strtol(value.c_str(), &end, 10);
+        if (value.empty() || *end != '\0' || lines < 0 || lines > MAX_HISTORY_LINES)
+            return false;
+        config.historyLines = static_cast<size_t>(lines);
+        return true;
+    }
+    if (key == "history-memory") {
+        char* end;
+        long bytes = std::strtol(value.c_str(), &end, 10);
+        if (value.empty() || *end != '\0' || bytes < 0)
+            return false;
+        config.historyMemory = static_cast<size_t>(bytes);
+        return true;
+    }
+    if (key == "archive-dir") {
+        if (value.empty())
+            return false;
+        config.archiveDir = value;
+        return true;
+    }
+    if (key == "archive-segment-size") {
+        char* end;
+        long bytes = std::strtol(value.c_str(), &end, 10);
+        if (value.empty() || *end != '\0' || bytes < 4096)
+            return false;
+        config.archiveSegmentBytes = static_cast<size_t>(bytes);
+        return true;
+    }
+    if (key == "archive-segment-age" || key == "archive-sync-ms") {
+        char* end;
+        long amount = std::strtol(value.c_str(), &end, 10);
+        if (value.empty() || *end != '\0' || amount < 1 || amount > 86400000)
+            return false;
+        if (key == "archive-segment-age")
+            config.archiveSegmentAge = amount;
+        else
+            config.archiveSyncMs = amount;
+        return true;
+    }
+    if (key == "snapshot-file") {
+        if (value.empty())
+            return false;
+        config.snapshotFile = value;
+        return true;
+    }
+    if (key == "snapshot-interval") {
+        char* end;
+        long seconds = std::strtol(value.c_str(), &end, 10);
+        if (value.empty() || *end != '\0' || seconds < 1 || seconds > 86400)
+            return false;
+        config.snapshotInterval = seconds;
+        return true;
+    }
+    if (key == "upgrade-fd") {
+        char* end;
+        long fd = std::strtol(value.c_str(), &end, 10);
+        if (value.empty() || *end != '\0' || fd < 3 || fd > 1048576)
+            return false;
+        config.upgradeFd = static_cast<int>(fd);
+        return true;
+    }
+    if (key == "oper") {
+        size_t colon = value.find(':');
+        if (colon == std::string::npos || colon == 0 || colon + 1 == value.size())
+            return false;
+        config.operName = value.substr(0, colon);
+        config.operPassword = value.substr(colon + 1);
+        return true;
+    }
+    return false;
+}
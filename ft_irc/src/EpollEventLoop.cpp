@@ -0,0 +1,98 @@
+/* ************************************************************************** */
+/*                                                                            */
+/*                                                        :::      ::::::::   */
+/*   EpollEventLoop.cpp                                 :+:      :+:    :+:   */
+/*                                                    +:+ +:+         +:+     */
+/*   By: kpourcel <marvin@42.fr>                    +#+  +:+       +#+        */
+/*                                                +#+#+#+#+#+   +#+           */
+/*   Created: 2025/04/03 10:33:05 by kpourcel          #+#    #+#             */
+/*   Updated: 2025/04/03 10:33:05 by kpourcel         ###   ########.fr       */
+/*                                                                            */
+/* ************************************************************************** */
+
+#include "../include/EpollEventLoop.hpp"
+
+#ifdef __linux__
+
+#include <unistd.h>
+
+#define EPOLL_INITIAL_EVENTS 64
+
+EpollEventLoop::EpollEventLoop() : readyEvents(EPOLL_INITIAL_EVENTS) {
+    epollFd = epoll_create(EPOLL_INITIAL_EVENTS);
+}
+
+EpollEventLoop::~EpollEventLoop() {
+    if (epollFd >= 0)
+        close(epollFd);
+}
+
+bool EpollEventLoop::isValid() const {
+    return epollFd >= 0;
+}
+
+unsigned int EpollEventLoop::toEpollEvents(int events) {
+    unsigned int epollEvents = EPOLLET;
+    if (events & EVENT_READ)
+        epollEvents |= EPOLLIN | EPOLLRDHUP;
+    if (events & EVENT_WRITE)
+        epollEvents |= EPOLLOUT;
+    return epollEvents;
+}
+
+bool EpollEventLoop::add(int fd, int events) {
+    struct epoll_event ev;
+    ev.events = toEpollEvents(events);
+    ev.data.fd = fd;
+    return epoll_ctl(epollFd, EPOLL_CTL_ADD, fd, &ev) == 0;
+}
+
+/**
+ * @brief Change les événements surveillés.
+ *
+ * EPOLL_CTL_MOD réarme le descripteur : si la condition est déjà vraie
+ * (socket inscriptible par exemple), un nouveau front est signalé.
+ */
+bool EpollEventLoop::modify(int fd, int events) {
+    struct epoll_event ev;
+    ev.events = toEpollEvents(events);
+    ev.data.fd = fd;
+    return epoll_ctl(epollFd, EPOLL_CTL_MOD, fd, &ev) == 0;
+}
+
+void EpollEventLoop::remove(int fd) {
+    struct epoll_event ev;
+    ev.events = 0;
+    ev.data.fd = fd;
+    epoll_ctl(epollFd, EPOLL_CTL_DEL, fd, &ev);
+}
+
+int EpollEventLoop::wait(std::vector<IoEvent>& events, int timeoutMs) {
+    events.clear();
+    int ret = epoll_wait(epollFd, &readyEvents[0], readyEvents.size(), timeoutMs);
+    if (ret <= 0)
+        return ret;
+
+    for (int i = 0; i < ret; ++i) {
+        unsigned int revents = readyEvents[i].events;
+        IoEvent ev;
+        ev.fd = readyEvents[i].data.fd;
+        ev.events = 0;
+        if (revents & EPOLLIN)
+            ev.events |= EVENT_READ;
+        if (revents & EPOLLOUT)
+            ev.events |= EVENT_WRITE;
+        if (revents & (EPOLLERR | EPOLLHUP | EPOLLRDHUP))
+            ev.events |= EVENT_ERROR;
+        events.push_back(ev);
+    }
+    if (static_cast<size_t>(ret) == readyEvents.size())
+        readyEvents.resize(readyEvents.size() * 2);
+    return ret;
+}
+
+const char* EpollEventLoop::getName() const {
+    return "epoll";
+}
+
+#endif
@@ -0,0 +1,40 @@
+/* ************************************************************************** */
+/*                                                                            */
+/*                                                        :::      ::::::::   */
+/*   EventLoop.cpp                                      :+:      :+:    :+:   */
+/*                                                    +:+ +:+         +:+     */
+/*   By: kpourcel <marvin@42.fr>                    +#+  +:+       +#+        */
+/*                                                +#+#+#+#+#+   +#+           */
+/*   Created: 2025/04/03 10:21:19 by kpourcel          #+#    #+#             */
+/*   Updated: 2025/04/03 10:21:19 by kpourcel         ###   ########.fr       */
+/*                                                                            */
+/* ************************************************************************** */
+
+#include "../include/EventLoop.hpp"
+#include "../include/PollEventLoop.hpp"
+#include "../include/EpollEventLoop.hpp"
+
+EventLoop::~EventLoop() {}
+
+/**
+ * @brief Instancie le backend demandé.
+ *
+ * "epoll" est utilisé par défaut quand il est disponible ; poll() sert de
+ * repli si epoll n'existe pas sur la plateforme ou ne peut pas être créé.
+ *
+ * @param backend "epoll" ou "poll".
+ * @return EventLoop* Boucle d'événements allouée (à libérer par l'appelant).
+ */
+EventLoop* EventLoop::create(const std::string& backend) {
+#ifdef __linux__
+    if (backend != "poll") {
+        EpollEventLoop* loop = new EpollEventLoop();
+        if (loop->isValid())
+            return loop;
+        delete loop;
+    }
+#else
+    (void)backend;
+#endif
+    return new PollEventLoop();
+}
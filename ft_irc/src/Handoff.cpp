@@ -0,0 +1,294 @@
+/* ************************************************************************** */
+/*                                                                            */
+/*                                                        :::      ::::::::   */
+/*   Handoff.cpp                                        :+:      :+:    :+:   */
+/*                                                    +:+ +:+         +:+     */
+/*   By: kpourcel <marvin@42.fr>                    +#+  +:+       +#+        */
+/*                                                +#+#+#+#+#+   +#+           */
+/*   Created: 2025/04/19 16:37:05 by kpourcel          #+#    #+#             */
+/*   Updated: 2025/04/19 16:37:05 by kpourcel         ###   ########.fr       */
+/*                                                                            */
+/* ************************************************************************** */
+
+#include "../include/Handoff.hpp"
+#include "../include/ArchiveFormat.hpp"
+#include "../include/Logger.hpp"
+
+#include <cerrno>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <dirent.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <unistd.h>
+#include <sys/socket.h>
+
+/**
+ * @brief Descripteurs ouverts du processus (/proc/self/fd).
+ */
+static void openDescriptors(std::vector<int>& fds) {
+    DIR* dir = opendir("/proc/self/fd");
+    if (!dir)
+        return;
+    int own = dirfd(dir);
+    while (struct dirent* entry = readdir(dir)) {
+        int fd = std::atoi(entry->d_name);
+        if (entry->d_name[0] != '.' && fd != own)
+            fds.push_back(fd);
+    }
+    closedir(dir);
+}
+
+/**
+ * @brief Lance le nouveau binaire avec --upgrade-fd=<n>.
+ *
+ * Entre fork et exec, le fils ferme tous les descripteurs sauf 0, 1, 2 et
+ * son bout de la paire : sockets des clients et fichiers ne lui arrivent
+ * que par SCM_RIGHTS, et une connexion fermée par le nouveau processus
+ * n'est pas gardée ouverte par un doublon hérité. Tout ce qui alloue est
+ * préparé avant le fork.
+ *
+ * @param channel Reçoit le bout de la paire côté ancien processus.
+ * @return Le pid du fils, ou -1.
+ */
+pid_t Handoff::spawn(const std::vector<std::string>& commandLine, int& channel) {
+    int pair[2];
+    if (commandLine.empty() || socketpair(AF_UNIX, SOCK_STREAM, 0, pair) < 0)
+        return -1;
+    fcntl(pair[0], F_SETFD, FD_CLOEXEC);
+
+    std::vector<std::string> arguments;
+    for (size_t i = 0; i < commandLine.size(); ++i) {
+        if (commandLine[i].compare(0, 13, "--upgrade-fd=") != 0)
+            arguments.push_back(commandLine[i]);
+    }
+    char option[32];
+    snprintf(option, sizeof(option), "--upgrade-fd=%d", pair[1]);
+    arguments.push_back(option);
+    std::vector<char*> argv;
+    for (size_t i = 0; i < arguments.size(); ++i)
+        argv.push_back(const_cast<char*>(arguments[i].c_str()));
+    argv.push_back(NULL);
+
+    std::vector<int> inherited;
+    openDescriptors(inherited);
+    long limit = inherited.empty() ? sysconf(_SC_OPEN_MAX) : 0;
+
+    pid_t pid = fork();
+    if (pid == 0) {
+        for (size_t i = 0; i < inherited.size(); ++i) {
+            if (inherited[i] > 2 && inherited[i] != pair[1])
+                close(inherited[i]);
+        }
+        for (long fd = 3; fd < limit; ++fd) {
+            if (fd != pair[1])
+                close(static_cast<int>(fd));
+        }
+        execvp(argv[0], &argv[0]);
+        _exit(127);
+    }
+    close(pair[1]);
+    if (pid < 0) {
+        close(pair[0]);
+        return -1;
+    }
+    channel = pair[0];
+    return pid;
+}
+
+static bool sendAll(int channel, const char* data, size_t length) {
+    while (length > 0) {
+        ssize_t sent = ::send(channel, data, length, MSG_NOSIGNAL);
+        if (sent < 0) {
+            if (errno == EINTR)
+                continue;
+            return false;
+        }
+        data += sent;
+        length -= static_cast<size_t>(sent);
+    }
+    return true;
+}
+
+static bool recvAll(int channel, char* data, size_t length) {
+    while (length > 0) {
+        ssize_t received = recv(channel, data, length, 0);
+        if (received < 0 && errno == EINTR)
+            continue;
+        if (received <= 0)
+            return false;
+        data += received;
+        length -= static_cast<size_t>(received);
+    }
+    return true;
+}
+
+/**
+ * @brief Envoie l'en-tête, les descripteurs puis l'état (bloquant).
+ */
+bool Handoff::send(int channel, const std::vector<int>& fds, const std::string& state) {
+    std::string header(HANDOFF_MAGIC, HANDOFF_MAGIC_SIZE);
+    ArchiveFormat::putInt(header, fds.size(), 4);
+    ArchiveFormat::putInt(header, state.size(), 4);
+    if (!sendAll(channel, header.data(), header.size()))
+        return false;
+
+    for (size_t first = 0; first < fds.size(); first += HANDOFF_FDS_PER_MESSAGE) {
+        size_t count = fds.size() - first;
+        if (count > HANDOFF_FDS_PER_MESSAGE)
+            count = HANDOFF_FDS_PER_MESSAGE;
+
+        char byte = 'F';
+        struct iovec iov;
+        iov.iov_base = &byte;
+        iov.iov_len = 1;
+        std::vector<char> control(CMSG_SPACE(count * sizeof(int)), 0);
+        struct msghdr msg;
+        std::memset(&msg, 0, sizeof(msg));
+        msg.msg_iov = &iov;
+        msg.msg_iovlen = 1;
+        msg.msg_control = &control[0];
+        msg.msg_controllen = control.size();
+        struct cmsghdr* cmsg = CMSG_FIRSTHDR(&msg);
+        cmsg->cmsg_level = SOL_SOCKET;
+        cmsg->cmsg_type = SCM_RIGHTS;
+        cmsg->cmsg_len = CMSG_LEN(count * sizeof(int));
+        std::memcpy(CMSG_DATA(cmsg), &fds[first], count * sizeof(int));
+
+        ssize_t sent;
+        do {
+            sent = sendmsg(channel, &msg, MSG_NOSIGNAL);
+        } while (sent < 0 && errno == EINTR);
+        if (sent != 1)
+            return false;
+    }
+    return sendAll(channel, state.data(), state.size());
+}
+
+/**
+ * @brief Reçoit l'en-tête, les descripteurs puis l'état (bloquant).
+ *
+ * Les descripteurs reçus sont marqués close-on-exec.
+ */
+bool Handoff::receive(int channel, std::vector<int>& fds, std::string& state) {
+    char header[HANDOFF_HEADER_SIZE];
+    if (!recvAll(channel, header, sizeof(header))
+        || std::memcmp(header, HANDOFF_MAGIC, HANDOFF_MAGIC_SIZE) != 0)
+        return false;
+    size_t count = ArchiveFormat::readU32(header + 8);
+    size_t length = ArchiveFormat::readU32(header + 12);
+
+    while (fds.size() < count) {
+        char byte;
+        struct iovec iov;
+        iov.iov_base = &byte;
+        iov.iov_len = 1;
+        std::vector<char> control(CMSG_SPACE(HANDOFF_FDS_PER_MESSAGE * sizeof(int)), 0);
+        struct msghdr msg;
+        std::memset(&msg, 0, sizeof(msg));
+        msg.msg_iov = &iov;
+        msg.msg_iovlen = 1;
+        msg.msg_control = &control[0];
+        msg.msg_controllen = control.size();
+
+        int flags = 0;
+#ifdef MSG_CMSG_CLOEXEC
+        flags |= MSG_CMSG_CLOEXEC;
+#endif
+        ssize_t received;
+        do {
+            received = recvmsg(channel, &msg, flags);
+        } while (received < 0 && errno == EINTR);
+        if (received != 1 || (msg.msg_flags & MSG_CTRUNC))
+            return false;
+        for (struct cmsghdr* cmsg = CMSG_FIRSTHDR(&msg); cmsg; cmsg = CMSG_NXTHDR(&msg, cmsg)) {
+            if (cmsg->cmsg_level != SOL_SOCKET || cmsg->cmsg_type != SCM_RIGHTS)
+                continue;
+            size_t arrived = (cmsg->cmsg_len - CMSG_LEN(0)) / sizeof(int);
+            const int* data = reinterpret_cast<const int*>(CMSG_DATA(cmsg));
+            for (size_t i = 0; i < arrived; ++i) {
+                fcntl(data[i], F_SETFD, FD_CLOEXEC);
+                fds.push_back(data[i]);
+            }
+        }
+    }
+
+    state.resize(length);
+    return length == 0 || recvAll(channel, &state[0], length);
+}
+
+/**
+ * @brief Attend la confirmation du nouveau processus.
+ *
+ * @return false si le délai expire ou si le nouveau processus s'est arrêté.
+ */
+bool Handoff::waitReady(int channel, int timeoutMs) {
+    struct pollfd ready;
+    ready.fd = channel;
+    ready.events = POLLIN;
+    int ret;
+    do {
+        ret = poll(&ready, 1, timeoutMs);
+    } while (ret < 0 && errno == EINTR);
+    char byte = 0;
+    return ret > 0 && recv(channel, &byte, 1, 0) == 1 && byte == HANDOFF_READY;
+}
+
+bool Handoff::signalReady(int channel) {
+    char byte = HANDOFF_READY;
+    return sendAll(channel, &byte, 1);
+}
+
+/**
+ * @brief Ajoute un bloc (u32 longueur + octets) à `out`.
+ */
+void Handoff::putBytes(std::string& out, const char* data, size_t length) {
+    ArchiveFormat::putInt(out, length, 4);
+    out.append(data, length);
+}
+
+/* -------------------------------------------------------------------------- */
+/*                                HandoffReader                               */
+/* -------------------------------------------------------------------------- */
+
+HandoffReader::HandoffReader(const std::string& data) : data(data), offset(0), failed(false) {}
+
+bool HandoffReader::reserve(size_t length) {
+    if (failed || length > data.size() - offset) {
+        failed = true;
+        return false;
+    }
+    return true;
+}
+
+unsigned long HandoffReader::readInt(size_t bytes) {
+    if (!reserve(bytes))
+        return 0;
+    unsigned long value = ArchiveFormat::readInt(data.data() + offset, bytes);
+    offset += bytes;
+    return value;
+}
+
+std::string HandoffReader::readField() {
+    std::string field;
+    if (!failed && !ArchiveFormat::readField(data.data(), data.size(), offset, field))
+        failed = true;
+    return field;
+}
+
+std::string HandoffReader::readBytes() {
+    size_t length = readInt(4);
+    if (!reserve(length))
+        return std::string();
+    offset += length;
+    return data.substr(offset - length, length);
+}
+
+bool HandoffReader::ok() const {
+    return !failed;
+}
+
+bool HandoffReader::atEnd() const {
+    return offset == data.size();
+}
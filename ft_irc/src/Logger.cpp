@@ -0,0 +1,354 @@
+/* ************************************************************************** */
+/*                                                                            */
+/*                                                        :::      ::::::::   */
+/*   Logger.cpp                                         :+:      :+:    :+:   */
+/*                                                    +:+ +:+         +:+     */
+/*   By: kpourcel <marvin@42.fr>                    +#+  +:+       +#+        */
+/*                                                +#+#+#+#+#+   +#+           */
+/*   Created: 2025/04/13 11:32:10 by kpourcel          #+#    #+#             */
+/*   Updated: 2025/04/13 11:32:10 by kpourcel         ###   ########.fr       */
+/*                                                                            */
+/* ************************************************************************** */
+
+#include "../include/Logger.hpp"
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <cerrno>
+#include <ctime>
+#include <csignal>
+#include <unistd.h>
+#include <fcntl.h>
+#include <pthread.h>
+#include <sys/time.h>
+
+#define LOG_BATCH_SIZE  65536
+#define LOG_IDLE_MIN_NS 1000000
+#define LOG_IDLE_MAX_NS 16000000
+
+/**
+ * Case de l'anneau (file bornée de D. Vyukov) : `sequence` indique au
+ * producteur que la case est libre (== position) et au consommateur qu'elle
+ * est remplie (== position + 1).
+ */
+struct LogCell {
+    size_t          sequence;
+    int             level;
+    size_t          length;
+    struct timeval  time;
+    char            text[LOG_RECORD_MAX];
+};
+
+int Logger::minLevel = LOG_LEVEL_INFO;
+
+static LogCell      ring[LOG_RING_SIZE];
+static size_t       enqueuePos = 0;
+static size_t       dequeuePos = 0;
+static size_t       dropped = 0;
+static size_t       unreported = 0;
+static int          running = 0;
+static int          outputFd = STDOUT_FILENO;
+static pthread_t    writerThread;
+static char         batch[LOG_BATCH_SIZE];
+static size_t       batchUsed = 0;
+
+/* -------------------------------------------------------------------------- */
+/*                                Écriture                                    */
+/* -------------------------------------------------------------------------- */
+
+static const char* levelName(int level) {
+    switch (level) {
+        case LOG_LEVEL_DEBUG:   return "DEBUG";
+        case LOG_LEVEL_INFO:    return "INFO ";
+        case LOG_LEVEL_WARN:    return "WARN ";
+        default:                return "ERROR";
+    }
+}
+
+/**
+ * @brief Formate un enregistrement : "AAAA-MM-JJ HH:MM:SS.mmm NIVEAU texte\n".
+ *
+ * @param out Tampon d'au moins LOG_RECORD_MAX + 64 octets.
+ * @return Nombre d'octets écrits.
+ */
+static size_t formatRecord(char* out, int level, const struct timeval& time, const char* text, size_t length) {
+    struct tm local;
+    time_t seconds = time.tv_sec;
+    localtime_r(&seconds, &local);
+
+    size_t used = strftime(out, 32, "%Y-%m-%d %H:%M:%S", &local);
+    used += snprintf(out + used, 32, ".%03ld %s ", static_cast<long>(time.tv_usec / 1000), levelName(level));
+    std::memcpy(out + used, text, length);
+    used += length;
+    out[used++] = '\n';
+    return used;
+}
+
+static void writeAll(const char* data, size_t length) {
+    while (length > 0) {
+        ssize_t written = write(outputFd, data, length);
+        if (written < 0) {
+            if (errno == EINTR)
+                continue;
+            return;
+        }
+        data += written;
+        length -= written;
+    }
+}
+
+static void flushBatch() {
+    writeAll(batch, batchUsed);
+    batchUsed = 0;
+}
+
+/**
+ * @brief Vide l'anneau dans le tampon de lot (thread d'écriture uniquement).
+ *
+ * Un seul write() par lot ; les enregistrements perdus depuis le dernier
+ * passage sont signalés par une ligne WARN.
+ *
+ * @return Nombre d'enregistrements écrits.
+ */
+static size_t drainRing() {
+    size_t count = 0;
+
+    while (true) {
+        LogCell* cell = &ring[dequeuePos & (LOG_RING_SIZE - 1)];
+        if (__atomic_load_n(&cell->sequence, __ATOMIC_ACQUIRE) != dequeuePos + 1)
+            break;
+        if (batchUsed + LOG_RECORD_MAX + 64 > LOG_BATCH_SIZE)
+            flushBatch();
+        batchUsed += formatRecord(batch + batchUsed, cell->level, cell->time, cell->text, cell->length);
+        __atomic_store_n(&cell->sequence, dequeuePos + LOG_RING_SIZE, __ATOMIC_RELEASE);
+        ++dequeuePos;
+        ++count;
+    }
+
+    size_t lost = __atomic_exchange_n(&unreported, 0, __ATOMIC_RELAXED);
+    if (lost > 0) {
+        char text[96];
+        int length = snprintf(text, sizeof(text), "⚠️  Logger : %lu enregistrement(s) perdu(s), anneau plein",
+                              static_cast<unsigned long>(lost));
+        struct timeval now;
+        gettimeofday(&now, NULL);
+        if (batchUsed + LOG_RECORD_MAX + 64 > LOG_BATCH_SIZE)
+            flushBatch();
+        batchUsed += formatRecord(batch + batchUsed, LOG_LEVEL_WARN, now, text, length);
+    }
+    if (batchUsed > 0)
+        flushBatch();
+    return count;
+}
+
+/**
+ * @brief Boucle du thread d'écriture.
+ *
+ * Sans activité, l'attente double (1 à 16 ms) : un serveur inactif ne
+ * réveille presque plus ce thread, sans appel système côté producteurs.
+ */
+static void* writerMain(void*) {
+    struct timespec idle;
+    idle.tv_sec = 0;
+    idle.tv_nsec = LOG_IDLE_MIN_NS;
+
+    while (__atomic_load_n(&running, __ATOMIC_ACQUIRE)) {
+        if (drainRing() > 0) {
+            idle.tv_nsec = LOG_IDLE_MIN_NS;
+            continue;
+        }
+        nanosleep(&idle, NULL);
+        if (idle.tv_nsec < LOG_IDLE_MAX_NS)
+            idle.tv_nsec *= 2;
+    }
+    drainRing();
+    return NULL;
+}
+
+static void stopAtExit() {
+    Logger::stop();
+}
+
+/* -------------------------------------------------------------------------- */
+/*                                Logger                                      */
+/* -------------------------------------------------------------------------- */
+
+/**
+ * @brief Démarre le thread d'écriture.
+ *
+ * @param level Niveau minimal à l'exécution (au moins IRC_LOG_LEVEL en pratique).
+ * @param path Fichier de destination (ajout) ; vide pour stdout.
+ * @return false si le fichier ou le thread n'a pu être créé.
+ */
+bool Logger::start(int level, const std::string& path) {
+    static bool registered = false;
+
+    if (running)
+        return true;
+    minLevel = level;
+    if (!path.empty()) {
+        int fd = open(path.c_str(), O_WRONLY | O_CREAT | O_APPEND, 0644);
+        if (fd < 0)
+            return false;
+        outputFd = fd;
+    }
+    for (size_t i = 0; i < LOG_RING_SIZE; ++i)
+        ring[i].sequence = i;
+    enqueuePos = 0;
+    dequeuePos = 0;
+
+    sigset_t all;
+    sigset_t previous;
+    sigfillset(&all);
+    pthread_sigmask(SIG_SETMASK, &all, &previous);
+    __atomic_store_n(&running, 1, __ATOMIC_RELEASE);
+    int err = pthread_create(&writerThread, NULL, &writerMain, NULL);
+    pthread_sigmask(SIG_SETMASK, &previous, NULL);
+    if (err != 0) {
+        __atomic_store_n(&running, 0, __ATOMIC_RELEASE);
+        return false;
+    }
+    if (!registered) {
+        atexit(&stopAtExit);
+        registered = true;
+    }
+    return true;
+}
+
+/**
+ * @brief Arrête le thread d'écriture après avoir vidé l'anneau.
+ *
+ * Appelé automatiquement à la sortie du programme.
+ */
+void Logger::stop() {
+    if (!__atomic_load_n(&running, __ATOMIC_ACQUIRE))
+        return;
+    __atomic_store_n(&running, 0, __ATOMIC_RELEASE);
+    pthread_join(writerThread, NULL);
+    drainRing();
+    if (outputFd != STDOUT_FILENO) {
+        close(outputFd);
+        outputFd = STDOUT_FILENO;
+    }
+}
+
+/**
+ * @brief Dépose un enregistrement dans l'anneau (tout thread, sans verrou).
+ *
+ * Si l'anneau est plein, l'enregistrement est perdu et compté.
+ */
+void Logger::submit(int level, const char* text, size_t length) {
+    struct timeval now;
+    gettimeofday(&now, NULL);
+
+    if (!__atomic_load_n(&running, __ATOMIC_ACQUIRE)) {
+        char line[LOG_RECORD_MAX + 64];
+        writeAll(line, formatRecord(line, level, now, text, length));
+        return;
+    }
+
+    size_t pos = __atomic_load_n(&enqueuePos, __ATOMIC_RELAXED);
+    LogCell* cell;
+    while (true) {
+        cell = &ring[pos & (LOG_RING_SIZE - 1)];
+        size_t sequence = __atomic_load_n(&cell->sequence, __ATOMIC_ACQUIRE);
+        long diff = static_cast<long>(sequence) - static_cast<long>(pos);
+        if (diff == 0) {
+            if (__atomic_compare_exchange_n(&enqueuePos, &pos, pos + 1, false,
+                                            __ATOMIC_RELAXED, __ATOMIC_RELAXED))
+                break;
+        } else if (diff < 0) {
+            __atomic_add_fetch(&dropped, 1, __ATOMIC_RELAXED);
+            __atomic_add_fetch(&unreported, 1, __ATOMIC_RELAXED);
+            return;
+        } else {
+            pos = __atomic_load_n(&enqueuePos, __ATOMIC_RELAXED);
+        }
+    }
+
+    cell->level = level;
+    cell->time = now;
+    cell->length = length;
+    std::memcpy(cell->text, text, length);
+    __atomic_store_n(&cell->sequence, pos + 1, __ATOMIC_RELEASE);
+}
+
+/**
+ * @return Nombre total d'enregistrements perdus (anneau plein).
+ */
+size_t Logger::getDropped() {
+    return __atomic_load_n(&dropped, __ATOMIC_RELAXED);
+}
+
+/**
+ * @return Le niveau correspondant à "debug", "info", "warn" ou "error", -1 sinon.
+ */
+int Logger::parseLevel(const std::string& name) {
+    if (name == "debug")
+        return LOG_LEVEL_DEBUG;
+    if (name == "info")
+        return LOG_LEVEL_INFO;
+    if (name == "warn")
+        return LOG_LEVEL_WARN;
+    if (name == "error")
+        return LOG_LEVEL_ERROR;
+    return -1;
+}
+
+/* -------------------------------------------------------------------------- */
+/*                                LogLine                                     */
+/* -------------------------------------------------------------------------- */
+
+LogLine::LogLine(int level) : level(level), length(0) {}
+
+LogLine::~LogLine() {
+    Logger::submit(level, text, length);
+}
+
+/**
+ * @brief Ajoute des octets à la ligne (tronqués à LOG_RECORD_MAX).
+ */
+LogLine& LogLine::append(const char* data, size_t size) {
+    if (size > LOG_RECORD_MAX - length)
+        size = LOG_RECORD_MAX - length;
+    std::memcpy(text + length, data, size);
+    length += size;
+    return *this;
+}
+
+LogLine& LogLine::operator<<(const char* value) {
+    return append(value, std::strlen(value));
+}
+
+LogLine& LogLine::operator<<(const std::string& value) {
+    return append(value.data(), value.size());
+}
+
+LogLine& LogLine::operator<<(const LogBytes& value) {
+    return append(value.data, value.length);
+}
+
+LogLine& LogLine::operator<<(char value) {
+    return append(&value, 1);
+}
+
+LogLine& LogLine::operator<<(int value) {
+    return *this << static_cast<long>(value);
+}
+
+LogLine& LogLine::operator<<(unsigned int value) {
+    return *this << static_cast<unsigned long>(value);
+}
+
+LogLine& LogLine::operator<<(long value) {
+    char digits[24];
+    int size = snprintf(digits, sizeof(digits), "%ld", value);
+    return append(digits, size);
+}
+
+LogLine& LogLine::operator<<(unsigned long value) {
+    char digits[24];
+    int size = snprintf(digits, sizeof(digits), "%lu", value);
+    return append(digits, size);
+}
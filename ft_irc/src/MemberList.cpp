@@ -0,0 +1,112 @@
+/* ************************************************************************** */
+/*                                                                            */
+/*                                                        :::      ::::::::   */
+/*   MemberList.cpp                                     :+:      :+:    :+:   */
+/*                                                    +:+ +:+         +:+     */
+/*   By: kpourcel <marvin@42.fr>                    +#+  +:+       +#+        */
+/*                                                +#+#+#+#+#+   +#+           */
+/*   Created: 2025/04/17 10:12:41 by kpourcel          #+#    #+#             */
+/*   Updated: 2025/04/17 10:12:41 by kpourcel         ###   ########.fr       */
+/*                                                                            */
+/* ************************************************************************** */
+
+#include "../include/MemberList.hpp"
+
+/**
+ * @brief Position de la première entrée dont le fd est >= fd.
+ *
+ * Dichotomie sans branche sur la comparaison (sélection conditionnelle) :
+ * les tests d'appartenance ratés ne paient pas de mauvaise prédiction.
+ */
+static size_t lowerBound(const std::vector<ChannelMember>& members, int fd) {
+    if (members.empty())
+        return 0;
+    const ChannelMember* base = &members[0];
+    size_t count = members.size();
+    while (count > 1) {
+        size_t half = count / 2;
+        base = (base[half].fd < fd) ? base + half : base;
+        count -= half;
+    }
+    return static_cast<size_t>(base - &members[0]) + (base->fd < fd);
+}
+
+ChannelMember* MemberList::find(int fd) {
+    size_t pos = lowerBound(members, fd);
+    if (pos == members.size() || members[pos].fd != fd)
+        return NULL;
+    return &members[pos];
+}
+
+const ChannelMember* MemberList::find(int fd) const {
+    size_t pos = lowerBound(members, fd);
+    if (pos == members.size() || members[pos].fd != fd)
+        return NULL;
+    return &members[pos];
+}
+
+/**
+ * @brief Ajoute un membre (ou renvoie l'entrée existante).
+ */
+ChannelMember& MemberList::insert(int fd, Client* client) {
+    size_t pos = lowerBound(members, fd);
+    if (pos < members.size() && members[pos].fd == fd)
+        return members[pos];
+
+    ChannelMember entry;
+    entry.fd = fd;
+    entry.modes = 0;
+    entry.prefix = 0;
+    entry.client = client;
+    members.insert(members.begin() + pos, entry);
+    return members[pos];
+}
+
+/**
+ * @brief Retire un membre.
+ * @return false si le fd n'était pas membre.
+ */
+bool MemberList::erase(int fd) {
+    size_t pos = lowerBound(members, fd);
+    if (pos == members.size() || members[pos].fd != fd)
+        return false;
+    members.erase(members.begin() + pos);
+    return true;
+}
+
+/**
+ * @brief Active ou retire un bit de statut et recalcule le préfixe NAMES
+ * (le statut le plus élevé l'emporte : '@' puis '+').
+ */
+void MemberList::setMode(ChannelMember& member, unsigned int mode, bool enabled) {
+    if (enabled)
+        member.modes |= mode;
+    else
+        member.modes &= ~mode;
+    if (member.modes & MEMBER_OP)
+        member.prefix = '@';
+    else if (member.modes & MEMBER_VOICE)
+        member.prefix = '+';
+    else
+        member.prefix = 0;
+}
+
+MemberList::const_iterator MemberList::begin() const {
+    return members.begin();
+}
+
+MemberList::const_iterator MemberList::end() const {
+    return members.end();
+}
+
+const ChannelMember& MemberList::front() const {
+    return members.front();
+}
+
+size_t MemberList::size() const {
+    return members.size();
+}
+
+bool MemberList::empty() const {
+    return members.empty();
+}
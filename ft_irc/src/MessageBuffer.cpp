@@ -0,0 +1,79 @@
+/* ************************************************************************** */
+/*                                                                            */
+/*                                                        :::      ::::::::   */
+/*   MessageBuffer.cpp                                  :+:      :+:    :+:   */
+/*                                                    +:+ +:+         +:+     */
+/*   By: kpourcel <marvin@42.fr>                    +#+  +:+       +#+        */
+/*                                                +#+#+#+#+#+   +#+           */
+/*   Created: 2025/04/04 14:15:09 by kpourcel          #+#    #+#             */
+/*   Updated: 2025/04/04 14:15:09 by kpourcel         ###   ########.fr       */
+/*                                                                            */
+/* ************************************************************************** */
+
+#include "../include/MessageBuffer.hpp"
+#include <cstring>
+#include <new>
+
+MessageBuffer::MessageBuffer() : block(NULL) {}
+
+MessageBuffer::MessageBuffer(const std::string& text) : block(NULL) {
+    init(text.data(), text.size());
+}
+
+MessageBuffer::MessageBuffer(const char* text, size_t length) : block(NULL) {
+    init(text, length);
+}
+
+/**
+ * @brief Alloue un bloc unique (en-tête + texte) et y copie le message.
+ */
+void MessageBuffer::init(const char* text, size_t length) {
+    if (length == 0)
+        return;
+    void* raw = ::operator new(sizeof(Block) + length);
+    block = static_cast<Block*>(raw);
+    block->refCount = 1;
+    block->length = length;
+    std::memcpy(reinterpret_cast<char*>(block + 1), text, length);
+}
+
+MessageBuffer::MessageBuffer(const MessageBuffer& other) : block(other.block) {
+    if (block)
+        __atomic_add_fetch(&block->refCount, 1, __ATOMIC_RELAXED);
+}
+
+MessageBuffer& MessageBuffer::operator=(const MessageBuffer& other) {
+    if (block != other.block) {
+        if (other.block)
+            __atomic_add_fetch(&other.block->refCount, 1, __ATOMIC_RELAXED);
+        release();
+        block = other.block;
+    }
+    return *this;
+}
+
+MessageBuffer::~MessageBuffer() {
+    release();
+}
+
+void MessageBuffer::release() {
+    if (block && __atomic_sub_fetch(&block->refCount, 1, __ATOMIC_ACQ_REL) == 0)
+        ::operator delete(block);
+    block = NULL;
+}
+
+const char* MessageBuffer::data() const {
+    return block ? reinterpret_cast<const char*>(block + 1) : "";
+}
+
+size_t MessageBuffer::size() const {
+    return block ? block->length : 0;
+}
+
+bool MessageBuffer::empty() const {
+    return block == NULL;
+}
+
+unsigned int MessageBuffer::useCount() const {
+    return block ? __atomic_load_n(&block->refCount, __ATOMIC_RELAXED) : 0;
+}
@@ -0,0 +1,116 @@
+/* ************************************************************************** */
+/*                                                                            */
+/*                                                        :::      ::::::::   */
+/*   MessageParser.cpp                                  :+:      :+:    :+:   */
+/*                                                    +:+ +:+         +:+     */
+/*   By: kpourcel <marvin@42.fr>                    +#+  +:+       +#+        */
+/*                                                +#+#+#+#+#+   +#+           */
+/*   Created: 2025/04/07 16:49:03 by kpourcel          #+#    #+#             */
+/*   Updated: 2025/04/07 16:49:03 by kpourcel         ###   ########.fr       */
+/*                                                                            */
+/* ************************************************************************** */
+
+#include "../include/MessageParser.hpp"
+#include <cstring>
+
+/**
+ * StringView
+ */
+StringView::StringView() : data(""), length(0) {}
+
+StringView::StringView(const char* str, size_t len) : data(str), length(len) {}
+
+bool StringView::empty() const {
+    return length == 0;
+}
+
+bool StringView::equals(const char* literal) const {
+    return std::strlen(literal) == length && std::memcmp(data, literal, length) == 0;
+}
+
+std::string StringView::str() const {
+    return std::string(data, length);
+}
+
+/**
+ * IrcMessage
+ */
+IrcMessage::IrcMessage() : paramCount(0), hasTrailing(false) {}
+
+StringView IrcMessage::param(size_t index) const {
+    if (index >= paramCount)
+        return StringView();
+    return params[index];
+}
+
+std::string IrcMessage::paramStr(size_t index) const {
+    return param(index).str();
+}
+
+/**
+ * @brief Découpe une ligne IRC (sans le CRLF final) en vues.
+ *
+ * - Les tags commencent par '@' et le préfixe par ':' ; tous deux sont optionnels.
+ * - Les paramètres sont séparés par un ou plusieurs espaces.
+ * - Un paramètre commençant par ':' (trailing) prend le reste de la ligne.
+ * - Le 15e paramètre prend lui aussi le reste de la ligne (RFC 1459).
+ *
+ * @param line Début de la ligne ; un '\r' final est ignoré.
+ * @param length Longueur de la ligne.
+ * @param message Résultat, dont les vues pointent dans `line`.
+ * @return false si la ligne ne contient pas de commande.
+ */
+bool MessageParser::parse(const char* line, size_t length, IrcMessage& message) {
+    const char* pos = line;
+    const char* end = line + length;
+
+    message = IrcMessage();
+    if (pos < end && end[-1] == '\r')
+        --end;
+    while (pos < end && *pos == ' ')
+        ++pos;
+
+    if (pos < end && *pos == '@') {
+        const char* space = static_cast<const char*>(std::memchr(pos, ' ', end - pos));
+        const char* stop = space ? space : end;
+        message.tags = StringView(pos + 1, stop - pos - 1);
+        pos = stop;
+        while (pos < end && *pos == ' ')
+            ++pos;
+    }
+
+    if (pos < end && *pos == ':') {
+        const char* space = static_cast<const char*>(std::memchr(pos, ' ', end - pos));
+        const char* stop = space ? space : end;
+        message.prefix = StringView(pos + 1, stop - pos - 1);
+        pos = stop;
+        while (pos < end && *pos == ' ')
+            ++pos;
+    }
+
+    const char* space = static_cast<const char*>(std::memchr(pos, ' ', end - pos));
+    const char* stop = space ? space : end;
+    message.command = StringView(pos, stop - pos);
+    pos = stop;
+    if (message.command.empty())
+        return false;
+
+    while (message.paramCount < IRC_MAX_PARAMS) {
+        while (pos < end && *pos == ' ')
+            ++pos;
+        if (pos >= end)
+            break;
+        if (*pos == ':' || message.paramCount == IRC_MAX_PARAMS - 1) {
+            if (*pos == ':')
+                ++pos;
+            message.params[message.paramCount++] = StringView(pos, end - pos);
+            message.hasTrailing = true;
+            break;
+        }
+        space = static_cast<const char*>(std::memchr(pos, ' ', end - pos));
+        stop = space ? space : end;
+        message.params[message.paramCount++] = StringView(pos, stop - pos);
+        pos = stop;
+    }
+    return true;
+}
@@ -0,0 +1,305 @@
+/* ************************************************************************** */
+/*                                                                            */
+/*                                                        :::      ::::::::   */
+/*   Metrics.cpp                                        :+:      :+:    :+:   */
+/*                                                    +:+ +:+         +:+     */
+/*   By: kpourcel <marvin@42.fr>                    +#+  +:+       +#+        */
+/*                                                +#+#+#+#+#+   +#+           */
+/*   Created: 2025/04/15 10:14:22 by kpourcel          #+#    #+#             */
+/*   Updated: 2025/04/15 10:14:22 by kpourcel         ###   ########.fr       */
+/*                                                                            */
+/* ************************************************************************** */
+
+#include "../include/Metrics.hpp"
+
+#include <sstream>
+#include <ctime>
+
+/* -------------------------------------------------------------------------- */
+/*  Accès atomiques relâchés (un seul écrivain par emplacement)               */
+/* -------------------------------------------------------------------------- */
+
+static inline unsigned long loadRelaxed(const unsigned long& slot) {
+    return __atomic_load_n(&slot, __ATOMIC_RELAXED);
+}
+
+static inline void bumpRelaxed(unsigned long& slot, unsigned long amount) {
+    __atomic_store_n(&slot, __atomic_load_n(&slot, __ATOMIC_RELAXED) + amount, __ATOMIC_RELAXED);
+}
+
+/* -------------------------------------------------------------------------- */
+/*  LatencyHistogram                                                          */
+/* -------------------------------------------------------------------------- */
+
+LatencyHistogram::LatencyHistogram() : count(0), sum(0), max(0) {
+    for (size_t i = 0; i < HISTOGRAM_BUCKETS; ++i)
+        buckets[i] = 0;
+}
+
+/**
+ * @brief Indice de la case : les petites valeurs ont leur propre case, puis
+ * chaque puissance de deux est découpée selon les bits qui suivent le bit de
+ * poids fort.
+ */
+size_t LatencyHistogram::bucketIndex(unsigned long value) {
+    if (value < HISTOGRAM_SUB_COUNT)
+        return value;
+    int msb = 63 - __builtin_clzl(value);
+    int shift = msb - HISTOGRAM_SUB_BITS;
+    size_t index = (shift + 1) * HISTOGRAM_SUB_COUNT
+                 + ((value >> shift) & (HISTOGRAM_SUB_COUNT - 1));
+    return index < HISTOGRAM_BUCKETS ? index : HISTOGRAM_BUCKETS - 1;
+}
+
+/**
+ * @brief Plus grande valeur rangée dans la case donnée.
+ */
+unsigned long LatencyHistogram::bucketUpperBound(size_t index) {
+    if (index < HISTOGRAM_SUB_COUNT)
+        return index;
+    size_t shift = index / HISTOGRAM_SUB_COUNT - 1;
+    unsigned long sub = index % HISTOGRAM_SUB_COUNT;
+    return ((HISTOGRAM_SUB_COUNT + sub) << shift) + ((1UL << shift) - 1);
+}
+
+void LatencyHistogram::record(unsigned long value) {
+    bumpRelaxed(buckets[bucketIndex(value)], 1);
+    bumpRelaxed(count, 1);
+    bumpRelaxed(sum, value);
+    if (value > loadRelaxed(max))
+        __atomic_store_n(&max, value, __ATOMIC_RELAXED);
+}
+
+/**
+ * @brief Ajoute un histogramme (éventuellement en cours d'écriture par un
+ * autre thread) à celui-ci, qui doit être local à l'appelant.
+ */
+void LatencyHistogram::merge(const LatencyHistogram& other) {
+    for (size_t i = 0; i < HISTOGRAM_BUCKETS; ++i)
+        buckets[i] += loadRelaxed(other.buckets[i]);
+    count += loadRelaxed(other.count);
+    sum += loadRelaxed(other.sum);
+    unsigned long otherMax = loadRelaxed(other.max);
+    if (otherMax > max)
+        max = otherMax;
+}
+
+unsigned long LatencyHistogram::getCount() const { return count; }
+unsigned long LatencyHistogram::getSum() const { return sum; }
+unsigned long LatencyHistogram::getMax() const { return max; }
+
+/**
+ * @brief Quantile (0..1) approché par la borne haute de sa case.
+ */
+unsigned long LatencyHistogram::percentile(double quantile) const {
+    if (count == 0)
+        return 0;
+    unsigned long target = static_cast<unsigned long>(quantile * count + 0.5);
+    if (target == 0)
+        target = 1;
+    unsigned long seen = 0;
+    for (size_t i = 0; i < HISTOGRAM_BUCKETS; ++i) {
+        seen += buckets[i];
+        if (seen >= target) {
+            unsigned long bound = bucketUpperBound(i);
+            return bound < max ? bound : max;
+        }
+    }
+    return max;
+}
+
+/**
+ * @brief Nombre d'échantillons dont la case est entièrement sous la borne
+ * (buckets cumulatifs Prometheus).
+ */
+unsigned long LatencyHistogram::countAtOrBelow(unsigned long bound) const {
+    unsigned long total = 0;
+    for (size_t i = 0; i < HISTOGRAM_BUCKETS && bucketUpperBound(i) <= bound; ++i)
+        total += buckets[i];
+    return total;
+}
+
+/* -------------------------------------------------------------------------- */
+/*  Shards par thread                                                         */
+/* -------------------------------------------------------------------------- */
+
+MetricsShard::MetricsShard() {
+    for (size_t i = 0; i < METRIC_COUNTER_COUNT; ++i)
+        counters[i] = 0;
+    for (size_t i = 0; i < METRICS_MAX_VERBS; ++i)
+        commandCounts[i] = 0;
+}
+
+static MetricsShard*    shards[METRICS_MAX_SHARDS];
+static size_t           shardCount = 0;
+static __thread MetricsShard* localShard = NULL;
+
+static const char*      verbNames[METRICS_MAX_VERBS];
+static size_t           verbCount = 0;
+
+static const long       startTime = Metrics::now();
+
+/**
+ * @brief Shard du thread courant, créé et publié au premier appel.
+ * Au-delà de METRICS_MAX_SHARDS threads, les mesures du thread ne sont plus
+ * visibles (mais restent sans danger).
+ */
+static MetricsShard& currentShard() {
+    if (localShard)
+        return *localShard;
+    localShard = new MetricsShard();
+    size_t slot = __atomic_fetch_add(&shardCount, 1, __ATOMIC_ACQ_REL);
+    if (slot < METRICS_MAX_SHARDS)
+        __atomic_store_n(&shards[slot], localShard, __ATOMIC_RELEASE);
+    return *localShard;
+}
+
+/* -------------------------------------------------------------------------- */
+/*  Enregistrement                                                            */
+/* -------------------------------------------------------------------------- */
+
+/**
+ * @brief Horloge monotone en nanosecondes.
+ */
+long Metrics::now() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1000000000L + ts.tv_nsec;
+}
+
+void Metrics::add(MetricCounter counter, unsigned long amount) {
+    bumpRelaxed(currentShard().counters[counter], amount);
+}
+
+void Metrics::recordTime(MetricTimer timer, unsigned long nanoseconds) {
+    currentShard().timers[timer].record(nanoseconds);
+}
+
+void Metrics::recordCommand(size_t verb, unsigned long nanoseconds) {
+    if (verb >= METRICS_MAX_VERBS)
+        verb = METRICS_MAX_VERBS - 1;
+    MetricsShard& shard = currentShard();
+    bumpRelaxed(shard.commandCounts[verb], 1);
+    shard.commandTimes[verb].record(nanoseconds);
+}
+
+/**
+ * @brief Nomme un indice de commande ; appelé au démarrage, avant tout
+ * enregistrement.
+ */
+void Metrics::registerVerb(size_t verb, const char* name) {
+    if (verb >= METRICS_MAX_VERBS)
+        return;
+    verbNames[verb] = name;
+    if (verb >= verbCount)
+        verbCount = verb + 1;
+}
+
+size_t Metrics::getVerbCount() {
+    return verbCount;
+}
+
+const char* Metrics::getVerbName(size_t verb) {
+    return verb < verbCount && verbNames[verb] ? verbNames[verb] : "UNKNOWN";
+}
+
+/* -------------------------------------------------------------------------- */
+/*  Lecture                                                                   */
+/* -------------------------------------------------------------------------- */
+
+/**
+ * @brief Additionne tous les shards publiés dans out (qui doit être vide).
+ */
+void Metrics::snapshot(MetricsShard& out) {
+    size_t published = __atomic_load_n(&shardCount, __ATOMIC_ACQUIRE);
+    if (published > METRICS_MAX_SHARDS)
+        published = METRICS_MAX_SHARDS;
+    for (size_t s = 0; s < published; ++s) {
+        const MetricsShard* shard = __atomic_load_n(&shards[s], __ATOMIC_ACQUIRE);
+        if (!shard)
+            continue;
+        for (size_t i = 0; i < METRIC_COUNTER_COUNT; ++i)
+            out.counters[i] += loadRelaxed(shard->counters[i]);
+        for (size_t i = 0; i < METRICS_MAX_VERBS; ++i) {
+            out.commandCounts[i] += loadRelaxed(shard->commandCounts[i]);
+            out.commandTimes[i].merge(shard->commandTimes[i]);
+        }
+        for (size_t i = 0; i < TIMER_COUNT; ++i)
+            out.timers[i].merge(shard->timers[i]);
+    }
+}
+
+long Metrics::getUptimeSeconds() {
+    return (now() - startTime) / 1000000000L;
+}
+
+/* -------------------------------------------------------------------------- */
+/*  Format d'exposition Prometheus                                            */
+/* -------------------------------------------------------------------------- */
+
+static const unsigned long histogramBounds[] = {
+    1000UL, 5000UL, 10000UL, 50000UL, 100000UL, 500000UL,
+    1000000UL, 5000000UL, 10000000UL, 100000000UL, 1000000000UL
+};
+
+static const char* counterNames[METRIC_COUNTER_COUNT] = {
+    "ircserv_received_bytes_total",
+    "ircserv_sent_bytes_total",
+    "ircserv_recv_calls_total",
+    "ircserv_send_calls_total",
+    "ircserv_lines_received_total",
+    "ircserv_messages_queued_total",
+    "ircserv_connections_total",
+    "ircserv_disconnections_total",
+    "ircserv_flood_throttles_total",
+    "ircserv_reactor_commands_total",
+    "ircserv_reactor_wakeups_total"
+};
+
+static void renderHistogram(std::ostringstream& out, const std::string& name,
+                            const std::string& labels, const LatencyHistogram& histogram) {
+    std::string separator = labels.empty() ? "" : ",";
+    for (size_t i = 0; i < sizeof(histogramBounds) / sizeof(histogramBounds[0]); ++i)
+        out << name << "_bucket{" << labels << separator << "le=\""
+            << histogramBounds[i] / 1e9 << "\"} " << histogram.countAtOrBelow(histogramBounds[i]) << "\n";
+    out << name << "_bucket{" << labels << separator << "le=\"+Inf\"} " << histogram.getCount() << "\n";
+    std::string braces = labels.empty() ? "" : "{" + labels + "}";
+    out << name << "_sum" << braces << " " << histogram.getSum() / 1e9 << "\n";
+    out << name << "_count" << braces << " " << histogram.getCount() << "\n";
+}
+
+/**
+ * @brief Compteurs et histogrammes au format texte Prometheus 0.0.4
+ * (les jauges propres au serveur sont ajoutées par l'appelant).
+ */
+std::string Metrics::renderPrometheus() {
+    MetricsShard* total = new MetricsShard();
+    snapshot(*total);
+
+    std::ostringstream out;
+    out << "# TYPE ircserv_uptime_seconds gauge\n"
+        << "ircserv_uptime_seconds " << getUptimeSeconds() << "\n";
+    for (size_t i = 0; i < METRIC_COUNTER_COUNT; ++i)
+        out << "# TYPE " << counterNames[i] << " counter\n"
+            << counterNames[i] << " " << total->counters[i] << "\n";
+
+    out << "# TYPE ircserv_commands_total counter\n";
+    for (size_t i = 0; i < verbCount; ++i)
+        if (total->commandCounts[i])
+            out << "ircserv_commands_total{command=\"" << getVerbName(i) << "\"} "
+                << total->commandCounts[i] << "\n";
+
+    out << "# TYPE ircserv_command_duration_seconds histogram\n";
+    for (size_t i = 0; i < verbCount; ++i)
+        if (total->commandCounts[i])
+            renderHistogram(out, "ircserv_command_duration_seconds",
+                            std::string("command=\"") + getVerbName(i) + "\"", total->commandTimes[i]);
+
+    out << "# TYPE ircserv_recv_duration_seconds histogram\n";
+    renderHistogram(out, "ircserv_recv_duration_seconds", "", total->timers[TIMER_RECV]);
+    out << "# TYPE ircserv_send_duration_seconds histogram\n";
+    renderHistogram(out, "ircserv_send_duration_seconds", "", total->timers[TIMER_SEND]);
+
+    delete total;
+    return out.str();
+}
@@ -0,0 +1,180 @@
+/* ************************************************************************** */
+/*                                                                            */
+/*                                                        :::      ::::::::   */
+/*   MetricsEndpoint.cpp                                :+:      :+:    :+:   */
+/*                                                    +:+ +:+         +:+     */
+/*   By: kpourcel <marvin@42.fr>                    +#+  +:+       +#+        */
+/*                                                +#+#+#+#+#+   +#+           */
+/*   Created: 2025/04/15 14:02:51 by kpourcel          #+#    #+#             */
+/*   Updated: 2025/04/15 14:02:51 by kpourcel         ###   ########.fr       */
+/*                                                                            */
+/* ************************************************************************** */
+
+#include "../include/MetricsEndpoint.hpp"
+#include "../include/Server.hpp"
+
+/**
+ * @brief L'endpoint n'écoute qu'après `open()`.
+ */
+MetricsEndpoint::MetricsEndpoint(Server& server, EventLoop* loop)
+    : server(server), eventLoop(loop), listenSocket(-1) {}
+
+MetricsEndpoint::~MetricsEndpoint() {
+    while (!requests.empty())
+        closeRequest(requests.begin()->first);
+    if (listenSocket >= 0) {
+        eventLoop->remove(listenSocket);
+        close(listenSocket);
+    }
+}
+
+/**
+ * @brief Ouvre le socket d'écoute sur 127.0.0.1:port.
+ *
+ * @return false (errno positionné) si le socket ne peut pas être ouvert.
+ */
+bool MetricsEndpoint::open(int port) {
+    struct sockaddr_in addr;
+
+    listenSocket = socket(AF_INET, SOCK_STREAM, 0);
+    if (listenSocket < 0)
+        return false;
+
+    int enable = 1;
+    setsockopt(listenSocket, SOL_SOCKET, SO_REUSEADDR, &enable, sizeof(enable));
+
+    memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    addr.sin_port = htons(port);
+
+    if (bind(listenSocket, (struct sockaddr *)&addr, sizeof(addr)) < 0
+        || listen(listenSocket, 16) < 0
+        || fcntl(listenSocket, F_SETFL, O_NONBLOCK) < 0
+        || !eventLoop->add(listenSocket, EVENT_READ)) {
+        close(listenSocket);
+        listenSocket = -1;
+        return false;
+    }
+    return true;
+}
+
+/**
+ * @brief Reprend un socket d'écoute déjà ouvert (mise à jour à chaud).
+ */
+bool MetricsEndpoint::adopt(int socket) {
+    if (!eventLoop->add(socket, EVENT_READ)) {
+        close(socket);
+        return false;
+    }
+    listenSocket = socket;
+    return true;
+}
+
+int MetricsEndpoint::getListenSocket() const {
+    return listenSocket;
+}
+
+bool MetricsEndpoint::owns(int fd) const {
+    return fd == listenSocket || requests.count(fd) != 0;
+}
+
+void MetricsEndpoint::handleEvent(int fd, int events) {
+    if (fd == listenSocket) {
+        acceptRequests();
+        return;
+    }
+    if (events & (EVENT_READ | EVENT_ERROR))
+        readRequest(fd);
+    if (requests.count(fd) && (events & EVENT_WRITE))
+        writeResponse(fd);
+}
+
+void MetricsEndpoint::acceptRequests() {
+    while (true) {
+        int fd = accept(listenSocket, NULL, NULL);
+        if (fd < 0) {
+            if (errno == EINTR)
+                continue;
+            return;
+        }
+        if (fcntl(fd, F_SETFL, O_NONBLOCK) < 0 || !eventLoop->add(fd, EVENT_READ)) {
+            close(fd);
+            continue;
+        }
+        requests[fd];
+    }
+}
+
+/**
+ * @brief Lit l'en-tête de la requête jusqu'à la ligne vide, puis prépare
+ * la réponse : les métriques pour GET /metrics, 404 sinon.
+ */
+void MetricsEndpoint::readRequest(int fd) {
+    MetricsRequest& request = requests[fd];
+    char buffer[1024];
+
+    while (request.output.empty()) {
+        ssize_t bytesRead = recv(fd, buffer, sizeof(buffer), 0);
+        if (bytesRead < 0 && errno == EINTR)
+            continue;
+        if (bytesRead < 0 && (errno == EAGAIN || errno == EWOULDBLOCK))
+            return;
+        if (bytesRead <= 0) {
+            closeRequest(fd);
+            return;
+        }
+        request.input.append(buffer, bytesRead);
+        if (request.input.size() > METRICS_REQUEST_MAX) {
+            closeRequest(fd);
+            return;
+        }
+        if (request.input.find("\r\n\r\n") == std::string::npos
+            && request.input.find("\n\n") == std::string::npos)
+            continue;
+
+        std::string status = "404 Not Found";
+        std::string body = "Not Found\n";
+        if (request.input.compare(0, 13, "GET /metrics ") == 0) {
+            status = "200 OK";
+            body = server.renderMetrics();
+        }
+        std::ostringstream response;
+        response << "HTTP/1.1 " << status << "\r\n"
+                 << "Content-Type: text/plain; version=0.0.4\r\n"
+                 << "Content-Length: " << body.size() << "\r\n"
+                 << "Connection: close\r\n\r\n"
+                 << body;
+        request.output = response.str();
+    }
+    writeResponse(fd);
+}
+
+/**
+ * @brief Écrit la réponse jusqu'à EAGAIN ; ferme la connexion une fois
+ * la réponse complète.
+ */
+void MetricsEndpoint::writeResponse(int fd) {
+    MetricsRequest& request = requests[fd];
+
+    while (request.sent < request.output.size()) {
+        ssize_t sent = send(fd, request.output.data() + request.sent,
+                            request.output.size() - request.sent, MSG_NOSIGNAL);
+        if (sent < 0 && errno == EINTR)
+            continue;
+        if (sent < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+            eventLoop->modify(fd, EVENT_READ | EVENT_WRITE);
+            return;
+        }
+        if (sent < 0)
+            break;
+        request.sent += sent;
+    }
+    closeRequest(fd);
+}
+
+void MetricsEndpoint::closeRequest(int fd) {
+    eventLoop->remove(fd);
+    close(fd);
+    requests.erase(fd);
+}
@@ -0,0 +1,137 @@
+/* ************************************************************************** */
+/*                                                                            */
+/*                                                        :::      ::::::::   */
+/*   NickIndex.cpp                                      :+:      :+:    :+:   */
+/*                                                    +:+ +:+         +:+     */
+/*   By: kpourcel <marvin@42.fr>                    +#+  +:+       +#+        */
+/*                                                +#+#+#+#+#+   +#+           */
+/*   Created: 2025/04/05 09:58:12 by kpourcel          #+#    #+#             */
+/*   Updated: 2025/04/05 09:58:12 by kpourcel         ###   ########.fr       */
+/*                                                                            */
+/* ************************************************************************** */
+
+#include "../include/NickIndex.hpp"
+
+#define NICKINDEX_INITIAL_BUCKETS 64
+
+NickIndex::NickIndex() : buckets(NICKINDEX_INITIAL_BUCKETS, static_cast<Node*>(NULL)), count(0) {}
+
+NickIndex::~NickIndex() {
+    for (size_t i = 0; i < buckets.size(); ++i) {
+        Node* node = buckets[i];
+        while (node) {
+            Node* next = node->next;
+            delete node;
+            node = next;
+        }
+    }
+}
+
+/**
+ * Casemapping RFC 1459 : A-Z et []\^ deviennent a-z et {}|~ (même écart
+ * de 32 dans la table ASCII). Seule normalisation des pseudos, utilisée par
+ * equals() et hashNick().
+ */
+char NickIndex::foldChar(char c) {
+    if (c >= 'A' && c <= '^')
+        return c + ('a' - 'A');
+    return c;
+}
+
+bool NickIndex::equals(const std::string& a, const std::string& b) {
+    if (a.size() != b.size())
+        return false;
+    for (size_t i = 0; i < a.size(); ++i) {
+        if (foldChar(a[i]) != foldChar(b[i]))
+            return false;
+    }
+    return true;
+}
+
+/**
+ * @brief FNV-1a calculé sur la forme normalisée, sans allouer de chaîne.
+ */
+size_t NickIndex::hashNick(const std::string& nickname) {
+    size_t hash = 2166136261u;
+    for (size_t i = 0; i < nickname.size(); ++i) {
+        hash ^= static_cast<unsigned char>(foldChar(nickname[i]));
+        hash *= 16777619u;
+    }
+    return hash;
+}
+
+/**
+ * Accès à l'index
+ */
+NickIndex::Node* NickIndex::findNode(const std::string& nickname, size_t hash) const {
+    Node* node = buckets[hash & (buckets.size() - 1)];
+    while (node) {
+        if (node->hash == hash && equals(node->key, nickname))
+            return node;
+        node = node->next;
+    }
+    return NULL;
+}
+
+/**
+ * @brief Associe un pseudo à un client.
+ *
+ * @return false si le pseudo (au casemapping près) est déjà pris.
+ */
+bool NickIndex::insert(const std::string& nickname, Client* client) {
+    size_t hash = hashNick(nickname);
+    if (findNode(nickname, hash))
+        return false;
+    if (count >= buckets.size())
+        rehash(buckets.size() * 2);
+
+    Node* node = new Node;
+    node->key = nickname;
+    node->hash = hash;
+    node->client = client;
+    size_t index = hash & (buckets.size() - 1);
+    node->next = buckets[index];
+    buckets[index] = node;
+    ++count;
+    return true;
+}
+
+bool NickIndex::erase(const std::string& nickname) {
+    size_t hash = hashNick(nickname);
+    Node** link = &buckets[hash & (buckets.size() - 1)];
+    while (*link) {
+        Node* node = *link;
+        if (node->hash == hash && equals(node->key, nickname)) {
+            *link = node->next;
+            delete node;
+            --count;
+            return true;
+        }
+        link = &node->next;
+    }
+    return false;
+}
+
+Client* NickIndex::find(const std::string& nickname) const {
+    Node* node = findNode(nickname, hashNick(nickname));
+    return node ? node->client : NULL;
+}
+
+size_t NickIndex::size() const {
+    return count;
+}
+
+void NickIndex::rehash(size_t newBucketCount) {
+    std::vector<Node*> newBuckets(newBucketCount, static_cast<Node*>(NULL));
+    for (size_t i = 0; i < buckets.size(); ++i) {
+        Node* node = buckets[i];
+        while (node) {
+            Node* next = node->next;
+            size_t index = node->hash & (newBucketCount - 1);
+            node->next = newBuckets[index];
+            newBuckets[index] = node;
+            node = next;
+        }
+    }
+    buckets.swap(newBuckets);
+}
@@ -0,0 +1,94 @@
+/* ************************************************************************** */
+/*                                                                            */
+/*                                                        :::      ::::::::   */
+/*   PollEventLoop.cpp                                  :+:      :+:    :+:   */
+/*                                                    +:+ +:+         +:+     */
+/*   By: kpourcel <marvin@42.fr>                    +#+  +:+       +#+        */
+/*                                                +#+#+#+#+#+   +#+           */
+/*   Created: 2025/04/03 10:26:48 by kpourcel          #+#    #+#             */
+/*   Updated: 2025/04/03 10:26:48 by kpourcel         ###   ########.fr       */
+/*                                                                            */
+/* ************************************************************************** */
+
+#include "../include/PollEventLoop.hpp"
+
+PollEventLoop::PollEventLoop() {}
+
+PollEventLoop::~PollEventLoop() {}
+
+short PollEventLoop::toPollEvents(int events) {
+    short pollEvents = 0;
+    if (events & EVENT_READ)
+        pollEvents |= POLLIN;
+    if (events & EVENT_WRITE)
+        pollEvents |= POLLOUT;
+    return pollEvents;
+}
+
+bool PollEventLoop::add(int fd, int events) {
+    if (fd < 0)
+        return false;
+    if (static_cast<size_t>(fd) >= slots.size())
+        slots.resize(fd + 1, -1);
+    if (slots[fd] != -1)
+        return modify(fd, events);
+
+    struct pollfd pfd;
+    pfd.fd = fd;
+    pfd.events = toPollEvents(events);
+    pfd.revents = 0;
+    slots[fd] = static_cast<int>(pollFds.size());
+    pollFds.push_back(pfd);
+    return true;
+}
+
+bool PollEventLoop::modify(int fd, int events) {
+    if (fd < 0 || static_cast<size_t>(fd) >= slots.size() || slots[fd] == -1)
+        return false;
+    pollFds[slots[fd]].events = toPollEvents(events);
+    return true;
+}
+
+/**
+ * @brief Retire un descripteur en O(1) : le dernier pollfd prend sa place.
+ */
+void PollEventLoop::remove(int fd) {
+    if (fd < 0 || static_cast<size_t>(fd) >= slots.size() || slots[fd] == -1)
+        return;
+    int index = slots[fd];
+    int last = static_cast<int>(pollFds.size()) - 1;
+    if (index != last) {
+        pollFds[index] = pollFds[last];
+        slots[pollFds[index].fd] = index;
+    }
+    pollFds.pop_back();
+    slots[fd] = -1;
+}
+
+int PollEventLoop::wait(std::vector<IoEvent>& events, int timeoutMs) {
+    events.clear();
+    int ret = poll(pollFds.empty() ? NULL : &pollFds[0], pollFds.size(), timeoutMs);
+    if (ret <= 0)
+        return ret;
+
+    for (size_t i = 0; i < pollFds.size() && static_cast<int>(events.size()) < ret; ++i) {
+        short revents = pollFds[i].revents;
+        if (!revents)
+            continue;
+        IoEvent ev;
+        ev.fd = pollFds[i].fd;
+        ev.events = 0;
+        if (revents & POLLIN)
+            ev.events |= EVENT_READ;
+        if (revents & POLLOUT)
+            ev.events |= EVENT_WRITE;
+        if (revents & (POLLERR | POLLHUP | POLLNVAL))
+            ev.events |= EVENT_ERROR;
+        events.push_back(ev);
+    }
+    return static_cast<int>(events.size());
+}
+
+const char* PollEventLoop::getName() const {
+    return "poll";
+}
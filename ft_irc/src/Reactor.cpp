@@ -0,0 +1,591 @@
+/* ************************************************************************** */
+/*                                                                            */
+/*                                                        :::      ::::::::   */
+/*   Reactor.cpp                                        :+:      :+:    :+:   */
+/*                                                    +:+ +:+         +:+     */
+/*   By: kpourcel <marvin@42.fr>                    +#+  +:+       +#+        */
+/*                                                +#+#+#+#+#+   +#+           */
+/*   Created: 2025/04/11 14:57:19 by kpourcel          #+#    #+#             */
+/*   Updated: 2025/04/11 14:57:19 by kpourcel         ###   ########.fr       */
+/*                                                                            */
+/* ************************************************************************** */
+
+#include "../include/Reactor.hpp"
+#include "../include/Logger.hpp"
+#include "../include/Metrics.hpp"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <cerrno>
+#include <csignal>
+#include <unistd.h>
+#include <fcntl.h>
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+
+ReactorConnection::ReactorConnection(int socketFd)
+    : fd(socketFd), writeArmed(false), dead(false), flushPending(false), inflight(0), paused(0) {}
+
+ReactorEvent::ReactorEvent() : type(CLOSED), fd(-1), reactor(NULL), connection(NULL) {}
+
+ReactorCommand::ReactorCommand() : type(STOP), fd(-1), batch(NULL), channel(NULL) {}
+
+/**
+ * @brief Ordre des membres d'un channel dans FanoutMembers (par fd).
+ */
+static bool connectionBefore(const ReactorConnection* conn, int fd) {
+    return conn->fd < fd;
+}
+
+/* -------------------------------------------------------------------------- */
+/*                                Constructeur / Destructeur                  */
+/* -------------------------------------------------------------------------- */
+
+/**
+ * @param id Numéro du réacteur (journalisation).
+ * @param listenSocket Socket d'écoute non bloquant ouvert avec SO_REUSEPORT.
+ * @param backend Backend de la boucle d'événements ("epoll" ou "poll").
+ * @param sendQueueLimit Taille maximale de la file d'envoi d'une connexion.
+ * @param coreInbox Boîte aux lettres du cœur.
+ */
+Reactor::Reactor(int id, int listenSocket, const std::string& backend, size_t sendQueueLimit,
+                 Mailbox<ReactorEvent>& coreInbox)
+    : id(id), listenSocket(listenSocket), sendQueueLimit(sendQueueLimit),
+      eventLoop(EventLoop::create(backend)), started(false), running(false),
+      notifyCore(false), coreInbox(coreInbox), outboxEpoch(1) {}
+
+/**
+ * @brief Ferme les connexions restantes ; le thread doit être arrêté.
+ *
+ * Les commandes préparées par le cœur et jamais confiées sont abandonnées.
+ *
+ * Le socket d'écoute appartient au serveur et n'est pas fermé ici.
+ */
+Reactor::~Reactor() {
+    stop();
+    for (size_t i = 0; i < outbox.size(); ++i)
+        delete outbox[i].batch;
+    for (std::map<int, ReactorConnection*>::iterator it = connections.begin(); it != connections.end(); ++it) {
+        close(it->first);
+        delete it->second;
+    }
+    delete eventLoop;
+}
+
+/* -------------------------------------------------------------------------- */
+/*                                Gestion du Thread                           */
+/* -------------------------------------------------------------------------- */
+
+/**
+ * @brief Lance le thread du réacteur.
+ *
+ * Les signaux sont bloqués dans le thread : SIGINT reste traité par le cœur.
+ *
+ * @return false si le thread ou la boucle d'événements n'a pu être créé.
+ */
+bool Reactor::start() {
+    if (!eventLoop->add(listenSocket, EVENT_READ) || !eventLoop->add(commands.getWakeFd(), EVENT_READ))
+        return false;
+
+    sigset_t all;
+    sigset_t previous;
+    sigfillset(&all);
+    pthread_sigmask(SIG_SETMASK, &all, &previous);
+    running = true;
+    int err = pthread_create(&thread, NULL, &Reactor::threadMain, this);
+    pthread_sigmask(SIG_SETMASK, &previous, NULL);
+    if (err != 0) {
+        running = false;
+        return false;
+    }
+    started = true;
+    return true;
+}
+
+/**
+ * @brief Demande l'arrêt du thread et attend sa fin.
+ */
+void Reactor::stop() {
+    if (!started)
+        return;
+    command(ReactorCommand::STOP, -1, NULL);
+    pthread_join(thread, NULL);
+    started = false;
+}
+
+int Reactor::getId() const {
+    return id;
+}
+
+void* Reactor::threadMain(void* arg) {
+    static_cast<Reactor*>(arg)->loop();
+    return NULL;
+}
+
+/**
+ * @brief Boucle du réacteur.
+ *
+ * Le cœur n'est réveillé qu'une fois par itération, quel que soit le nombre
+ * d'événements publiés.
+ */
+void Reactor::loop() {
+    std::vector<IoEvent> events;
+
+    while (running) {
+        int ret = eventLoop->wait(events, -1);
+        if (ret < 0) {
+            if (errno == EINTR)
+                continue;
+            LOG_ERROR("❌ Erreur EventLoop::wait() (réacteur " << id << ") : " << strerror(errno));
+            break;
+        }
+
+        for (size_t i = 0; i < events.size(); ++i) {
+            int fd = events[i].fd;
+            if (fd == listenSocket) {
+                acceptConnections();
+                continue;
+            }
+            if (fd == commands.getWakeFd()) {
+                handleCommands();
+                continue;
+            }
+            std::map<int, ReactorConnection*>::iterator it = connections.find(fd);
+            if (it == connections.end())
+                continue;
+            ReactorConnection* conn = it->second;
+            if (!conn->dead && (events[i].events & (EVENT_READ | EVENT_ERROR)))
+                readConnection(conn);
+            if (!conn->dead && (events[i].events & EVENT_WRITE))
+                flushConnection(conn);
+        }
+
+        if (notifyCore) {
+            notifyCore = false;
+            coreInbox.wake();
+        }
+    }
+}
+
+/* -------------------------------------------------------------------------- */
+/*                                Gestion des Connexions                      */
+/* -------------------------------------------------------------------------- */
+
+/**
+ * @brief Accepte les connexions en attente jusqu'à EAGAIN et les annonce au cœur.
+ */
+void Reactor::acceptConnections() {
+    while (true) {
+        struct sockaddr_in clientAddr;
+        socklen_t clientAddrLen = sizeof(clientAddr);
+        int clientSocket = accept(listenSocket, (struct sockaddr *)&clientAddr, &clientAddrLen);
+
+        if (clientSocket < 0) {
+            if (errno == EINTR)
+                continue;
+            if (errno != EAGAIN && errno != EWOULDBLOCK)
+                LOG_ERROR("❌ Erreur accept() (réacteur " << id << ") : " << strerror(errno));
+            return;
+        }
+
+        if (fcntl(clientSocket, F_SETFL, O_NONBLOCK) < 0 || !eventLoop->add(clientSocket, EVENT_READ)) {
+            LOG_ERROR("❌ Erreur configuration du socket client : " << strerror(errno));
+            close(clientSocket);
+            continue;
+        }
+
+        ReactorConnection* conn = new ReactorConnection(clientSocket);
+        connections[clientSocket] = conn;
+        post(ReactorEvent::CONNECTED, conn, MessageBuffer(std::string(inet_ntoa(clientAddr.sin_addr))));
+    }
+}
+
+/**
+ * @brief Lit une connexion jusqu'à EAGAIN et transmet chaque ligne au cœur.
+ *
+ * La lecture est suspendue quand le cœur a trop de lignes en retard pour
+ * cette connexion ; il la relance (RESUME) une fois la moitié traitée.
+ */
+void Reactor::readConnection(ReactorConnection* conn) {
+    RecvBuffer& input = conn->input;
+
+    while (!conn->dead) {
+        if (__atomic_load_n(&conn->inflight, __ATOMIC_SEQ_CST) >= REACTOR_INFLIGHT_LINES) {
+            __atomic_store_n(&conn->paused, 1, __ATOMIC_SEQ_CST);
+            if (__atomic_load_n(&conn->inflight, __ATOMIC_SEQ_CST) > REACTOR_INFLIGHT_LINES / 2
+                || !__atomic_exchange_n(&conn->paused, 0, __ATOMIC_SEQ_CST))
+                return;
+        }
+
+        size_t room = input.prepareWrite();
+        if (room == 0)
+            return;
+
+        long start = Metrics::now();
+        ssize_t bytesRead = recv(conn->fd, input.writePtr(), room, 0);
+        Metrics::recordTime(TIMER_RECV, Metrics::now() - start);
+        Metrics::add(METRIC_RECV_CALLS, 1);
+        if (bytesRead < 0) {
+            if (errno == EAGAIN || errno == EWOULDBLOCK)
+                return;
+            if (errno == EINTR)
+                continue;
+            dropConnection(conn, "Client disconnected");
+            return;
+        }
+        if (bytesRead == 0) {
+            dropConnection(conn, "Client disconnected");
+            return;
+        }
+        Metrics::add(METRIC_BYTES_RECEIVED, bytesRead);
+        input.commit(bytesRead);
+
+        const char* line;
+        size_t length;
+        RecvBuffer::LineStatus status;
+        while ((status = input.nextLine(line, length)) != RecvBuffer::LINE_NONE) {
+            if (status == RecvBuffer::LINE_TOO_LONG) {
+                post(ReactorEvent::LINE_TOO_LONG, conn, MessageBuffer());
+                continue;
+            }
+            __atomic_add_fetch(&conn->inflight, 1, __ATOMIC_SEQ_CST);
+            post(ReactorEvent::LINE, conn, MessageBuffer(line, length));
+        }
+    }
+}
+
+/**
+ * @brief Écrit la file d'envoi d'une connexion jusqu'à EAGAIN.
+ *
+ * Chaque appel système emporte jusqu'à SEND_IOV_MAX messages (`writeTo()`) ;
+ * le socket n'est surveillé en écriture que tant qu'il reste des données.
+ */
+void Reactor::flushConnection(ReactorConnection* conn) {
+    SendQueue& output = conn->output;
+
+    while (!output.empty()) {
+        long start = Metrics::now();
+        ssize_t sent = output.writeTo(conn->fd);
+        Metrics::recordTime(TIMER_SEND, Metrics::now() - start);
+        Metrics::add(METRIC_SEND_CALLS, 1);
+        if (sent < 0) {
+            if (errno == EAGAIN || errno == EWOULDBLOCK) {
+                if (!conn->writeArmed) {
+                    eventLoop->modify(conn->fd, EVENT_READ | EVENT_WRITE);
+                    conn->writeArmed = true;
+                }
+                return;
+            }
+            if (errno == EINTR)
+                continue;
+            dropConnection(conn, "Write error");
+            return;
+        }
+        Metrics::add(METRIC_BYTES_SENT, sent);
+    }
+    if (conn->writeArmed) {
+        eventLoop->modify(conn->fd, EVENT_READ);
+        conn->writeArmed = false;
+    }
+}
+
+/**
+ * @brief Cesse de servir une connexion et en informe le cœur.
+ *
+ * Le socket reste ouvert jusqu'au CLOSE du cœur.
+ */
+void Reactor::dropConnection(ReactorConnection* conn, const std::string& reason) {
+    if (conn->dead)
+        return;
+    conn->dead = true;
+    conn->output.clear();
+    eventLoop->remove(conn->fd);
+    post(ReactorEvent::CLOSED, conn, MessageBuffer(reason));
+}
+
+/**
+ * @brief Ferme le socket et libère la connexion (sur ordre du cœur).
+ *
+ * Le cœur a déjà retiré la connexion de ses channels (PART avant CLOSE) ;
+ * le retrait est refait ici pour qu'aucune diffusion ne la vise plus.
+ */
+void Reactor::destroyConnection(ReactorConnection* conn) {
+    while (!conn->channels.empty())
+        partChannel(conn, conn->channels.back());
+    if (!conn->dead)
+        eventLoop->remove(conn->fd);
+    close(conn->fd);
+    connections.erase(conn->fd);
+    delete conn;
+}
+
+/* -------------------------------------------------------------------------- */
+/*                                Boîtes aux lettres                          */
+/* -------------------------------------------------------------------------- */
+
+void Reactor::post(ReactorEvent::Type type, ReactorConnection* conn, const MessageBuffer& payload) {
+    ReactorEvent event;
+    event.type = type;
+    event.fd = conn->fd;
+    event.reactor = this;
+    event.connection = conn;
+    event.payload = payload;
+    coreInbox.push(event);
+    notifyCore = true;
+}
+
+void Reactor::command(ReactorCommand::Type type, int fd, SendQueue* batch) {
+    ReactorCommand cmd;
+    cmd.type = type;
+    cmd.fd = fd;
+    cmd.batch = batch;
+    submit(cmd);
+}
+
+void Reactor::submit(const ReactorCommand& cmd) {
+    Metrics::add(METRIC_REACTOR_COMMANDS, 1);
+    commands.push(cmd);
+    commands.wake();
+}
+
+/**
+ * @brief Applique les commandes du cœur.
+ *
+ * - SEND : ajoute un lot de messages à la file (limite de SendQ).
+ * - FANOUT : ajoute un message à la file de chaque membre du channel.
+ * - JOIN / PART : tient à jour les membres des channels.
+ * - CLOSE : dernière écriture non bloquante puis fermeture du socket.
+ * - RESUME : reprend la lecture d'une connexion suspendue.
+ *
+ * Les connexions servies sont écrites une fois, après toutes les commandes
+ * disponibles : plusieurs lots et diffusions partent dans le même `sendmsg()`.
+ */
+void Reactor::handleCommands() {
+    ReactorCommand cmd;
+
+    commands.acknowledge();
+    Metrics::add(METRIC_REACTOR_WAKEUPS, 1);
+    while (commands.pop(cmd)) {
+        if (cmd.type == ReactorCommand::STOP) {
+            running = false;
+            continue;
+        }
+        if (cmd.type == ReactorCommand::FANOUT) {
+            fanoutMessage(cmd);
+            continue;
+        }
+        std::map<int, ReactorConnection*>::iterator it = connections.find(cmd.fd);
+        ReactorConnection* conn = (it == connections.end()) ? NULL : it->second;
+
+        if (cmd.type == ReactorCommand::SEND) {
+            if (conn && !conn->dead) {
+                if (sendQueueLimit != 0 && conn->output.size() + cmd.batch->size() > sendQueueLimit) {
+                    dropConnection(conn, "SendQ exceeded");
+                } else {
+                    conn->output.append(*cmd.batch);
+                    scheduleFlush(conn);
+                }
+            }
+            delete cmd.batch;
+        } else if (cmd.type == ReactorCommand::JOIN) {
+            if (conn)
+                joinChannel(conn, cmd.channel);
+        } else if (cmd.type == ReactorCommand::PART) {
+            if (conn)
+                partChannel(conn, cmd.channel);
+        } else if (cmd.type == ReactorCommand::CLOSE) {
+            if (!conn)
+                continue;
+            while (!conn->dead && !conn->output.empty() && conn->output.writeTo(conn->fd) > 0) {}
+            destroyConnection(conn);
+        } else if (cmd.type == ReactorCommand::RESUME) {
+            if (conn && !conn->dead)
+                readConnection(conn);
+        }
+    }
+
+    for (size_t i = 0; i < flushList.size(); ++i) {
+        std::map<int, ReactorConnection*>::iterator it = connections.find(flushList[i]);
+        if (it == connections.end() || !it->second->flushPending)
+            continue;
+        it->second->flushPending = false;
+        if (!it->second->dead)
+            flushConnection(it->second);
+    }
+    flushList.clear();
+}
+
+/**
+ * @brief Ajoute un message à la file d'une connexion (limite de SendQ).
+ */
+void Reactor::deliver(ReactorConnection* conn, const MessageBuffer& message) {
+    if (!conn->output.push(message, sendQueueLimit)) {
+        dropConnection(conn, "SendQ exceeded");
+        return;
+    }
+    scheduleFlush(conn);
+}
+
+/**
+ * @brief Note une connexion à écrire en fin de lot de commandes (une seule
+ * fois). Une connexion déjà bloquée par EAGAIN attend EVENT_WRITE.
+ */
+void Reactor::scheduleFlush(ReactorConnection* conn) {
+    if (conn->flushPending || conn->writeArmed)
+        return;
+    conn->flushPending = true;
+    flushList.push_back(conn->fd);
+}
+
+/**
+ * @brief Sert une diffusion du cœur à tous les membres locaux du channel,
+ * sauf l'exclu.
+ */
+void Reactor::fanoutMessage(const ReactorCommand& cmd) {
+    std::map<const Channel*, FanoutMembers>::iterator it = channelMembers.find(cmd.channel);
+    if (it == channelMembers.end())
+        return;
+
+    const FanoutMembers& members = it->second;
+    unsigned long queued = 0;
+    for (size_t i = 0; i < members.size(); ++i) {
+        ReactorConnection* conn = members[i];
+        if (conn->fd == cmd.fd || conn->dead)
+            continue;
+        deliver(conn, cmd.message);
+        ++queued;
+    }
+    Metrics::add(METRIC_MESSAGES_QUEUED, queued);
+}
+
+void Reactor::joinChannel(ReactorConnection* conn, const Channel* channel) {
+    FanoutMembers& members = channelMembers[channel];
+    FanoutMembers::iterator pos = std::lower_bound(members.begin(), members.end(), conn->fd, connectionBefore);
+    if (pos != members.end() && *pos == conn)
+        return;
+    members.insert(pos, conn);
+    conn->channels.push_back(channel);
+}
+
+void Reactor::partChannel(ReactorConnection* conn, const Channel* channel) {
+    std::vector<const Channel*>::iterator joined = std::find(conn->channels.begin(), conn->channels.end(), channel);
+    if (joined == conn->channels.end())
+        return;
+    *joined = conn->channels.back();
+    conn->channels.pop_back();
+
+    std::map<const Channel*, FanoutMembers>::iterator it = channelMembers.find(channel);
+    if (it == channelMembers.end())
+        return;
+    FanoutMembers& members = it->second;
+    FanoutMembers::iterator pos = std::lower_bound(members.begin(), members.end(), conn->fd, connectionBefore);
+    if (pos != members.end() && *pos == conn)
+        members.erase(pos);
+    if (members.empty())
+        channelMembers.erase(it);
+}
+
+/* -------------------------------------------------------------------------- */
+/*                                Appels depuis le cœur                       */
+/* -------------------------------------------------------------------------- */
+
+/**
+ * @brief Ouvre un lot SEND pour un client, à la suite des commandes déjà
+ * préparées : le cœur y ajoute ses réponses jusqu'à la prochaine diffusion
+ * (changement d'époque). Le réacteur en devient propriétaire à l'envoi.
+ */
+SendQueue* Reactor::stageBatch(int fd) {
+    ReactorCommand cmd;
+    cmd.type = ReactorCommand::SEND;
+    cmd.fd = fd;
+    cmd.batch = new SendQueue();
+    outbox.push_back(cmd);
+    return cmd.batch;
+}
+
+/**
+ * @brief Époque de la file de commandes : change à chaque diffusion et à
+ * chaque envoi, ce qui ferme les lots ouverts.
+ */
+unsigned long Reactor::getOutboxEpoch() const {
+    return outboxEpoch;
+}
+
+/**
+ * @brief Diffuse un message aux membres du channel servis par ce réacteur.
+ *
+ * @param excludeFd Membre à ne pas servir (-1 pour aucun).
+ */
+void Reactor::fanout(const Channel* channel, const MessageBuffer& message, int excludeFd) {
+    ReactorCommand cmd;
+    cmd.type = ReactorCommand::FANOUT;
+    cmd.fd = excludeFd;
+    cmd.channel = channel;
+    cmd.message = message;
+    outbox.push_back(cmd);
+    ++outboxEpoch;
+}
+
+/**
+ * @brief Copie une arrivée dans un channel (après son JOIN par le cœur).
+ */
+void Reactor::addMember(int fd, const Channel* channel) {
+    ReactorCommand cmd;
+    cmd.type = ReactorCommand::JOIN;
+    cmd.fd = fd;
+    cmd.channel = channel;
+    outbox.push_back(cmd);
+}
+
+/**
+ * @brief Copie un départ d'un channel (PART, KICK, QUIT, déconnexion).
+ */
+void Reactor::removeMember(int fd, const Channel* channel) {
+    ReactorCommand cmd;
+    cmd.type = ReactorCommand::PART;
+    cmd.fd = fd;
+    cmd.channel = channel;
+    outbox.push_back(cmd);
+}
+
+/**
+ * @brief Demande la fermeture d'un socket après une dernière écriture.
+ */
+void Reactor::closeConnection(int fd) {
+    ReactorCommand cmd;
+    cmd.type = ReactorCommand::CLOSE;
+    cmd.fd = fd;
+    outbox.push_back(cmd);
+}
+
+/**
+ * @brief Confie au réacteur les commandes préparées, dans l'ordre, avec un
+ * seul réveil.
+ */
+void Reactor::flushQueued() {
+    if (outbox.empty())
+        return;
+    for (size_t i = 0; i < outbox.size(); ++i) {
+        Metrics::add(METRIC_REACTOR_COMMANDS, 1);
+        commands.push(outbox[i]);
+    }
+    outbox.clear();
+    ++outboxEpoch;
+    commands.wake();
+}
+
+/**
+ * @brief Signale qu'une ligne transmise par le réacteur a été traitée.
+ *
+ * Relance la lecture d'une connexion suspendue une fois la moitié des
+ * lignes en attente traitées.
+ */
+void Reactor::lineDone(ReactorConnection* conn) {
+    int left = __atomic_sub_fetch(&conn->inflight, 1, __ATOMIC_SEQ_CST);
+    if (left <= REACTOR_INFLIGHT_LINES / 2
+        && __atomic_load_n(&conn->paused, __ATOMIC_SEQ_CST)
+        && __atomic_exchange_n(&conn->paused, 0, __ATOMIC_SEQ_CST))
+        command(ReactorCommand::RESUME, conn->fd, NULL);
+}
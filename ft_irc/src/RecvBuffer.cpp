@@ -0,0 +1,120 @@
+/* ************************************************************************** */
+/*                                                                            */
+/*                                                        :::      ::::::::   */
+/*   RecvBuffer.cpp                                     :+:      :+:    :+:   */
+/*                                                    +:+ +:+         +:+     */
+/*   By: kpourcel <marvin@42.fr>                    +#+  +:+       +#+        */
+/*                                                +#+#+#+#+#+   +#+           */
+/*   Created: 2025/04/09 12:10:54 by kpourcel          #+#    #+#             */
+/*   Updated: 2025/04/09 12:10:54 by kpourcel         ###   ########.fr       */
+/*                                                                            */
+/* ************************************************************************** */
+
+#include "../include/RecvBuffer.hpp"
+#include <cstring>
+
+RecvBuffer::RecvBuffer() : start(0), end(0), scanned(0), discarding(false) {}
+
+/**
+ * @brief Prépare l'écriture et renvoie la place disponible en fin de fenêtre.
+ *
+ * Si la fenêtre est vide elle repart du début ; si la fin est trop proche de
+ * la capacité, tout ce qui n'a pas été consommé est ramené au début en un
+ * seul memmove : le reste partiel, mais aussi les lignes complètes gardées
+ * pour plus tard (budget de l'itération épuisé ou contrôle de flood).
+ */
+size_t RecvBuffer::prepareWrite() {
+    if (start == end) {
+        start = 0;
+        end = 0;
+        scanned = 0;
+    } else if (start > 0 && RECV_BUFFER_SIZE - end < IRC_LINE_MAX) {
+        std::memmove(data, data + start, end - start);
+        scanned -= start;
+        end -= start;
+        start = 0;
+    }
+    return RECV_BUFFER_SIZE - end;
+}
+
+char* RecvBuffer::writePtr() {
+    return data + end;
+}
+
+void RecvBuffer::commit(size_t length) {
+    end += length;
+}
+
+/**
+ * @brief Extrait la prochaine ligne complète (sans CRLF).
+ *
+ * La recherche du '\n' reprend là où la précédente s'est arrêtée : chaque
+ * octet n'est parcouru qu'une fois (memchr), même pour une ligne reçue en
+ * plusieurs morceaux. Les lignes vides sont ignorées.
+ *
+ * @param line Début de la ligne, valide jusqu'au prochain appel à prepareWrite().
+ * @param length Longueur de la ligne.
+ * @return LINE_READY, LINE_NONE si aucune ligne complète, ou LINE_TOO_LONG
+ *         si une ligne dépasse 512 octets (elle est ignorée).
+ */
+RecvBuffer::LineStatus RecvBuffer::nextLine(const char*& line, size_t& length) {
+    while (true) {
+        if (scanned < start)
+            scanned = start;
+        const char* newline = static_cast<const char*>(
+            std::memchr(data + scanned, '\n', end - scanned));
+
+        if (!newline) {
+            scanned = end;
+            if (!discarding && end - start >= IRC_LINE_MAX) {
+                discarding = true;
+                start = end;
+                return LINE_TOO_LONG;
+            }
+            if (discarding)
+                start = end;
+            return LINE_NONE;
+        }
+
+        size_t lineStart = start;
+        size_t lineEnd = newline - data;
+        start = lineEnd + 1;
+        scanned = start;
+
+        if (discarding) {
+            discarding = false;
+            continue;
+        }
+        if (lineEnd + 1 - lineStart > IRC_LINE_MAX)
+            return LINE_TOO_LONG;
+        if (lineEnd > lineStart && data[lineEnd - 1] == '\r')
+            --lineEnd;
+        if (lineEnd == lineStart)
+            continue;
+
+        line = data + lineStart;
+        length = lineEnd - lineStart;
+        return LINE_READY;
+    }
+}
+
+/**
+ * @brief Remet en tête la dernière ligne renvoyée par `nextLine()`, pour
+ * la relire plus tard. Aucune écriture ne doit avoir eu lieu entre-temps.
+ */
+void RecvBuffer::unread(const char* line) {
+    start = line - data;
+    scanned = start;
+}
+
+size_t RecvBuffer::size() const {
+    return end - start;
+}
+
+bool RecvBuffer::empty() const {
+    return start == end;
+}
+
+const char* RecvBuffer::peek() const {
+    return data + start;
+}
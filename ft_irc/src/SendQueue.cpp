@@ -0,0 +1,126 @@
+/* ************************************************************************** */
+/*                                                                            */
+/*                                                        :::      ::::::::   */
+/*   SendQueue.cpp                                      :+:      :+:    :+:   */
+/*                                                    +:+ +:+         +:+     */
+/*   By: kpourcel <marvin@42.fr>                    +#+  +:+       +#+        */
+/*                                                +#+#+#+#+#+   +#+           */
+/*   Created: 2025/04/11 10:52:03 by kpourcel          #+#    #+#             */
+/*   Updated: 2025/04/11 10:52:03 by kpourcel         ###   ########.fr       */
+/*                                                                            */
+/* ************************************************************************** */
+
+#include "../include/SendQueue.hpp"
+
+#include <cstring>
+#include <sys/socket.h>
+#include <sys/uio.h>
+
+SendQueue::SendQueue() : offset(0), bytes(0) {}
+
+/**
+ * @brief Ajoute une référence vers un message (le contenu n'est pas copié).
+ *
+ * @param limit Taille maximale de la file (SendQ) ; 0 pour aucune limite.
+ * @return false si la limite est dépassée : le message n'est pas ajouté.
+ */
+bool SendQueue::push(const MessageBuffer& message, size_t limit) {
+    if (message.empty())
+        return true;
+    if (limit != 0 && bytes + message.size() > limit)
+        return false;
+    queue.push_back(message);
+    bytes += message.size();
+    return true;
+}
+
+/**
+ * @brief Déplace le contenu d'une autre file (encore jamais écrite) à la fin.
+ */
+void SendQueue::append(SendQueue& other) {
+    if (queue.empty() && offset == 0) {
+        queue.swap(other.queue);
+    } else {
+        queue.insert(queue.end(), other.queue.begin(), other.queue.end());
+        other.queue.clear();
+    }
+    bytes += other.bytes;
+    other.bytes = 0;
+    other.offset = 0;
+}
+
+void SendQueue::clear() {
+    queue.clear();
+    offset = 0;
+    bytes = 0;
+}
+
+bool SendQueue::empty() const {
+    return bytes == 0;
+}
+
+size_t SendQueue::size() const {
+    return bytes;
+}
+
+/**
+ * @brief Ajoute à `out` les octets pas encore écrits (mise à jour à chaud).
+ */
+void SendQueue::copyTo(std::string& out) const {
+    for (std::deque<MessageBuffer>::const_iterator it = queue.begin(); it != queue.end(); ++it) {
+        size_t skip = (it == queue.begin()) ? offset : 0;
+        out.append(it->data() + skip, it->size() - skip);
+    }
+}
+
+/**
+ * @brief Retire les octets déjà écrits sur le socket.
+ *
+ * Une écriture partielle avance seulement l'offset dans le premier message ;
+ * les messages entièrement écrits sont retirés de la file.
+ */
+void SendQueue::consume(size_t length) {
+    bytes -= length;
+    while (length > 0) {
+        size_t chunk = queue.front().size() - offset;
+        if (length < chunk) {
+            offset += length;
+            return;
+        }
+        length -= chunk;
+        queue.pop_front();
+        offset = 0;
+    }
+}
+
+/**
+ * @brief Écrit le début de la file en un seul appel système.
+ *
+ * Jusqu'à SEND_IOV_MAX messages sont passés à `sendmsg()` (MSG_NOSIGNAL,
+ * que `writev()` ne permet pas) sous forme d'iovecs pointant directement
+ * dans les MessageBuffer partagés, sans copie. Les octets écrits sont
+ * retirés de la file.
+ *
+ * @return Le résultat de `sendmsg()` (errno positionné si < 0).
+ */
+ssize_t SendQueue::writeTo(int fd) {
+    struct iovec iov[SEND_IOV_MAX];
+    size_t count = 0;
+
+    for (std::deque<MessageBuffer>::const_iterator it = queue.begin();
+         it != queue.end() && count < SEND_IOV_MAX; ++it, ++count) {
+        size_t skip = (count == 0) ? offset : 0;
+        iov[count].iov_base = const_cast<char*>(it->data() + skip);
+        iov[count].iov_len = it->size() - skip;
+    }
+
+    struct msghdr msg;
+    std::memset(&msg, 0, sizeof(msg));
+    msg.msg_iov = iov;
+    msg.msg_iovlen = count;
+
+    ssize_t sent = sendmsg(fd, &msg, MSG_NOSIGNAL);
+    if (sent > 0)
+        consume(sent);
+    return sent;
+}
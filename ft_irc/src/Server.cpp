@@ -20,62 +20,204 @@
  *
  * Initialise le serveur en créant un socket, en le configurant avec une adresse 
  * et un port, puis en le mettant en mode écoute pour accepter les connexions clients.
- * Utilise `poll()` pour gérer plusieurs clients simultanément sans blocage.
+ * Les sockets sont non bloquants et surveillés par une `EventLoop` (epoll ou poll).
+ *
+ * Avec `--threads=N`, N réacteurs ont chacun leur socket d'écoute (SO_REUSEPORT) ;
+ * la boucle principale ne surveille alors que la boîte aux lettres des réacteurs.
  *
  * @param port Le port sur lequel le serveur écoute les connexions.
  * @param password Le mot de passe requis pour se connecter au serveur.
+ * @param config Options facultatives (backend de la boucle d'événements, taille de SendQ, threads,
+ *               endpoint de métriques, opérateur, délais de PING et d'enregistrement,
+ *               contrôle de flood, historique, archive et instantanés des channels).
+ *
+ * Avec `--upgrade-fd=N` (mise à jour à chaud), le socket d'écoute, les
+ * sockets des clients et l'état sont repris de l'ancien processus au lieu
+ * d'être créés.
  *
  * @throws EXIT_FAILURE en cas d'erreur lors de la création du socket, du bind ou du listen.
  */
 
-Server::Server(int port, std::string password)
-    : port(port), password(password), commandHandler(*this) {
-    struct sockaddr_in serverAddr;
-    
+Server::Server(int port, std::string password, const ServerConfig& config)
+    : port(port), password(password), eventLoop(NULL),
+      sendQueueLimit(config.sendQueueLimit), commandHandler(*this), metrics(NULL), archive(NULL),
+      snapshot(NULL), operName(config.operName), operPassword(config.operPassword),
+      snapshotTimer(-1, 0), snapshotIntervalMs(config.snapshotInterval * 1000),
+      commandLine(config.commandLine), upgradeRequested(0), upgradeRequester(-1),
+      shutdownRequested(0),
+      pingIntervalMs(config.pingInterval * 1000), pingTimeoutMs(config.pingTimeout * 1000),
+      registerTimeoutMs(config.registerTimeout * 1000), floodRate(config.floodRate),
+      floodBurst(config.floodBurst), loopTurn(0), visitEpoch(0), historyBatch(0),
+      reactorBacklog(false),
+      history(config.historyLines, config.historyMemory) {
     serverName = "irc.42server.com";
-    serverSocket = socket(AF_INET, SOCK_STREAM, 0);
-    if (serverSocket < 0) {
-        perror("Erreur socket()");
-        exit(EXIT_FAILURE);
+    std::vector<int> inherited;
+    std::string inheritedState;
+    if (config.upgradeFd >= 0) {
+        if (config.threads > 0 || !Handoff::receive(config.upgradeFd, inherited, inheritedState)
+            || inherited.empty()) {
+            LOG_ERROR("❌ Mise à jour à chaud : état de l'ancien processus illisible");
+            exit(EXIT_FAILURE);
+        }
+        serverSocket = inherited[0];
+    } else {
+        serverSocket = createListenSocket(config.threads > 0);
     }
+    listenSockets.push_back(serverSocket);
 
-    memset(&serverAddr, 0, sizeof(serverAddr));
-    serverAddr.sin_family = AF_INET;
-    serverAddr.sin_addr.s_addr = INADDR_ANY;
-    serverAddr.sin_port = htons(port);
-
-    if (bind(serverSocket, (struct sockaddr *)&serverAddr, sizeof(serverAddr)) < 0) {
-        perror("Erreur bind()");
+    eventLoop = EventLoop::create(config.backend);
+    int watched = (config.threads > 0) ? reactorEvents.getWakeFd() : serverSocket;
+    if (!eventLoop->add(watched, EVENT_READ)) {
+        perror("Erreur EventLoop::add()");
         exit(EXIT_FAILURE);
     }
+    LOG_INFO("⚙️  Boucle d'événements : " << eventLoop->getName());
 
-    if (listen(serverSocket, MAX_CLIENTS) < 0) {
-        perror("Erreur listen()");
+    if (pipe(wakePipe) < 0
+        || fcntl(wakePipe[0], F_SETFL, O_NONBLOCK) < 0 || fcntl(wakePipe[1], F_SETFL, O_NONBLOCK) < 0
+        || fcntl(wakePipe[0], F_SETFD, FD_CLOEXEC) < 0 || fcntl(wakePipe[1], F_SETFD, FD_CLOEXEC) < 0
+        || !eventLoop->add(wakePipe[0], EVENT_READ)) {
+        perror("Erreur création du tube de réveil");
         exit(EXIT_FAILURE);
     }
-    
-    struct pollfd serverPollFd;
-    serverPollFd.fd = serverSocket;
-    serverPollFd.events = POLLIN;
-    pollFds.push_back(serverPollFd);
+
+    for (size_t i = 0; i < config.threads; ++i) {
+        if (i > 0)
+            listenSockets.push_back(createListenSocket(true));
+        reactors.push_back(new Reactor(i, listenSockets[i], config.backend,
+                                       sendQueueLimit, reactorEvents));
+    }
+    if (!reactors.empty())
+        LOG_INFO("🧵 Réacteurs : " << reactors.size() << " (SO_REUSEPORT)");
+
+    if (config.metricsPort > 0) {
+        metrics = new MetricsEndpoint(*this, eventLoop);
+        if (inherited.empty() && !metrics->open(config.metricsPort)) {
+            perror("Erreur ouverture de l'endpoint de métriques");
+            exit(EXIT_FAILURE);
+        }
+        LOG_INFO("📈 Métriques : http://127.0.0.1:" << config.metricsPort << "/metrics");
+    }
+
+    if (!config.archiveDir.empty()) {
+        ArchiveOptions options;
+        options.directory = config.archiveDir;
+        options.segmentBytes = config.archiveSegmentBytes;
+        options.segmentAgeMs = config.archiveSegmentAge * 1000;
+        options.syncIntervalMs = config.archiveSyncMs;
+        archive = new Archive(options);
+        if (!archive->start()) {
+            perror("Erreur démarrage de l'archive");
+            exit(EXIT_FAILURE);
+        }
+    }
+
+    if (!config.snapshotFile.empty()) {
+        snapshot = new Snapshot(config.snapshotFile);
+        if (inherited.empty()) {
+            loadSnapshot();
+        } else if (!snapshot->open()) {
+            perror("Erreur lecture de l'instantané");
+            exit(EXIT_FAILURE);
+        }
+        if (!snapshot->start()) {
+            perror("Erreur démarrage des instantanés");
+            exit(EXIT_FAILURE);
+        }
+        timers.schedule(snapshotTimer, snapshotIntervalMs);
+    }
+
+    if (!inherited.empty()) {
+        if (!restoreState(inheritedState, inherited) || !Handoff::signalReady(config.upgradeFd)) {
+            LOG_ERROR("❌ Mise à jour à chaud : reprise de l'état impossible");
+            exit(EXIT_FAILURE);
+        }
+        close(config.upgradeFd);
+        LOG_INFO("🔄 Mise à jour à chaud : " << clients.size() << " client(s) et "
+                 << channels.size() << " channel(s) repris");
+    }
 }
 
 /**
  * @brief Destructeur du serveur IRC.
  *
  * Ferme proprement le serveur en :
- * - Fermant le socket du serveur.
+ * - Arrêtant les réacteurs (mode multi-thread).
+ * - Fermant les sockets d'écoute.
  * - Fermant tous les sockets des clients connectés.
  * - Libérant la mémoire allouée pour chaque client.
  * - Affichant un message indiquant l'arrêt du serveur.
  */
 Server::~Server() {
-    close(serverSocket);
-    for (std::map<int, Client*>::iterator it = clients.begin(); it != clients.end(); ++it) {
-        close(it->first);
-        delete it->second;
+    stopReactors();
+    for (size_t i = 0; i < listenSockets.size(); ++i)
+        close(listenSockets[i]);
+    for (int fd = 0; fd < clients.limit(); ++fd) {
+        Client* client = clients.find(fd);
+        if (!client)
+            continue;
+        if (!client->getReactor())
+            close(fd);
+        delete client;
+    }
+    delete metrics;
+    delete archive;
+    delete snapshot;
+    delete eventLoop;
+    close(wakePipe[0]);
+    close(wakePipe[1]);
+    logPoolStats();
+    LOG_INFO("🔴 Serveur arrêté.");
+}
+
+/**
+ * @brief Crée un socket d'écoute non bloquant sur le port du serveur.
+ *
+ * @param reusePort Active SO_REUSEPORT : plusieurs sockets écoutent le même
+ *                  port et le noyau leur répartit les connexions.
+ */
+int Server::createListenSocket(bool reusePort) {
+    struct sockaddr_in serverAddr;
+
+    int listenSocket = socket(AF_INET, SOCK_STREAM, 0);
+    if (listenSocket < 0) {
+        perror("Erreur socket()");
+        exit(EXIT_FAILURE);
+    }
+
+    if (reusePort) {
+#ifdef SO_REUSEPORT
+        int enable = 1;
+        if (setsockopt(listenSocket, SOL_SOCKET, SO_REUSEPORT, &enable, sizeof(enable)) < 0) {
+            perror("Erreur setsockopt(SO_REUSEPORT)");
+            exit(EXIT_FAILURE);
+        }
+#else
+        std::cerr << "Erreur : SO_REUSEPORT indisponible, --threads non supporté" << std::endl;
+        exit(EXIT_FAILURE);
+#endif
+    }
+
+    memset(&serverAddr, 0, sizeof(serverAddr));
+    serverAddr.sin_family = AF_INET;
+    serverAddr.sin_addr.s_addr = INADDR_ANY;
+    serverAddr.sin_port = htons(port);
+
+    if (bind(listenSocket, (struct sockaddr *)&serverAddr, sizeof(serverAddr)) < 0) {
+        perror("Erreur bind()");
+        exit(EXIT_FAILURE);
+    }
+
+    if (listen(listenSocket, LISTEN_BACKLOG) < 0) {
+        perror("Erreur listen()");
+        exit(EXIT_FAILURE);
+    }
+
+    if (fcntl(listenSocket, F_SETFL, O_NONBLOCK) < 0) {
+        perror("Erreur fcntl()");
+        exit(EXIT_FAILURE);
     }
-    std::cout << "🔴 Serveur arrêté." << std::endl;
+    return listenSocket;
 }
 
 /* -------------------------------------------------------------------------- */
@@ -85,49 +227,150 @@ Server::~Server() {
 /**
  * @brief Boucle principale du serveur IRC.
  *
- * Gère les connexions et les communications avec les clients en utilisant `poll()`.
+ * Gère les connexions et les communications avec les clients via l'`EventLoop`.
  * - Attend des événements sur les sockets (nouvelle connexion ou message client).
+ * - Seuls les descripteurs prêts sont renvoyés : le coût d'un réveil ne dépend
+ *   pas du nombre de clients connectés.
  * - Accepte les nouvelles connexions lorsqu'un client tente de se connecter.
  * - Traite les messages des clients déjà connectés.
+ * - Écrit en fin d'itération, en un seul appel par client, toutes les réponses
+ *   produites pendant l'itération ; les files bloquées sont reprises quand
+ *   leur socket devient inscriptible.
+ * - Chaque client n'exécute qu'un budget de lignes par itération ; ceux qui
+ *   ont encore des lignes attendent leur tour dans la file des clients prêts
+ *   (round-robin), servie en début d'itération. L'attente est alors nulle.
+ * - Traite les timers échus ; l'attente ne dépasse jamais la prochaine
+ *   échéance de la roue de timers.
+ * - Supprime en fin d'itération les clients marqués pour déconnexion.
+ * - L'arrêt (SIGINT) et la mise à jour à chaud (SIGUSR2 ou UPGRADE) sont
+ *   faits en tête d'itération, hors de tout traitement de client.
  *
- * @throws EXIT_FAILURE en cas d'erreur sur `poll()`.
+ * @throws EXIT_FAILURE en cas d'erreur sur l'attente d'événements.
  */
 void Server::run() {
+    std::vector<IoEvent> events;
+
+    if (!reactors.empty()) {
+        runReactors();
+        return;
+    }
+
     while (true) {
-        for (size_t i = 0; i < pollFds.size(); ++i) {
-            if (pollFds[i].fd < 0) {
-                std::cerr << "❌ Erreur: pollFds[" << i << "].fd est invalide !\n";
-                pollFds.erase(pollFds.begin() + i);
-                i--;
-            }
-            pollFds[i].revents = 0;
-        }
-        
-        int ret = poll(pollFds.data(), pollFds.size(), -1);
+        handleRequests();
+        int ret = eventLoop->wait(events, nextWaitTimeout());
         if (ret < 0) {
+            if (errno == EINTR)
+                continue;
             exit(EXIT_FAILURE);
         }
-
-        for (size_t i = 0; i < pollFds.size(); ++i) {
-            if (pollFds[i].revents & POLLIN) {
-                if (pollFds[i].fd == serverSocket) {
-                    handleNewConnection();
-                } else {
-                    handleClientMessage(pollFds[i].fd);
-                }
+        timers.advance();
+        ++loopTurn;
+        runReadyClients();
+
+        for (size_t i = 0; i < events.size(); ++i) {
+            int fd = events[i].fd;
+            if (fd == serverSocket) {
+                handleNewConnection();
+                continue;
+            }
+            if (fd == wakePipe[0]) {
+                drainWakePipe();
+                continue;
+            }
+            if (metrics && metrics->owns(fd)) {
+                metrics->handleEvent(fd, events[i].events);
+                continue;
+            }
+            if (clients.find(fd)
+                && (events[i].events & (EVENT_READ | EVENT_ERROR))) {
+                handleClientMessage(fd);
+            }
+            if (clients.find(fd) && (events[i].events & EVENT_WRITE)) {
+                flushClient(fd);
             }
         }
+        runTimers();
+        reapClients();
+        flushOutput();
+        if (archive)
+            archive->publish();
     }
 }
 
+/**
+ * @brief Demande l'arrêt du serveur (SIGINT) ; il est fait en tête de la
+ * prochaine itération. Appelable depuis un gestionnaire de signal : seuls
+ * un drapeau et un octet dans le tube de réveil sont écrits.
+ */
+void Server::requestShutdown(int signum) {
+    shutdownRequested = signum;
+    wakeLoop();
+}
+
+/**
+ * @brief Traite, en tête d'itération, l'arrêt ou la mise à jour à chaud
+ * demandés par un signal ou une commande : aucune commande n'est alors en
+ * cours et les channels sont dans un état cohérent.
+ */
+void Server::handleRequests() {
+    if (shutdownRequested) {
+        LOG_INFO("🛑 Signal reçu (" << shutdownRequested << "), arrêt du serveur...");
+        shutdownServer();
+    }
+    if (upgradeRequested)
+        upgrade();
+}
+
+/**
+ * @brief Réveille la boucle principale si elle attend des événements
+ * (async-signal-safe : un signal reçu juste avant l'attente n'est pas
+ * perdu). Le tube plein suffit à la réveiller.
+ */
+void Server::wakeLoop() {
+    int savedErrno = errno;
+    char byte = 0;
+    ssize_t written = write(wakePipe[1], &byte, 1);
+    (void)written;
+    errno = savedErrno;
+}
+
+void Server::drainWakePipe() {
+    char buffer[64];
+    while (read(wakePipe[0], buffer, sizeof(buffer)) > 0) {}
+}
+
 void Server::shutdownServer() {
-    std::cout << "\n🛑 Arrêt du serveur IRC...\n";
+    LOG_INFO("🛑 Arrêt du serveur IRC...");
 
     std::string shutdownMsg = "ERROR :Server shutting down\r\n";
-    for (std::map<int, Client*>::iterator it = clients.begin(); it != clients.end(); ++it) {
-        send(it->first, shutdownMsg.c_str(), shutdownMsg.size(), 0);
-        close(it->first);
-        delete it->second;
+    if (!reactors.empty()) {
+        MessageBuffer farewell(shutdownMsg);
+        for (int fd = 0; fd < clients.limit(); ++fd) {
+            Client* client = clients.find(fd);
+            if (!client || !client->getReactor())
+                continue;
+            client->getReactor()->stageBatch(fd)->push(farewell, 0);
+            client->getReactor()->closeConnection(fd);
+        }
+        flushOutput();
+    }
+    stopReactors();
+
+    if (snapshot) {
+        snapshotChannels();
+        delete snapshot;
+        snapshot = NULL;
+    }
+
+    for (int fd = 0; fd < clients.limit(); ++fd) {
+        Client* client = clients.find(fd);
+        if (!client)
+            continue;
+        if (!client->getReactor()) {
+            send(fd, shutdownMsg.c_str(), shutdownMsg.size(), MSG_NOSIGNAL);
+            close(fd);
+        }
+        delete client;
     }
     clients.clear();
 
@@ -136,10 +379,14 @@ void Server::shutdownServer() {
     }
     channels.clear();
 
-    std::cout << "🔄 Nettoyage final des ressources...\n";
+    LOG_INFO("🔄 Nettoyage final des ressources...");
 
-    pollFds.clear();
-    std::vector<pollfd>().swap(pollFds);
+    delete metrics;
+    metrics = NULL;
+    delete archive;
+    archive = NULL;
+    delete eventLoop;
+    eventLoop = NULL;
 
     serverName = "";
     password = "";
@@ -147,147 +394,1328 @@ void Server::shutdownServer() {
     std::string().swap(password);
     std::string().swap(shutdownMsg);
     
-    close(serverSocket);
+    for (size_t i = 0; i < listenSockets.size(); ++i)
+        close(listenSockets[i]);
+    close(wakePipe[0]);
+    close(wakePipe[1]);
 
-    std::cout << "✅ Serveur IRC arrêté proprement.\n";
+    logPoolStats();
+    LOG_INFO("✅ Serveur IRC arrêté proprement.");
     exit(0);
 }
 
+/* -------------------------------------------------------------------------- */
+/*                                Mode multi-thread                           */
+/* -------------------------------------------------------------------------- */
+
+/**
+ * @brief Boucle principale en mode multi-thread (--threads=N).
+ *
+ * Les réacteurs font toutes les entrées/sorties réseau ; ce thread (le cœur)
+ * possède seul l'état IRC et ne fait qu'appliquer les événements reçus par
+ * sa boîte aux lettres, sans aucun verrou sur les clients ni les channels.
+ * Les réponses produites pendant l'itération sont confiées en fin
+ * d'itération au réacteur propriétaire, dans l'ordre de production.
+ *
+ * @throws EXIT_FAILURE si un réacteur ne peut pas démarrer.
+ */
+void Server::runReactors() {
+    std::vector<IoEvent> events;
+
+    for (size_t i = 0; i < reactors.size(); ++i) {
+        if (!reactors[i]->start()) {
+            perror("Erreur démarrage du réacteur");
+            exit(EXIT_FAILURE);
+        }
+    }
+
+    while (true) {
+        handleRequests();
+        int ret = eventLoop->wait(events, nextWaitTimeout());
+        if (ret < 0) {
+            if (errno == EINTR)
+                continue;
+            exit(EXIT_FAILURE);
+        }
+        timers.advance();
+        ++loopTurn;
+        runReadyClients();
+
+        bool woken = reactorBacklog;
+        for (size_t i = 0; i < events.size(); ++i) {
+            if (events[i].fd == reactorEvents.getWakeFd())
+                woken = true;
+            else if (events[i].fd == wakePipe[0])
+                drainWakePipe();
+            else if (metrics && metrics->owns(events[i].fd))
+                metrics->handleEvent(events[i].fd, events[i].events);
+        }
+        if (woken)
+            drainReactorEvents();
+        runTimers();
+        reapClients();
+        flushOutput();
+        if (archive)
+            archive->publish();
+    }
+}
+
+/**
+ * @brief Arrête et libère les réacteurs (sans effet en mode mono-thread).
+ */
+void Server::stopReactors() {
+    for (size_t i = 0; i < reactors.size(); ++i)
+        delete reactors[i];
+    reactors.clear();
+}
+
+/**
+ * @brief Applique les événements publiés par les réacteurs, au plus
+ * REACTOR_EVENTS_PER_TURN par itération : sous un flot continu, la file ne
+ * se vide jamais et les réponses déjà produites doivent tout de même partir
+ * en fin d'itération. Le reste est repris à l'itération suivante, sans
+ * attente.
+ */
+void Server::drainReactorEvents() {
+    ReactorEvent event;
+    size_t handled = 0;
+
+    reactorEvents.acknowledge();
+    reactorBacklog = false;
+    while (reactorEvents.pop(event)) {
+        handleReactorEvent(event);
+        if (++handled == REACTOR_EVENTS_PER_TURN) {
+            reactorBacklog = true;
+            return;
+        }
+    }
+}
+
+/**
+ * @brief Applique un événement d'un réacteur.
+ *
+ * Un événement n'est appliqué que si le client du fd appartient bien au
+ * réacteur émetteur : les lignes d'une connexion déjà fermée par le cœur
+ * sont ignorées. Une ligne hors budget ou refusée par le contrôle de flood
+ * attend dans la file du client sans être acquittée : au-delà de
+ * REACTOR_INFLIGHT_LINES, le réacteur cesse de lire le socket (et un client
+ * freiné par le contrôle de flood est déconnecté).
+ */
+void Server::handleReactorEvent(const ReactorEvent& event) {
+    if (event.type == ReactorEvent::CONNECTED) {
+        registerClient(event.fd, std::string(event.payload.data(), event.payload.size()),
+                       event.reactor, event.connection);
+        return;
+    }
+
+    Client* client = clients.find(event.fd);
+    if (!client || client->getReactor() != event.reactor)
+        return;
+
+    if (event.type == ReactorEvent::CLOSED) {
+        std::string reason(event.payload.data(), event.payload.size());
+        LOG_WARN("⚠️  Déconnexion du client " << event.fd << " : " << reason);
+        removeClient(event.fd, reason);
+        return;
+    }
+
+    if (event.type == ReactorEvent::LINE_TOO_LONG) {
+        std::string nick = client->getNickname().empty() ? "*" : client->getNickname();
+        sendToClient(event.fd, ":irc.42server.com 417 " + nick + " :Input line was too long\r\n");
+        return;
+    }
+
+    std::deque<MessageBuffer>& pending = client->getPendingLines();
+    ParsedLine parsed;
+    bool deferred = !client->isClosing() && (!pending.empty() || !hasInputBudget(client));
+    if (!client->isClosing() && !deferred) {
+        CommandHandler::parseLine(event.payload.data(), event.payload.size(), parsed);
+        deferred = !admitLine(client, parsed);
+    }
+    if (deferred) {
+        pending.push_back(event.payload);
+        if (!client->getFloodTimer().pending())
+            markReady(client);
+        else if (pending.size() >= REACTOR_INFLIGHT_LINES)
+            expireClient(event.fd, "Excess Flood");
+        return;
+    }
+
+    if (!client->isClosing()) {
+        spendInputBudget(client, event.payload.size());
+        executeLine(event.fd, event.payload.data(), event.payload.size(), parsed);
+    }
+    if (clients.find(event.fd) == client)
+        event.reactor->lineDone(event.connection);
+}
+
 /* -------------------------------------------------------------------------- */
 /*                                Gestion des Connexions                      */
 /* -------------------------------------------------------------------------- */
 
 /**
- * @brief Gère l'arrivée d'une nouvelle connexion client.
+ * @brief Gère l'arrivée de nouvelles connexions clients.
  *
- * - Accepte la connexion d'un nouveau client avec `accept()`.
+ * - Accepte les connexions en attente avec `accept()` jusqu'à EAGAIN
+ *   (nécessaire avec un backend edge-triggered).
  * - Affiche un message indiquant qu'un client s'est connecté.
- * - Ajoute le client à la liste des sockets surveillés par `poll()`.
+ * - Passe le socket en non bloquant et l'ajoute à l'`EventLoop`.
  * - Crée un nouvel objet `Client` pour stocker ses informations.
  *
- * @throws perror() si `accept()` échoue.
+ * Une erreur de `accept()` autre que EAGAIN est journalisée (LOG_ERROR).
+ */
+void Server::handleNewConnection() {
+    while (true) {
+        struct sockaddr_in clientAddr;
+        socklen_t clientAddrLen = sizeof(clientAddr);
+        int clientSocket = accept(serverSocket, (struct sockaddr *)&clientAddr, &clientAddrLen);
+
+        if (clientSocket < 0) {
+            if (errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR)
+                LOG_ERROR("❌ Erreur accept() : " << strerror(errno));
+            if (errno == EINTR)
+                continue;
+            return;
+        }
+
+        if (fcntl(clientSocket, F_SETFL, O_NONBLOCK) < 0 || !eventLoop->add(clientSocket, EVENT_READ)) {
+            LOG_ERROR("❌ Erreur configuration du socket client : " << strerror(errno));
+            close(clientSocket);
+            continue;
+        }
+
+        registerClient(clientSocket, inet_ntoa(clientAddr.sin_addr));
+    }
+}
+
+/**
+ * @brief Crée le `Client` d'un socket accepté et lui envoie le message d'accueil.
+ *
+ * Arme ses timers de PING et de délai d'enregistrement.
+ *
+ * @param reactor Réacteur propriétaire du socket (NULL en mode mono-thread).
+ */
+void Server::registerClient(int clientSocket, const std::string& address,
+                            Reactor* reactor, ReactorConnection* connection) {
+    LOG_INFO("🟢 Nouveau client connecté : " << address << " (fd: " << clientSocket << ")");
+
+    Client* client = new Client(clientSocket);
+    client->attachReactor(reactor, connection);
+    clients.insert(clientSocket, client);
+    Metrics::add(METRIC_CONNECTIONS, 1);
+
+    client->touch(timers.now());
+    timers.schedule(client->getPingTimer(), pingIntervalMs);
+    timers.schedule(client->getRegistrationTimer(), registerTimeoutMs);
+
+    std::string serverName = "irc.42server.com";
+    std::string welcomeMessage = ":" + serverName + " 001 * :Welcome to the Internet Relay Network\r\n";
+    sendToClient(clientSocket, welcomeMessage);
+}
+
+
+/**
+ * @brief Supprime un client du serveur.
+ *
+ * Seuls les channels rejoints par le client sont parcourus : le coût est
+ * O(channels du client), pas O(channels du serveur).
+ */
+void Server::removeClient(int clientSocket, const std::string& reason) {
+    if (!clients.find(clientSocket)) return;
+
+    Client *client = clients[clientSocket];
+
+    MessageBuffer quitMsg(":" + client->getNickname() + "!" + client->getUsername() +
+                          "@localhost QUIT :" + reason + "\r\n");
+    leaveAllChannels(clientSocket, quitMsg);
+
+    closeClientSocket(clientSocket);
+
+    LOG_INFO("🚪 Client " << clientSocket << " supprimé du serveur.");
+}
+
+/**
+ * @brief Retire le socket de l'`EventLoop`, le ferme et libère le client.
+ *
+ * Tente une dernière écriture non bloquante de la file d'envoi pour que
+ * les réponses finales (QUIT, erreurs) aient une chance d'arriver.
+ * En mode multi-thread, la fermeture suit les derniers lots dans la file de
+ * commandes du réacteur propriétaire du socket.
+ */
+void Server::closeClientSocket(int clientSocket) {
+    Client* client = clients[clientSocket];
+    SendQueue& output = client->getSendQueue();
+    if (!client->getNickname().empty())
+        nicknames.erase(client->getNickname());
+
+    if (client->getReactor()) {
+        client->getReactor()->closeConnection(clientSocket);
+    } else {
+        while (!output.empty() && output.writeTo(clientSocket) > 0) {}
+        eventLoop->remove(clientSocket);
+        close(clientSocket);
+    }
+    delete client;
+    clients.erase(clientSocket);
+    Metrics::add(METRIC_DISCONNECTIONS, 1);
+}
+
+/**
+ * @brief Retire un membre d'un channel.
+ *
+ * - Si le membre était opérateur, le premier membre restant le devient.
+ * - Le channel est supprimé s'il est vide, sauf s'il attend encore des
+ *   opérateurs restaurés d'un instantané.
+ */
+void Server::leaveChannel(Channel* channel, int clientSocket) {
+    bool wasOperator = channel->isOperator(clientSocket);
+    shareMembership(channel, clients[clientSocket], false);
+    channel->removeClient(clientSocket);
+
+    if (wasOperator && !channel->isEmpty()) {
+        channel->addOperator(channel->getClients().front().fd);
+    }
+    if (wasOperator)
+        markChannelDirty(channel);
+
+    if (channel->isEmpty() && !channel->hasSavedOperators()) {
+        markChannelDirty(channel);
+        channels.erase(channel->getName());
+        delete channel;
+    }
+}
+
+/**
+ * @brief Reporte une arrivée ou un départ sur la copie des membres du
+ * réacteur du client (mode multi-thread), celle que parcourt la diffusion.
+ */
+void Server::shareMembership(Channel* channel, Client* client, bool joined) {
+    Reactor* reactor = client->getReactor();
+    if (!reactor)
+        return;
+    if (joined) {
+        channel->addReactorMember(reactor->getId());
+        reactor->addMember(client->getSocketFd(), channel);
+    } else {
+        channel->removeReactorMember(reactor->getId());
+        reactor->removeMember(client->getSocketFd(), channel);
+    }
+}
+
+/**
+ * @brief Annonce un départ aux pairs du client (une fois chacun) puis le
+ * retire de tous ses channels.
+ *
+ * @param message Ligne QUIT envoyée aux autres membres.
+ */
+void Server::leaveAllChannels(int clientSocket, const MessageBuffer& message) {
+    broadcastToPeers(clients[clientSocket], message);
+    std::set<Channel*> joined = clients[clientSocket]->getChannels();
+    for (std::set<Channel*>::iterator it = joined.begin(); it != joined.end(); ++it)
+        leaveChannel(*it, clientSocket);
+}
+
+/**
+ * @brief Supprime les clients marqués pour déconnexion pendant l'itération.
+ *
+ * La suppression est différée pour ne pas invalider un client pendant un
+ * broadcast. Une suppression peut elle-même en marquer d'autres (QUIT qui
+ * dépasse leur SendQ), d'où la boucle jusqu'à épuisement.
+ */
+void Server::reapClients() {
+    while (!pendingDisconnects.empty()) {
+        int clientSocket = pendingDisconnects.back();
+        pendingDisconnects.pop_back();
+        if (!clients.find(clientSocket))
+            continue;
+        std::string reason = clients[clientSocket]->getCloseReason();
+        if (reason != CLIENT_QUIT_REASON)
+            LOG_WARN("⚠️  Déconnexion du client " << clientSocket << " : " << reason);
+        removeClient(clientSocket, reason);
+    }
+}
+
+/**
+ * @brief Ferme la connexion d'un client à l'initiative du serveur.
+ *
+ * Le client reçoit ERROR avant la fermeture ; la suppression est différée
+ * à `reapClients()` comme pour les autres déconnexions.
+ */
+void Server::expireClient(int clientSocket, const std::string& reason) {
+    Client* client = clients.find(clientSocket);
+    if (!client || client->isClosing())
+        return;
+    sendToClient(clientSocket, "ERROR :Closing Link: " + reason + "\r\n");
+    client->markClosing(reason);
+    pendingDisconnects.push_back(clientSocket);
+}
+
+/* -------------------------------------------------------------------------- */
+/*                                Timers                                      */
+/* -------------------------------------------------------------------------- */
+
+/**
+ * @brief Traite les timers échus depuis le dernier `advance()`.
+ */
+void Server::runTimers() {
+    while (Timer* timer = timers.popExpired())
+        handleTimer(*timer);
+}
+
+/**
+ * @brief Applique un timer échu. Les timers sont embarqués dans les
+ * clients : le client d'un timer échu existe toujours. Seul le timer des
+ * instantanés appartient au serveur.
+ */
+void Server::handleTimer(Timer& timer) {
+    if (&timer == &snapshotTimer) {
+        snapshotChannels();
+        timers.schedule(snapshotTimer, snapshotIntervalMs);
+        return;
+    }
+
+    Client* client = clients.find(timer.getOwner());
+    if (!client || client->isClosing())
+        return;
+
+    if (timer.getKind() == CLIENT_TIMER_REGISTRATION) {
+        if (!client->isFullyRegistered())
+            expireClient(timer.getOwner(), "Registration timeout");
+        return;
+    }
+    if (timer.getKind() == CLIENT_TIMER_FLOOD) {
+        resumeClient(client);
+        return;
+    }
+    handlePingTimer(client);
+}
+
+/**
+ * @brief Timer de PING d'un client.
+ *
+ * L'activité n'est pas suivie en réarmant le timer à chaque ligne : à
+ * l'échéance, on relit l'heure de la dernière ligne reçue.
+ * - Activité récente : le timer est réarmé pour le reste de l'intervalle.
+ * - Inactif depuis l'intervalle : envoi d'un PING, réponse attendue avant
+ *   le délai de PONG.
+ * - Aucune ligne depuis le PING : déconnexion (Ping timeout).
+ */
+void Server::handlePingTimer(Client* client) {
+    long now = timers.now();
+    long idle = now - client->getLastActivity();
+    int clientSocket = client->getSocketFd();
+
+    if (client->getPingSentAt() && client->getLastActivity() < client->getPingSentAt()) {
+        std::ostringstream reason;
+        reason << "Ping timeout: " << (now - client->getPingSentAt()) / 1000 << " seconds";
+        expireClient(clientSocket, reason.str());
+        return;
+    }
+    if (idle < pingIntervalMs) {
+        client->setPingSentAt(0);
+        timers.schedule(client->getPingTimer(), pingIntervalMs - idle);
+        return;
+    }
+    client->setPingSentAt(now);
+    sendToClient(clientSocket, "PING :irc.42server.com\r\n");
+    timers.schedule(client->getPingTimer(), pingTimeoutMs);
+}
+
+/* -------------------------------------------------------------------------- */
+/*                          Instantanés des channels                          */
+/* -------------------------------------------------------------------------- */
+
+/**
+ * @brief Recrée les channels de l'instantané (au démarrage).
+ *
+ * Le fichier est trié par nom : chaque channel est inséré en fin de map,
+ * en temps constant. Les channels restaurés sont vides ; leurs opérateurs
+ * sont gardés par pseudo jusqu'à leur retour.
+ */
+void Server::loadSnapshot() {
+    long started = TimerWheel::monotonicMs();
+    if (!snapshot->open()) {
+        perror("Erreur lecture de l'instantané");
+        exit(EXIT_FAILURE);
+    }
+    SnapshotChannel state;
+    while (snapshot->next(state)) {
+        Channel* channel = new Channel(state.name);
+        channel->setInviteOnly(state.flags & SNAPSHOT_INVITE_ONLY);
+        channel->setTopicRestricted(state.flags & SNAPSHOT_TOPIC_RESTRICTED);
+        channel->setUserLimit(state.userLimit);
+        channel->setPassword(state.key);
+        channel->setTopic(state.topic);
+        if (!state.operators.empty())
+            channel->setSavedOperators(state.operators);
+        channels.insert(channels.end(), std::map<std::string, Channel*>::value_type(state.name, channel));
+    }
+    LOG_INFO("💾 Snapshot : " << channels.size() << " channel(s) restauré(s) en "
+             << TimerWheel::monotonicMs() - started << " ms");
+}
+
+/**
+ * @brief Note un channel à inclure dans le prochain instantané (une seule
+ * fois par intervalle). À appeler après la modification, et avant la
+ * suppression pour un channel qui disparaît.
+ */
+void Server::markChannelDirty(Channel* channel) {
+    if (!snapshot || channel->isSnapshotDirty())
+        return;
+    channel->setSnapshotDirty(true);
+    dirtyChannels.push_back(channel->getName());
+}
+
+/**
+ * @brief Encode les channels modifiés depuis le dernier instantané et remet
+ * le delta au thread d'écriture.
+ *
+ * Un nom noté dont le channel n'existe plus devient une suppression ; un
+ * channel recréé sous le même nom n'est encodé qu'une fois.
+ */
+void Server::snapshotChannels() {
+    if (!snapshot || dirtyChannels.empty())
+        return;
+
+    SnapshotDelta* delta = new SnapshotDelta;
+    delta->reserve(dirtyChannels.size());
+    std::vector<std::string> operators;
+    for (size_t i = 0; i < dirtyChannels.size(); ++i) {
+        std::map<std::string, Channel*>::iterator it = channels.find(dirtyChannels[i]);
+        if (it != channels.end() && !it->second->isSnapshotDirty())
+            continue;
+        delta->push_back(SnapshotEntry());
+        delta->back().name = dirtyChannels[i];
+        if (it == channels.end())
+            continue;
+
+        Channel* channel = it->second;
+        channel->setSnapshotDirty(false);
+        operators = channel->getSavedOperators();
+        const MemberList& members = channel->getClients();
+        for (MemberList::const_iterator member = members.begin(); member != members.end(); ++member) {
+            if (member->modes & MEMBER_OP)
+                operators.push_back(member->client->getNickname());
+        }
+        unsigned int flags = (channel->getInviteOnly() ? SNAPSHOT_INVITE_ONLY : 0)
+                           | (channel->getTopicRestricted() ? SNAPSHOT_TOPIC_RESTRICTED : 0);
+        Snapshot::encode(delta->back().record, channel->getName(), flags, channel->getUserLimit(),
+                         channel->getPassword(), channel->getTopic(), operators);
+    }
+    LOG_DEBUG("💾 Snapshot : " << delta->size() << " channel(s) modifié(s)");
+    dirtyChannels.clear();
+    snapshot->publish(delta);
+}
+
+/* -------------------------------------------------------------------------- */
+/*                             Mise à jour à chaud                            */
+/* -------------------------------------------------------------------------- */
+
+/**
+ * @brief Demande une mise à jour à chaud ; elle est faite en tête de la
+ * prochaine itération de la boucle principale. Appelable depuis un
+ * gestionnaire de signal.
+ *
+ * @param clientSocket Le demandeur (commande UPGRADE), ou -1 (SIGUSR2).
+ */
+void Server::requestUpgrade(int clientSocket) {
+    upgradeRequester = clientSocket;
+    upgradeRequested = 1;
+    wakeLoop();
+}
+
+/**
+ * @brief Remplace le processus par une nouvelle instance du binaire sans
+ * couper les connexions.
+ *
+ * Le nouveau processus reçoit le socket d'écoute, ceux des clients et
+ * l'état sérialisé, puis confirme qu'il a tout repris : l'ancien se termine
+ * alors sans rien fermer ni envoyer. En cas d'échec, le fils est tué et
+ * l'ancien processus reprend son service comme si de rien n'était.
+ *
+ * Non disponible avec `--threads` : les sockets appartiennent aux réacteurs.
+ */
+void Server::upgrade() {
+    int requester = upgradeRequester;
+    upgradeRequested = 0;
+    upgradeRequester = -1;
+    std::string failure = "not supported with --threads";
+
+    if (reactors.empty()) {
+        long started = TimerWheel::monotonicMs();
+        LOG_INFO("🔄 Mise à jour à chaud : lancement de " << commandLine[0]);
+        flushOutput();
+        stopWriters();
+
+        int channel = -1;
+        pid_t child = Handoff::spawn(commandLine, channel);
+        if (child < 0) {
+            failure = std::string("cannot start new process: ") + strerror(errno);
+        } else {
+            std::string state;
+            std::vector<int> fds;
+            serializeState(state, fds);
+            if (Handoff::send(channel, fds, state) && Handoff::waitReady(channel, HANDOFF_TIMEOUT_MS)) {
+                LOG_INFO("✅ Mise à jour à chaud : " << fds.size() << " socket(s) et "
+                         << state.size() << " octets d'état remis au pid " << child << " en "
+                         << TimerWheel::monotonicMs() - started << " ms");
+                exit(0);
+            }
+            failure = "new process did not take over";
+            kill(child, SIGKILL);
+            waitpid(child, NULL, 0);
+            close(channel);
+        }
+        startWriters();
+    }
+
+    LOG_ERROR("❌ Mise à jour à chaud annulée : " << failure);
+    Client* client = (requester >= 0) ? clients.find(requester) : NULL;
+    if (client && !client->isClosing())
+        sendToClient(requester, ":irc.42server.com NOTICE " + client->getNickname()
+                                + " :Upgrade failed: " + failure + "\r\n");
+    flushOutput();
+}
+
+/**
+ * @brief Vide et arrête les threads d'écriture (instantané, archive) : le
+ * nouveau processus reprend des fichiers à jour.
+ */
+void Server::stopWriters() {
+    if (snapshot) {
+        snapshotChannels();
+        snapshot->stop();
+    }
+    if (archive)
+        archive->stop();
+}
+
+/**
+ * @brief Relance les threads d'écriture après une mise à jour annulée.
+ */
+void Server::startWriters() {
+    if (archive && !archive->start()) {
+        LOG_ERROR("❌ Archive : redémarrage impossible, archivage désactivé");
+        delete archive;
+        archive = NULL;
+    }
+    if (snapshot && !snapshot->start()) {
+        LOG_ERROR("❌ Snapshot : redémarrage impossible, instantanés désactivés");
+        delete snapshot;
+        snapshot = NULL;
+    }
+}
+
+/**
+ * @brief Sérialise les clients et les channels pour le nouveau processus.
+ *
+ * `fds` reçoit le socket d'écoute, celui des métriques s'il existe, puis
+ * celui de chaque client transmis, dans l'ordre de l'état : le nouveau
+ * processus retrouve un client par son rang. Les clients en cours de
+ * déconnexion ne sont pas transmis.
+ *
+ *   u8 métriques, u64 compteur des BATCH de CHATHISTORY
+ *   u32 clients, puis par client : pseudo, user, realname, u8 drapeaux,
+ *       bloc reçu non traité, bloc en attente d'envoi
+ *   u32 channels, puis par channel : nom, u8 drapeaux, u32 limite, clé,
+ *       topic, u32 + opérateurs en attente, u32 + (u32 rang, u8 modes) des
+ *       membres, u32 + rangs des invités, u32 + (u64 msgid, u64 heure,
+ *       bloc ligne) de l'historique
+ */
+void Server::serializeState(std::string& state, std::vector<int>& fds) {
+    std::vector<long> rank(clients.limit(), -1);
+    std::vector<Client*> handed;
+    for (int fd = 0; fd < clients.limit(); ++fd) {
+        Client* client = clients.find(fd);
+        if (!client || client->isClosing())
+            continue;
+        rank[fd] = handed.size();
+        handed.push_back(client);
+    }
+
+    fds.push_back(serverSocket);
+    ArchiveFormat::putInt(state, metrics ? 1 : 0, 1);
+    if (metrics)
+        fds.push_back(metrics->getListenSocket());
+    ArchiveFormat::putInt(state, historyBatch, 8);
+
+    std::string output;
+    ArchiveFormat::putInt(state, handed.size(), 4);
+    for (size_t i = 0; i < handed.size(); ++i) {
+        Client* client = handed[i];
+        fds.push_back(client->getSocketFd());
+        ArchiveFormat::putField(state, client->getNickname());
+        ArchiveFormat::putField(state, client->getUsername());
+        ArchiveFormat::putField(state, client->getRealname());
+        unsigned int flags = (client->isAuthenticated() ? HANDOFF_AUTHENTICATED : 0)
+                           | (client->isServerOperator() ? HANDOFF_SERVER_OPERATOR : 0);
+        ArchiveFormat::putInt(state, flags, 1);
+        RecvBuffer& input = client->getRecvBuffer();
+        Handoff::putBytes(state, input.peek(), input.size());
+        output.clear();
+        client->getSendQueue().copyTo(output);
+        Handoff::putBytes(state, output.data(), output.size());
+    }
+
+    ArchiveFormat::putInt(state, channels.size(), 4);
+    for (std::map<std::string, Channel*>::iterator it = channels.begin(); it != channels.end(); ++it) {
+        Channel* channel = it->second;
+        unsigned int flags = (channel->getInviteOnly() ? SNAPSHOT_INVITE_ONLY : 0)
+                           | (channel->getTopicRestricted() ? SNAPSHOT_TOPIC_RESTRICTED : 0);
+        ArchiveFormat::putField(state, channel->getName());
+        ArchiveFormat::putInt(state, flags, 1);
+        ArchiveFormat::putInt(state, static_cast<unsigned long>(channel->getUserLimit()), 4);
+        ArchiveFormat::putField(state, channel->getPassword());
+        ArchiveFormat::putField(state, channel->getTopic());
+
+        const std::vector<std::string>& saved = channel->getSavedOperators();
+        ArchiveFormat::putInt(state, saved.size(), 4);
+        for (size_t i = 0; i < saved.size(); ++i)
+            ArchiveFormat::putField(state, saved[i]);
+
+        const MemberList& members = channel->getClients();
+        size_t count = 0;
+        for (MemberList::const_iterator member = members.begin(); member != members.end(); ++member)
+            count += (rank[member->fd] >= 0);
+        ArchiveFormat::putInt(state, count, 4);
+        for (MemberList::const_iterator member = members.begin(); member != members.end(); ++member) {
+            if (rank[member->fd] < 0)
+                continue;
+            ArchiveFormat::putInt(state, rank[member->fd], 4);
+            ArchiveFormat::putInt(state, member->modes, 1);
+        }
+
+        const std::set<int>& invited = channel->getInvitations();
+        count = 0;
+        for (std::set<int>::const_iterator fd = invited.begin(); fd != invited.end(); ++fd)
+            count += (*fd < clients.limit() && rank[*fd] >= 0);
+        ArchiveFormat::putInt(state, count, 4);
+        for (std::set<int>::const_iterator fd = invited.begin(); fd != invited.end(); ++fd) {
+            if (*fd < clients.limit() && rank[*fd] >= 0)
+                ArchiveFormat::putInt(state, rank[*fd], 4);
+        }
+
+        const ChannelHistory& log = channel->getHistory();
+        ArchiveFormat::putInt(state, log.size(), 4);
+        for (size_t i = 0; i < log.size(); ++i) {
+            const HistoryEntry& entry = log.at(i);
+            std::string line = log.line(entry);
+            ArchiveFormat::putInt(state, entry.msgid, 8);
+            ArchiveFormat::putInt(state, static_cast<unsigned long>(entry.time), 8);
+            Handoff::putBytes(state, line.data(), line.size());
+        }
+    }
+}
+
+/**
+ * @brief Reprend l'état de l'ancien processus (voir `serializeState()`).
+ *
+ * Chaque client retrouve ses timers, ce qu'il restait à traiter de son
+ * tampon de réception (repris au premier tour de boucle) et sa file
+ * d'envoi. Le contrôle de flood repart d'un seau plein.
+ *
+ * @return false si l'état est tronqué ou ne correspond pas aux descripteurs.
+ */
+bool Server::restoreState(const std::string& state, const std::vector<int>& fds) {
+    HandoffReader reader(state);
+    size_t next = 1;
+
+    if (reader.readInt(1)) {
+        if (next >= fds.size())
+            return false;
+        int socket = fds[next++];
+        if (!metrics)
+            close(socket);
+        else if (!metrics->adopt(socket))
+            return false;
+    }
+    historyBatch = reader.readInt(8);
+
+    std::vector<Client*> restored;
+    size_t clientCount = reader.readInt(4);
+    for (size_t i = 0; i < clientCount && reader.ok(); ++i) {
+        if (next >= fds.size())
+            return false;
+        int fd = fds[next++];
+        Client* client = new Client(fd);
+        std::string nick = reader.readField();
+        client->setNickname(nick);
+        client->setUsername(reader.readField());
+        client->setRealname(reader.readField());
+        unsigned int flags = reader.readInt(1);
+        std::string input = reader.readBytes();
+        std::string output = reader.readBytes();
+        if (flags & HANDOFF_AUTHENTICATED)
+            client->authenticate();
+        client->setServerOperator(flags & HANDOFF_SERVER_OPERATOR);
+
+        clients.insert(fd, client);
+        restored.push_back(client);
+        if (!nick.empty())
+            nicknames.insert(nick, client);
+        if (!eventLoop->add(fd, EVENT_READ))
+            expireClient(fd, "Upgrade failed");
+
+        client->touch(timers.now());
+        timers.schedule(client->getPingTimer(), pingIntervalMs);
+        if (!client->isFullyRegistered())
+            timers.schedule(client->getRegistrationTimer(), registerTimeoutMs);
+
+        RecvBuffer& buffer = client->getRecvBuffer();
+        size_t room = buffer.prepareWrite();
+        size_t length = input.size() < room ? input.size() : room;
+        if (length > 0) {
+            std::memcpy(buffer.writePtr(), input.data(), length);
+            buffer.commit(length);
+            client->getInputBudget().stalled = true;
+            markReady(client);
+        }
+        if (!output.empty())
+            sendToClient(fd, MessageBuffer(output));
+    }
+
+    size_t channelCount = reader.readInt(4);
+    for (size_t i = 0; i < channelCount && reader.ok(); ++i) {
+        std::string name = reader.readField();
+        Channel* channel = new Channel(name);
+        channels.insert(channels.end(), std::map<std::string, Channel*>::value_type(name, channel));
+
+        unsigned int flags = reader.readInt(1);
+        channel->setInviteOnly(flags & SNAPSHOT_INVITE_ONLY);
+        channel->setTopicRestricted(flags & SNAPSHOT_TOPIC_RESTRICTED);
+        channel->setUserLimit(static_cast<int>(reader.readInt(4)));
+        channel->setPassword(reader.readField());
+        channel->setTopic(reader.readField());
+
+        std::vector<std::string> saved;
+        size_t count = reader.readInt(4);
+        for (size_t j = 0; j < count && reader.ok(); ++j)
+            saved.push_back(reader.readField());
+        if (!saved.empty())
+            channel->setSavedOperators(saved);
+
+        count = reader.readInt(4);
+        for (size_t j = 0; j < count && reader.ok(); ++j) {
+            size_t index = reader.readInt(4);
+            unsigned int modes = reader.readInt(1);
+            if (index >= restored.size())
+                return false;
+            channel->addClient(restored[index]);
+            if (modes)
+                channel->setMemberMode(restored[index]->getSocketFd(), modes, true);
+        }
+
+        count = reader.readInt(4);
+        for (size_t j = 0; j < count && reader.ok(); ++j) {
+            size_t index = reader.readInt(4);
+            if (index >= restored.size())
+                return false;
+            channel->inviteClient(restored[index]->getSocketFd());
+        }
+
+        count = reader.readInt(4);
+        for (size_t j = 0; j < count && reader.ok(); ++j) {
+            unsigned long msgid = reader.readInt(8);
+            long time = static_cast<long>(reader.readInt(8));
+            history.append(channel->getHistory(), reader.readBytes(), time, msgid);
+        }
+    }
+    return reader.ok() && reader.atEnd() && next == fds.size();
+}
+
+/**
+ * @brief Gère la commande UPGRADE (réservée aux opérateurs du serveur).
+ *
+ * La mise à jour est faite en tête de la prochaine itération ; le
+ * demandeur reçoit une seconde NOTICE si elle échoue.
+ */
+void Server::handleUpgrade(int clientSocket) {
+    std::string nick = clients[clientSocket]->getNickname();
+    std::string prefix = ":irc.42server.com ";
+
+    if (!clients[clientSocket]->isServerOperator()) {
+        sendToClient(clientSocket, prefix + "481 " + nick + " :Permission Denied- You're not an IRC operator\r\n");
+        return;
+    }
+    LOG_INFO("🔄 Mise à jour à chaud demandée par " << nick);
+    sendToClient(clientSocket, prefix + "NOTICE " + nick + " :Upgrading server\r\n");
+    requestUpgrade(clientSocket);
+}
+
+/* -------------------------------------------------------------------------- */
+/*                                Gestion des Messages                        */
+/* -------------------------------------------------------------------------- */
+
+/**
+ * @brief Ajoute un message à la file d'envoi d'un client.
+ *
+ * Aucune écriture n'est faite ici : un client dont la file était vide est
+ * noté une fois dans `dirtyClients`, et toutes les réponses de l'itération
+ * partent ensemble dans `flushOutput()`. Si la file dépasse la limite de
+ * SendQ, le client est marqué pour déconnexion.
+ *
+ * En multi-thread, le message va dans le lot ouvert pour le client dans la
+ * file de commandes de son réacteur ; un nouveau lot n'est ouvert qu'après
+ * une diffusion, pour garder l'ordre produit par le cœur.
+ *
+ * @param clientSocket Le descripteur du destinataire.
+ * @param message La ligne IRC complète (terminée par CRLF), partagée sans copie.
+ */
+void Server::sendToClient(int clientSocket, const MessageBuffer& message) {
+    Client* client = clients.find(clientSocket);
+    if (!client || client->isClosing())
+        return;
+
+    Reactor* reactor = client->getReactor();
+    if (reactor) {
+        SendQueue* batch = client->getStagedBatch(reactor->getOutboxEpoch());
+        if (!batch) {
+            batch = reactor->stageBatch(clientSocket);
+            client->setStagedBatch(batch, reactor->getOutboxEpoch());
+        }
+        if (!batch->push(message, sendQueueLimit)) {
+            client->markClosing("SendQ exceeded");
+            pendingDisconnects.push_back(clientSocket);
+            return;
+        }
+        Metrics::add(METRIC_MESSAGES_QUEUED, 1);
+        return;
+    }
+
+    SendQueue& output = client->getSendQueue();
+    bool wasIdle = output.empty();
+    if (!output.push(message, sendQueueLimit)) {
+        client->markClosing("SendQ exceeded");
+        pendingDisconnects.push_back(clientSocket);
+        return;
+    }
+    Metrics::add(METRIC_MESSAGES_QUEUED, 1);
+    if (wasIdle)
+        dirtyClients.push_back(clientSocket);
+}
+
+/**
+ * @brief Variante pour les réponses destinées à un seul client.
+ */
+void Server::sendToClient(int clientSocket, const std::string& message) {
+    sendToClient(clientSocket, MessageBuffer(message));
+}
+
+/**
+ * @brief Écrit la file d'envoi d'un client jusqu'à EAGAIN.
+ *
+ * Chaque appel système emporte jusqu'à SEND_IOV_MAX messages (`writeTo()`).
+ * Le socket n'est surveillé en écriture que tant que la file est bloquée
+ * par EAGAIN.
+ */
+void Server::flushClient(int clientSocket) {
+    Client* client = clients[clientSocket];
+    SendQueue& output = client->getSendQueue();
+
+    while (!output.empty()) {
+        long start = Metrics::now();
+        ssize_t sent = output.writeTo(clientSocket);
+        Metrics::recordTime(TIMER_SEND, Metrics::now() - start);
+        Metrics::add(METRIC_SEND_CALLS, 1);
+        if (sent < 0) {
+            if (errno == EAGAIN || errno == EWOULDBLOCK) {
+                if (!client->isWriteArmed()) {
+                    eventLoop->modify(clientSocket, EVENT_READ | EVENT_WRITE);
+                    client->setWriteArmed(true);
+                }
+                return;
+            }
+            if (errno == EINTR)
+                continue;
+            client->markClosing("Write error");
+            pendingDisconnects.push_back(clientSocket);
+            return;
+        }
+        Metrics::add(METRIC_BYTES_SENT, sent);
+    }
+    if (client->isWriteArmed()) {
+        eventLoop->modify(clientSocket, EVENT_READ);
+        client->setWriteArmed(false);
+    }
+}
+
+/**
+ * @brief Envoie en fin d'itération les files remplies pendant l'itération.
+ *
+ * Un client n'est servi qu'une fois, quel que soit le nombre de réponses
+ * et de broadcasts qui lui sont destinés : en mono-thread, un seul
+ * `sendmsg()` (tant que la file tient dans SEND_IOV_MAX messages) ; en
+ * multi-thread, les commandes préparées pour chaque réacteur lui sont
+ * confiées dans l'ordre, avec un seul réveil.
+ */
+void Server::flushOutput() {
+    for (size_t i = 0; i < reactors.size(); ++i)
+        reactors[i]->flushQueued();
+    for (size_t i = 0; i < dirtyClients.size(); ++i) {
+        Client* client = clients.find(dirtyClients[i]);
+        if (client && !client->getSendQueue().empty())
+            flushClient(dirtyClients[i]);
+    }
+    dirtyClients.clear();
+}
+
+/**
+ * @brief Met un message dans la file d'envoi de chaque membre d'un channel.
+ *
+ * Le message est encodé une seule fois par l'appelant : chaque file ne reçoit
+ * qu'une référence, la mémoire reste O(1) quel que soit le nombre de membres.
+ *
+ * En multi-thread, le cœur ne parcourt pas les membres : il confie le
+ * message aux seuls réacteurs qui en servent (FANOUT), chacun remplissant
+ * les files de ses connexions. Le FANOUT suit dans la file de commandes du
+ * réacteur les lots déjà préparés pendant l'itération et ferme ceux-ci :
+ * chaque client reçoit tout dans l'ordre où le cœur l'a produit, sans
+ * envoi anticipé.
+ *
+ * @param excludeSocket Membre à ne pas servir (-1 pour aucun).
+ */
+void Server::broadcast(Channel* channel, const MessageBuffer& message, int excludeSocket) {
+    if (!reactors.empty()) {
+        const std::vector<unsigned int>& shards = channel->getReactorMembers();
+        for (size_t i = 0; i < shards.size(); ++i) {
+            if (shards[i] > 0)
+                reactors[i]->fanout(channel, message, excludeSocket);
+        }
+        return;
+    }
+
+    const MemberList& members = channel->getClients();
+    for (MemberList::const_iterator it = members.begin(); it != members.end(); ++it) {
+        if (it->fd != excludeSocket) {
+            sendToClient(it->fd, message);
+        }
+    }
+}
+
+
+/**
+ * @brief Met un message dans la file de chaque pair du client (membre d'au
+ * moins un de ses channels), une seule fois par pair.
+ *
+ * Les pairs déjà servis sont reconnus à leur marque de visite : une époque
+ * neuve par appel, sans ensemble temporaire. Le client lui-même est marqué
+ * d'entrée et n'est donc pas servi.
+ */
+void Server::broadcastToPeers(Client* client, const MessageBuffer& message) {
+    unsigned long epoch = ++visitEpoch;
+    client->visit(epoch);
+
+    const std::set<Channel*>& joined = client->getChannels();
+    for (std::set<Channel*>::const_iterator channel = joined.begin(); channel != joined.end(); ++channel) {
+        const MemberList& members = (*channel)->getClients();
+        for (MemberList::const_iterator it = members.begin(); it != members.end(); ++it) {
+            if (it->client->visit(epoch))
+                sendToClient(it->fd, message);
+        }
+    }
+}
+
+/**
+ * @brief Envoie la liste des membres d'un channel (RPL_NAMREPLY 353) puis
+ * RPL_ENDOFNAMES (366).
+ *
+ * La liste est découpée en lignes de IRC_LINE_MAX octets au plus (CRLF
+ * compris), chacune poussée dans la file du client dès qu'elle est pleine :
+ * la mémoire reste bornée à une ligne quel que soit le nombre de membres.
+ * Le préfixe de statut vient de l'entrée du membre (pas de recherche).
+ */
+void Server::sendNames(int clientSocket, Channel* channel) {
+    std::string nick = clients[clientSocket]->getNickname();
+    std::string prefix = ":irc.42server.com 353 " + nick + " = " + channel->getName() + " :";
+    std::string line;
+    line.reserve(IRC_LINE_MAX);
+    line = prefix;
+
+    const MemberList& members = channel->getClients();
+    for (MemberList::const_iterator it = members.begin(); it != members.end(); ++it) {
+        const std::string& name = it->client->getNickname();
+        size_t width = name.size() + (it->prefix ? 1 : 0);
+        if (line.size() > prefix.size() && line.size() + 1 + width + 2 > IRC_LINE_MAX) {
+            line += "\r\n";
+            sendToClient(clientSocket, MessageBuffer(line));
+            line = prefix;
+        }
+        if (line.size() > prefix.size())
+            line += ' ';
+        if (it->prefix)
+            line += it->prefix;
+        line += name;
+    }
+    if (line.size() > prefix.size()) {
+        line += "\r\n";
+        sendToClient(clientSocket, MessageBuffer(line));
+    }
+    sendToClient(clientSocket, ":irc.42server.com 366 " + nick + " " + channel->getName() + " :End of NAMES list\r\n");
+}
+
+/**
+ * @brief Gère la réception des messages d'un client.
+ *
+ * - Lit directement dans le tampon de réception du client avec `recv()`,
+ *   autant que la place le permet, jusqu'à EAGAIN.
+ * - Si le client se déconnecte (`bytesRead == 0`) ou en cas d'erreur, il est
+ *   supprimé de la liste des clients et de l'`EventLoop`.
+ * - Exécute les commandes complètes après chaque lecture, dans la limite du
+ *   budget de l'itération ; à la fermeture, les lignes restantes sont
+ *   exécutées avant la suppression du client.
+ * - Tampon plein : si le client est freiné par le contrôle de flood, il est
+ *   déconnecté (Excess Flood) ; sinon la lecture est suspendue jusqu'à son
+ *   prochain tour dans la file des clients prêts.
+ *
+ * @param clientSocket Le descripteur de fichier du client envoyant le message.
  */
-void Server::handleNewConnection() {
-    struct sockaddr_in clientAddr;
-    socklen_t clientAddrLen = sizeof(clientAddr);
-    int clientSocket = accept(serverSocket, (struct sockaddr *)&clientAddr, &clientAddrLen);
+void Server::handleClientMessage(int clientSocket) {
+    Client* client = clients[clientSocket];
+    RecvBuffer& input = client->getRecvBuffer();
+
+    client->getInputBudget().stalled = false;
+    while (!client->isClosing()) {
+        size_t room = input.prepareWrite();
+        if (room == 0) {
+            if (client->getFloodTimer().pending())
+                expireClient(clientSocket, "Excess Flood");
+            else
+                client->getInputBudget().stalled = true;
+            return;
+        }
 
-    if (clientSocket < 0) {
-        perror("❌ Erreur accept()");
-        return;
-    }
+        long start = Metrics::now();
+        ssize_t bytesRead = recv(clientSocket, input.writePtr(), room, 0);
+        Metrics::recordTime(TIMER_RECV, Metrics::now() - start);
+        Metrics::add(METRIC_RECV_CALLS, 1);
+
+        if (bytesRead < 0) {
+            if (errno == EAGAIN || errno == EWOULDBLOCK)
+                return;
+            if (errno == EINTR)
+                continue;
+            removeClient(clientSocket);
+            return;
+        }
 
-    std::cout << "🟢 Nouveau client connecté : " << inet_ntoa(clientAddr.sin_addr) << " (fd: " << clientSocket << ")" << std::endl;
+        if (bytesRead == 0) {
+            if (!processClientLines(clientSocket, false))
+                return;
+            if (!input.empty()) {
+                LOG_DEBUG("Partial command received (without CRLF): [" << LogBytes(input.peek(), input.size()) << "]");
+            }
+            removeClient(clientSocket);
+            return;
+        }
 
-    struct pollfd clientPollFd;
-    clientPollFd.fd = clientSocket;
-    clientPollFd.events = POLLIN;
-    clientPollFd.revents = 0;
+        LOG_DEBUG("📩 Message reçu de " << clientSocket << " : " << LogBytes(input.writePtr(), bytesRead));
+        Metrics::add(METRIC_BYTES_RECEIVED, bytesRead);
+        input.commit(bytesRead);
 
-    pollFds.push_back(clientPollFd);
-    
-    clients[clientSocket] = new Client(clientSocket);
-    if (!clients[clientSocket]) {
-        std::cerr << "❌ Erreur : Impossible d'allouer un Client pour fd " << clientSocket << std::endl;
-        close(clientSocket);
-        return;
+        if (!processClientLines(clientSocket))
+            return;
     }
-    
-    std::string serverName = "irc.42server.com";
-    std::string welcomeMessage = ":" + serverName + " 001 * :Welcome to the Internet Relay Network\r\n";
-    send(clientSocket, welcomeMessage.c_str(), welcomeMessage.length(), 0);
 }
 
-
 /**
- * @brief Supprime un client du serveur.
+ * @brief Exécute toutes les lignes complètes du tampon de réception.
+ *
+ * Les lignes sont passées au CommandHandler sous forme de pointeurs dans le
+ * tampon, sans copie. Une ligne trop longue reçoit ERR_INPUTTOOLONG (417).
+ * Une ligne refusée par le contrôle de flood reste dans le tampon, avec les
+ * suivantes, jusqu'à la reprise du client par son timer de flood. Une ligne
+ * hors budget y reste aussi, et le client est mis dans la file des clients
+ * prêts.
+ *
+ * @param budgeted false pour ignorer le budget de l'itération (fermeture).
+ * Aucune commande ne libère le client pendant le lot : QUIT et un mauvais
+ * PASS le marquent pour déconnexion, la suppression est faite par
+ * `reapClients()`.
+ *
+ * @return false si le client a été marqué pour déconnexion.
  */
-void Server::removeClient(int clientSocket) {
-    if (clients.find(clientSocket) == clients.end()) return;
+bool Server::processClientLines(int clientSocket, bool budgeted) {
+    Client* client = clients[clientSocket];
+    RecvBuffer& input = client->getRecvBuffer();
+    const char* line;
+    size_t length;
 
-    Client *client = clients[clientSocket];
+    while (true) {
+        RecvBuffer::LineStatus status = input.nextLine(line, length);
+        if (status == RecvBuffer::LINE_NONE) {
+            if (client->getInputBudget().stalled)
+                markReady(client);
+            return true;
+        }
+        if (status == RecvBuffer::LINE_TOO_LONG) {
+            std::string nick = client->getNickname().empty() ? "*" : client->getNickname();
+            sendToClient(clientSocket, ":irc.42server.com 417 " + nick + " :Input line was too long\r\n");
+            continue;
+        }
 
-    if (!client->getNickname().empty()) {
-        std::string quitMsg = ":" + client->getNickname() + "!" + client->getUsername() +
-                            "@localhost QUIT :Client disconnected\r\n";
-
-        for (std::map<std::string, Channel*>::iterator it = channels.begin(); it != channels.end(); ++it) {
-            Channel* channel = it->second;
-            if (channel->isClientInChannel(clientSocket)) {
-                channel->broadcast(quitMsg, clientSocket);
-                channel->removeClient(clientSocket);
-                if (channel->isOperator(clientSocket)) {
-                    channel->removeOperator(clientSocket);
-                    if (!channel->isEmpty()) {
-                        int newOp = *channel->getClients().begin();
-                        channel->addOperator(newOp);
-                    }
-                }
-            }
+        if (budgeted && !hasInputBudget(client)) {
+            input.unread(line);
+            markReady(client);
+            return true;
+        }
+        ParsedLine parsed;
+        CommandHandler::parseLine(line, length, parsed);
+        if (!admitLine(client, parsed)) {
+            input.unread(line);
+            return true;
         }
+        spendInputBudget(client, length);
+        executeLine(clientSocket, line, length, parsed);
+        if (client->isClosing())
+            return false;
     }
-
-    close(clientSocket);
-    delete clients[clientSocket];
-    clients.erase(clientSocket);
-
-    std::cout << "🚪 Client " << clientSocket << " supprimé du serveur.\n";
 }
 
-/* -------------------------------------------------------------------------- */
-/*                                Gestion des Messages                        */
-/* -------------------------------------------------------------------------- */
+/**
+ * @brief Exécute une ligne complète (sans CRLF) reçue d'un client, déjà
+ * découpée pour le contrôle de flood (`CommandHandler::parseLine`).
+ */
+void Server::executeLine(int clientSocket, const char* line, size_t length, const ParsedLine& parsed) {
+    LOG_DEBUG("🔍 Commande complète extraite : [" << LogBytes(line, length) << "]");
+    Metrics::add(METRIC_LINES_RECEIVED, 1);
+    if (Client* client = clients.find(clientSocket))
+        client->touch(timers.now());
+    commandHandler.handleCommand(clientSocket, parsed);
+}
 
 
 /**
- * @brief Gère la réception d'un message d'un client.
+ * @brief Contrôle de flood : la ligne peut-elle être exécutée maintenant ?
  *
- * - Lit les données envoyées par le client avec `recv()`.
- * - Si le client se déconnecte (`bytesRead <= 0`), il est supprimé de la liste des clients.
- * - Affiche le message reçu dans la console.
- * - (Prévu pour être étendu avec un parseur de commandes IRC).
+ * Le coût de la commande (table de dispatch) est prélevé sur le seau à
+ * jetons du client. S'il n'y en a pas assez, le timer de flood est armé
+ * pour l'instant où il y en aura, et plus aucune ligne du client n'est
+ * admise d'ici là : l'ordre des commandes est conservé.
+ */
+bool Server::admitLine(Client* client, const ParsedLine& parsed) {
+    if (floodRate == 0)
+        return true;
+    if (client->getFloodTimer().pending())
+        return false;
+
+    unsigned int cost = parsed.cost();
+    if (cost == 0)
+        return true;
+    long wait = client->getFloodBucket().take(timers.now(), cost, floodRate, floodBurst);
+    if (wait == 0)
+        return true;
+
+    Metrics::add(METRIC_FLOOD_THROTTLES, 1);
+    timers.schedule(client->getFloodTimer(), wait);
+    return false;
+}
+
+/**
+ * @brief Reprend l'exécution des lignes d'un client freiné (contrôle de
+ * flood) ou mis en attente (budget), dans la limite de ses jetons et de son
+ * budget.
  *
- * @param clientSocket Le descripteur de fichier du client envoyant le message.
+ * En mono-thread, les lignes sont relues dans le tampon de réception (et la
+ * lecture du socket reprend si elle était suspendue) ; en multi-thread,
+ * dans la file du client, chaque ligne exécutée étant acquittée auprès du
+ * réacteur (qui reprend la lecture si elle était suspendue).
  */
-void Server::handleClientMessage(int clientSocket) {
-    char buffer[512];
-    memset(buffer, 0, sizeof(buffer));
-    int bytesRead = recv(clientSocket, buffer, sizeof(buffer) - 1, 0);
+void Server::resumeClient(Client* client) {
+    int clientSocket = client->getSocketFd();
 
-    if (bytesRead < 0) {
-        removeClient(clientSocket);
+    if (!client->getReactor()) {
+        if (!processClientLines(clientSocket))
+            return;
+        if (client->getInputBudget().stalled && !client->getFloodTimer().pending()
+            && hasInputBudget(client))
+            handleClientMessage(clientSocket);
         return;
     }
-    
-    if (bytesRead == 0) {
-        Client* client = clients[clientSocket];
-        if (!client->getBufferRef().empty()) {
-            std::string leftover = client->getBufferRef();
-            std::cout << "Partial command received (without CRLF): [" << leftover << "]\n";
-            std::string echoMsg = ":irc.42server.com NOTICE * :" + leftover + "\r\n";
-            send(clientSocket, echoMsg.c_str(), echoMsg.size(), 0);
+
+    std::deque<MessageBuffer>& pending = client->getPendingLines();
+    while (!pending.empty() && !client->isClosing()) {
+        MessageBuffer line = pending.front();
+        if (!hasInputBudget(client)) {
+            markReady(client);
             return;
         }
-        removeClient(clientSocket);
-        return;
+        ParsedLine parsed;
+        CommandHandler::parseLine(line.data(), line.size(), parsed);
+        if (!admitLine(client, parsed))
+            return;
+        spendInputBudget(client, line.size());
+        pending.pop_front();
+        Reactor* reactor = client->getReactor();
+        ReactorConnection* connection = client->getConnection();
+        executeLine(clientSocket, line.data(), line.size(), parsed);
+        if (client->isClosing())
+            return;
+        reactor->lineDone(connection);
     }
+}
 
-    buffer[bytesRead] = '\0';
-    Client* client = clients[clientSocket];
-    client->appendToBuffer(buffer, bytesRead);
+/**
+ * @brief Reste-t-il du budget au client pour cette itération ?
+ *
+ * Le budget (INPUT_BUDGET_LINES lignes ou INPUT_BUDGET_BYTES octets) est
+ * remis à zéro paresseusement au premier passage de chaque itération.
+ */
+bool Server::hasInputBudget(Client* client) {
+    InputBudget& budget = client->getInputBudget();
+    budget.refresh(loopTurn);
+    return budget.lines < INPUT_BUDGET_LINES && budget.bytes < INPUT_BUDGET_BYTES;
+}
 
-    std::cout << "📩 Message reçu de " << clientSocket << " : " << buffer << std::endl;
+void Server::spendInputBudget(Client* client, size_t length) {
+    InputBudget& budget = client->getInputBudget();
+    budget.refresh(loopTurn);
+    ++budget.lines;
+    budget.bytes += length;
+}
 
-    std::string message;
-    while ((message = client->extractNextMessage()) != "") {
-        if (!message.empty() && message[0] == '/') {
-            message.erase(0, 1);
-        }
-        std::cout << "🔍 Commande complète extraite : [" << message << "]\n";
-        commandHandler.handleCommand(clientSocket, message);
+/**
+ * @brief Met un client dans la file des clients prêts (une seule fois).
+ */
+void Server::markReady(Client* client) {
+    InputBudget& budget = client->getInputBudget();
+    if (budget.queued)
+        return;
+    budget.queued = true;
+    readyClients.push_back(client->getSocketFd());
+}
+
+/**
+ * @brief Donne un tour à chaque client de la file des clients prêts.
+ *
+ * Seuls les clients présents au début du passage sont servis : un client
+ * qui dépasse encore son budget repasse en fin de file pour l'itération
+ * suivante (round-robin). Une entrée dont le client a été supprimé est
+ * ignorée.
+ */
+void Server::runReadyClients() {
+    for (size_t count = readyClients.size(); count > 0; --count) {
+        int clientSocket = readyClients.front();
+        readyClients.pop_front();
+
+        Client* client = clients.find(clientSocket);
+        if (!client || !client->getInputBudget().queued)
+            continue;
+        client->getInputBudget().queued = false;
+        if (!client->isClosing())
+            resumeClient(client);
     }
 }
 
+/**
+ * @brief Attente maximale de la boucle : nulle si des clients attendent
+ * leur tour, s'il reste des événements de réacteurs ou des déconnexions à
+ * traiter, sinon jusqu'au prochain timer.
+ */
+int Server::nextWaitTimeout() const {
+    if (!readyClients.empty() || reactorBacklog || !pendingDisconnects.empty())
+        return 0;
+    return timers.nextTimeoutMs();
+}
 
 /**
  * @brief Gère la commande PRIVMSG pour envoyer un message privé.
@@ -301,24 +1729,18 @@ void Server::handleClientMessage(int clientSocket) {
  */
 void Server::handlePrivMsg(int clientSocket, const std::string& target, const std::string& message) {
     if (message.empty()) {
-        send(clientSocket, "ERROR :No text to send\r\n", 25, 0);
+        sendToClient(clientSocket, "ERROR :No text to send\r\n");
         return;
     }
 
-    std::string cleanMessage = message;
-    size_t firstCharPos = cleanMessage.find_first_not_of(" \t\r\n");
-    if (firstCharPos != std::string::npos && cleanMessage[firstCharPos] == ':') {
-        cleanMessage = cleanMessage.substr(firstCharPos + 1);
-    }
-
-    std::string fullMessage = ":" + clients[clientSocket]->getNickname() +
-                              " PRIVMSG " + target + " :" + cleanMessage + "\r\n";
+    std::string line = ":" + clients[clientSocket]->getNickname() + " PRIVMSG " + target + " :" + message;
+    MessageBuffer fullMessage(line + "\r\n");
 
     if (!target.empty() && target[0] == '#') {
         if (channels.find(target) == channels.end()) {
             std::string errorMsg = ":irc.42server.com 403 " + clients[clientSocket]->getNickname() +
                                    " " + target + " :No such channel\r\n";
-            send(clientSocket, errorMsg.c_str(), errorMsg.size(), 0);
+            sendToClient(clientSocket, errorMsg);
             return;
         }
 
@@ -326,26 +1748,24 @@ void Server::handlePrivMsg(int clientSocket, const std::string& target, const st
         if (!channel->isClientInChannel(clientSocket)) {
             std::string errorMsg = ":irc.42server.com 442 " + clients[clientSocket]->getNickname() +
                                    " " + target + " :You're not on that channel\r\n";
-            send(clientSocket, errorMsg.c_str(), errorMsg.size(), 0);
+            sendToClient(clientSocket, errorMsg);
             return;
         }
 
-        channel->broadcast(fullMessage, clientSocket);
+        broadcast(channel, fullMessage, clientSocket);
+        history.append(channel->getHistory(), line, HistoryStore::wallClockMs());
+        if (archive)
+            archive->record(ARCHIVE_PRIVMSG, target, clients[clientSocket]->getNickname(), message);
         return;
     }
 
-    bool userFound = false;
-    for (std::map<int, Client*>::iterator it = clients.begin(); it != clients.end(); ++it) {
-        if (it->second->getNickname() == target) {
-            send(it->second->getSocketFd(), fullMessage.c_str(), fullMessage.size(), 0);
-            userFound = true;
-            break;
-        }
-    }
-    if (!userFound) {
+    Client* recipient = nicknames.find(target);
+    if (recipient) {
+        sendToClient(recipient->getSocketFd(), fullMessage);
+    } else {
         std::string errorMsg = ":irc.42server.com 401 " + clients[clientSocket]->getNickname() +
                                " " + target + " :No such nick/channel\r\n";
-        send(clientSocket, errorMsg.c_str(), errorMsg.size(), 0);
+        sendToClient(clientSocket, errorMsg);
     }
 }
 
@@ -371,18 +1791,14 @@ void Server::handlePass(int clientSocket, std::string& password)
     {
         password.erase(0, 1);
     }
-    if (clients.find(clientSocket) == clients.end()) {
-        return;
-    }
-
     if (clients[clientSocket]->isAuthenticated()) {
-        send(clientSocket, ":irc.42server.com 462 * :You may not reregister\r\n", 51, 0);
+        sendToClient(clientSocket, ":irc.42server.com 462 * :You may not reregister\r\n");
         return;
     }
 
     if (password != this->password) {
-        send(clientSocket, ":irc.42server.com 464 * :Password incorrect\r\n", 50, 0);
-        removeClient(clientSocket);
+        sendToClient(clientSocket, ":irc.42server.com 464 * :Password incorrect\r\n");
+        expireClient(clientSocket, "Password incorrect");
         return;
     }
 
@@ -392,37 +1808,48 @@ void Server::handlePass(int clientSocket, std::string& password)
 /**
  * @brief Gère la commande NICK pour définir le pseudo du client.
  *
- * - Vérifie si le client est authentifié. Si non, renvoie une erreur.
- * - Met à jour le pseudo du client avec la valeur fournie.
+ * - L'authentification (PASS) est vérifiée en amont par la table de dispatch.
+ * - Vérifie via l'index des pseudos (casemapping RFC 1459) que le pseudo est libre.
+ * - Met à jour le pseudo du client et l'index avec la valeur fournie.
  * - Envoie une confirmation au client avec le nouveau pseudo.
  *
  * @param clientSocket Le descripteur de fichier du client.
  * @param nickname Le pseudo choisi par le client.
  */
 void Server::handleNick(int clientSocket, const std::string& nickname) {
-    if (!clients[clientSocket]->isAuthenticated()) {
-        send(clientSocket, ":irc.42server.com 451 * :You must specify a password first\r\n", 58, 0);
+    if (nickname.empty()) {
+        sendToClient(clientSocket, ":irc.42server.com 431 * :No nickname given\r\n");
         return;
     }
 
-    for (std::map<int, Client*>::iterator it = clients.begin(); it != clients.end(); ++it) {
-        if (it->second->getNickname() == nickname) {
-            std::string errorMsg = ":irc.42server.com 433 * " + nickname + " :Nickname is already in use\r\n";
-            send(clientSocket, errorMsg.c_str(), errorMsg.length(), 0);
-            return;
-        }
+    Client* owner = nicknames.find(nickname);
+    if (owner && owner != clients[clientSocket]) {
+        std::string errorMsg = ":irc.42server.com 433 * " + nickname + " :Nickname is already in use\r\n";
+        sendToClient(clientSocket, errorMsg);
+        return;
     }
 
+    std::string oldNickname = clients[clientSocket]->getNickname();
+    if (!oldNickname.empty())
+        nicknames.erase(oldNickname);
+    nicknames.insert(nickname, clients[clientSocket]);
     clients[clientSocket]->setNickname(nickname);
 
-    std::string nickMsg = ":" + nickname + " NICK :" + nickname + "\r\n";
-    send(clientSocket, nickMsg.c_str(), nickMsg.length(), 0);
+    const std::set<Channel*>& joined = clients[clientSocket]->getChannels();
+    for (std::set<Channel*>::const_iterator it = joined.begin(); it != joined.end(); ++it) {
+        if ((*it)->isOperator(clientSocket))
+            markChannelDirty(*it);
+    }
+
+    MessageBuffer nickMsg(":" + (oldNickname.empty() ? nickname : oldNickname) + " NICK :" + nickname + "\r\n");
+    sendToClient(clientSocket, nickMsg);
+    broadcastToPeers(clients[clientSocket], nickMsg);
 }
 
 /**
  * @brief Gère la commande USER pour définir les informations utilisateur du client.
  *
- * - Vérifie si le client est authentifié. Si non, renvoie une erreur.
+ * - L'authentification (PASS) est vérifiée en amont par la table de dispatch.
  * - Met à jour le nom d'utilisateur et le real name du client avec les valeurs fournies.
  * - Envoie une confirmation au client indiquant que les informations ont été mises à jour.
  *
@@ -431,13 +1858,8 @@ void Server::handleNick(int clientSocket, const std::string& nickname) {
  * @param realname Le real name défini par le client.
  */
 void Server::handleUser(int clientSocket, const std::string& username, const std::string& realname) {
-    if (!clients[clientSocket]->isAuthenticated()) {
-        send(clientSocket, ":irc.42server.com 451 * :You must specify a password first\r\n", 58, 0);
-        return;
-    }
-
     if (clients[clientSocket]->getUsername() != "") {
-        send(clientSocket, ":irc.42server.com 462 * :You may not reregister\r\n", 51, 0);
+        sendToClient(clientSocket, ":irc.42server.com 462 * :You may not reregister\r\n");
         return;
     }
 
@@ -450,7 +1872,7 @@ void Server::handleUser(int clientSocket, const std::string& username, const std
                                  clients[clientSocket]->getNickname() + "!" +
                                  clients[clientSocket]->getUsername() + "@localhost\r\n";
 
-        send(clientSocket, welcomeMsg.c_str(), welcomeMsg.size(), 0);
+        sendToClient(clientSocket, welcomeMsg);
     }
 }
 
@@ -458,25 +1880,21 @@ void Server::handleUser(int clientSocket, const std::string& username, const std
  * @brief Gère la commande JOIN pour qu'un client rejoigne un canal.
  */
 void Server::handleJoin(int clientSocket, const std::string& channelName, const std::string& password) {
-    if (channelName.empty()) {
-        send(clientSocket, ":irc.42server.com 461 JOIN :Not enough parameters\r\n", 50, 0);
-        return;
-    }
-
     bool isNewChannel = (channels.find(channelName) == channels.end());
     if (isNewChannel) {
         channels[channelName] = new Channel(channelName);
     }
     Channel* channel = channels[channelName];
+    bool savedOperator = channel->isSavedOperator(clients[clientSocket]->getNickname());
 
-    if (channel->getInviteOnly() && !channel->isInvited(clientSocket)) {
+    if (channel->getInviteOnly() && !channel->isInvited(clientSocket) && !savedOperator) {
         std::string errorMsg = ":irc.42server.com 473 " + clients[clientSocket]->getNickname() + " " + channelName + " :Cannot join channel (+i) - Invite only\r\n";
-        send(clientSocket, errorMsg.c_str(), errorMsg.length(), 0);
+        sendToClient(clientSocket, errorMsg);
         return;
     }
     if (!channel->getPassword().empty() && channel->getPassword() != password) {
         std::string errorMsg = ":irc.42server.com 475 " + clients[clientSocket]->getNickname() + " " + channelName + " :Cannot join channel (+k) - Incorrect password\r\n";
-        send(clientSocket, errorMsg.c_str(), errorMsg.length(), 0);
+        sendToClient(clientSocket, errorMsg);
         return;
     }
     if (channel->isInvited(clientSocket)) {
@@ -484,23 +1902,26 @@ void Server::handleJoin(int clientSocket, const std::string& channelName, const
     }
     if (channel->getUserLimit() != 0 && channel->getClients().size() >= static_cast<size_t>(channel->getUserLimit())) {
         std::string errorMsg = ":irc.42server.com 471 " + clients[clientSocket]->getNickname() + " " + channelName + " :Channel is full\r\n";
-        send(clientSocket, errorMsg.c_str(), errorMsg.size(), 0);
+        sendToClient(clientSocket, errorMsg);
         return;
     }
 
-    channel->addClient(clientSocket);
-    clients[clientSocket]->setCurrentChannel(channelName);
+    bool firstMember = channel->isEmpty();
+    channel->addClient(clients[clientSocket]);
+    shareMembership(channel, clients[clientSocket], true);
 
-    if (isNewChannel) {
+    if (savedOperator || (firstMember && !channel->hasSavedOperators())) {
+        channel->removeSavedOperator(clients[clientSocket]->getNickname());
         channel->addOperator(clientSocket);
+        markChannelDirty(channel);
     }
 
     std::string nick = clients[clientSocket]->getNickname();
     std::string serverName = "irc.42server.com";
 
-    std::string joinMsg = ":" + nick + " JOIN " + channelName + "\r\n";
+    MessageBuffer joinMsg(":" + nick + " JOIN " + channelName + "\r\n");
 
-    channel->broadcast(joinMsg, -1);
+    broadcast(channel, joinMsg, -1);
 
     std::string topicMsg;
     if (!channel->getTopic().empty()) {
@@ -508,24 +1929,13 @@ void Server::handleJoin(int clientSocket, const std::string& channelName, const
     } else {
         topicMsg = ":" + serverName + " 331 " + nick + " " + channelName + " :No topic is set\r\n";
     }
-    send(clientSocket, topicMsg.c_str(), topicMsg.size(), 0);
-
-    std::string userList = ":" + serverName + " 353 " + nick + " = " + channelName + " :";
-    const std::set<int>& channelClients = channel->getClients();
-    for (std::set<int>::iterator it = channelClients.begin(); it != channelClients.end(); ++it) {
-        if (it != channelClients.begin()) {
-            userList += " ";
-        }
-        std::string prefix = channel->isOperator(*it) ? "@" : "";
-        userList += prefix + clients[*it]->getNickname();
-    }
-    userList += "\r\n";
-    send(clientSocket, userList.c_str(), userList.size(), 0);
+    sendToClient(clientSocket, topicMsg);
 
-    std::string endOfListMsg = ":" + serverName + " 366 " + nick + " " + channelName + " :End of NAMES list\r\n";
-    send(clientSocket, endOfListMsg.c_str(), endOfListMsg.size(), 0);
+    sendNames(clientSocket, channel);
+    if (archive)
+        archive->record(ARCHIVE_JOIN, channelName, nick, "");
 
-    std::cout << "✅ [" << nick << "] a rejoint le canal " << channelName << std::endl;
+    LOG_INFO("✅ [" << nick << "] a rejoint le canal " << channelName);
 }
 
 
@@ -534,38 +1944,26 @@ void Server::handleJoin(int clientSocket, const std::string& channelName, const
  */
 void Server::handlePart(int clientSocket, const std::string& channelName) {
     if (channels.find(channelName) == channels.end()) {
-        send(clientSocket, "ERROR :No such channel\r\n", 24, 0);
+        sendToClient(clientSocket, "ERROR :No such channel\r\n");
         return;
     }
     Channel* channel = channels[channelName];
     if (!channel->isClientInChannel(clientSocket)) {
-        send(clientSocket, "ERROR :You're not in this channel\r\n", 34, 0);
+        sendToClient(clientSocket, "ERROR :You're not in this channel\r\n");
         return;
     }
 
-    std::string partMsg = ":" + clients[clientSocket]->getNickname() + " PART " + channelName + "\r\n";
-
-    send(clientSocket, partMsg.c_str(), partMsg.length(), 0);
+    MessageBuffer partMsg(":" + clients[clientSocket]->getNickname() + " PART " + channelName + "\r\n");
 
-    channel->broadcast(partMsg, clientSocket);
-
-    channel->removeClient(clientSocket);
-    clients[clientSocket]->setCurrentChannel("");
+    sendToClient(clientSocket, partMsg);
 
-    if (channel->isOperator(clientSocket)) {
-        channel->removeOperator(clientSocket);
-        if (!channel->isEmpty()) {
-            int newOp = *channel->getClients().begin();
-            channel->addOperator(newOp);
-        }
-    }
+    broadcast(channel, partMsg, clientSocket);
+    if (archive)
+        archive->record(ARCHIVE_PART, channelName, clients[clientSocket]->getNickname(), "");
 
-    std::cout << "✅ Client " << clients[clientSocket]->getNickname() << " a quitté " << channelName << std::endl;
+    LOG_INFO("✅ Client " << clients[clientSocket]->getNickname() << " a quitté " << channelName);
 
-    if (channel->isEmpty()) {
-        delete channel;
-        channels.erase(channelName);
-    }
+    leaveChannel(channel, clientSocket);
 }
 
 
@@ -573,35 +1971,16 @@ void Server::handlePart(int clientSocket, const std::string& channelName) {
  * @brief Gère la commande QUIT lorsqu'un utilisateur quitte le serveur.
  */
 void Server::handleQuit(int clientSocket, const std::string& quitMessage) {
-    if (clients.find(clientSocket) == clients.end()) {
-        return;
-    }
-
     Client* client = clients[clientSocket];
     std::string nick = client->getNickname();
-    std::string fullQuitMessage = ":" + nick + " QUIT :" + (quitMessage.empty() ? "Client exited" : quitMessage) + "\r\n";
-
-    std::string currentChannel = client->getCurrentChannel();
-    if (!currentChannel.empty() && channels.find(currentChannel) != channels.end()) {
-        Channel* channel = channels[currentChannel];
-        channel->broadcast(fullQuitMessage, clientSocket);
-        send(clientSocket, fullQuitMessage.c_str(), fullQuitMessage.size(), 0);
-        channel->removeClient(clientSocket);
-        
-        if (channel->isOperator(clientSocket)) {
-            channel->removeOperator(clientSocket);
-            if (!channel->isEmpty()) {
-                int newOp = *channel->getClients().begin();
-                channel->addOperator(newOp);
-            }
-        }
-    }
-    send(clientSocket, fullQuitMessage.c_str(), fullQuitMessage.size(), 0);
-    close(clientSocket);
-    delete clients[clientSocket];
-    clients.erase(clientSocket);
+    MessageBuffer fullQuitMessage(":" + nick + " QUIT :" + (quitMessage.empty() ? "Client exited" : quitMessage) + "\r\n");
 
-    std::cout << "🚪 [" << nick << "] s'est déconnecté proprement.\n";
+    leaveAllChannels(clientSocket, fullQuitMessage);
+    sendToClient(clientSocket, fullQuitMessage);
+    client->markClosing(CLIENT_QUIT_REASON);
+    pendingDisconnects.push_back(clientSocket);
+
+    LOG_INFO("🚪 [" << nick << "] s'est déconnecté proprement.");
 }
 
 
@@ -611,7 +1990,7 @@ void Server::handleList(int clientSocket) {
     for (std::map<std::string, Channel*>::iterator it = channels.begin(); it != channels.end(); ++it) {
         listMsg += "- " + it->first + "\r\n";
     }
-    send(clientSocket, listMsg.c_str(), listMsg.length(), 0);
+    sendToClient(clientSocket, listMsg);
 }
 
 /**
@@ -619,28 +1998,30 @@ void Server::handleList(int clientSocket) {
  */
 void Server::handleKick(int clientSocket, const std::string& channelName, const std::string& targetNick) {
     if (channels.find(channelName) == channels.end()) {
-        send(clientSocket, "ERROR :No such channel\r\n", 24, 0);
+        sendToClient(clientSocket, "ERROR :No such channel\r\n");
         return;
     }
     Channel* channel = channels[channelName];
     if (!channel->isOperator(clientSocket)) {
-        send(clientSocket, "ERROR :You're not a channel operator\r\n", 38, 0);
+        sendToClient(clientSocket, "ERROR :You're not a channel operator\r\n");
         return;
     }
     int targetSocket = getClientSocketByNickname(targetNick);
     if (targetSocket == -1 || !channel->isClientInChannel(targetSocket)) {
-        send(clientSocket, "ERROR :User not in channel\r\n", 28, 0);
+        sendToClient(clientSocket, "ERROR :User not in channel\r\n");
         return;
     }
     
     std::string kickerNick = clients[clientSocket]->getNickname();
-    std::string kickMessage = ":" + kickerNick + "!" + clients[clientSocket]->getUsername() + "@localhost KICK " + channelName + " " + targetNick + " :Kicked by " + kickerNick + "\r\n";
-    
-    channel->broadcast(kickMessage, targetSocket);
+    MessageBuffer kickMessage(":" + kickerNick + "!" + clients[clientSocket]->getUsername() + "@localhost KICK " + channelName + " " + targetNick + " :Kicked by " + kickerNick + "\r\n");
     
-    send(targetSocket, kickMessage.c_str(), kickMessage.length(), 0);
+    broadcast(channel, kickMessage, targetSocket);
     
-    channel->removeClient(targetSocket);
+    sendToClient(targetSocket, kickMessage);
+    if (archive)
+        archive->record(ARCHIVE_KICK, channelName, kickerNick, targetNick);
+
+    leaveChannel(channel, targetSocket);
 }
 
 /**
@@ -649,7 +2030,7 @@ void Server::handleKick(int clientSocket, const std::string& channelName, const
 void Server::handleInvite(int clientSocket, const std::string& targetNick, const std::string& channelName) {
     if (channels.find(channelName) == channels.end()) {
         std::string errorMsg = ":irc.42server.com 403 " + clients[clientSocket]->getNickname() + " " + channelName + " :No such channel\r\n";
-        send(clientSocket, errorMsg.c_str(), errorMsg.length(), 0);
+        sendToClient(clientSocket, errorMsg);
         return;
     }
 
@@ -657,28 +2038,28 @@ void Server::handleInvite(int clientSocket, const std::string& targetNick, const
 
     if (!channel->isClientInChannel(clientSocket)) {
         std::string errorMsg = ":irc.42server.com 442 " + clients[clientSocket]->getNickname() + " " + channelName + " :You're not on that channel\r\n";
-        send(clientSocket, errorMsg.c_str(), errorMsg.length(), 0);
+        sendToClient(clientSocket, errorMsg);
         return;
     }
     if (!channel->isOperator(clientSocket)) {
         std::string errorMsg = ":irc.42server.com 482 " + clients[clientSocket]->getNickname() + " " + channelName + " :You're not a channel operator\r\n";
-        send(clientSocket, errorMsg.c_str(), errorMsg.length(), 0);
+        sendToClient(clientSocket, errorMsg);
         return;
     }
     int targetSocket = getClientSocketByNickname(targetNick);
     if (targetSocket == -1) {
         std::string errorMsg = ":irc.42server.com 401 " + clients[clientSocket]->getNickname() + " " + targetNick + " :No such nick\r\n";
-        send(clientSocket, errorMsg.c_str(), errorMsg.length(), 0);
+        sendToClient(clientSocket, errorMsg);
         return;
     }
 
     channel->inviteClient(targetSocket);
 
     std::string inviteMsg = ":irc.42server.com 341 " + clients[clientSocket]->getNickname() + " " + targetNick + " " + channelName + "\r\n";
-    send(clientSocket, inviteMsg.c_str(), inviteMsg.length(), 0);
+    sendToClient(clientSocket, inviteMsg);
 
     std::string noticeMsg = ":" + clients[clientSocket]->getNickname() + " INVITE " + targetNick + " " + channelName + "\r\n";
-    send(targetSocket, noticeMsg.c_str(), noticeMsg.length(), 0);
+    sendToClient(targetSocket, noticeMsg);
 }
 
 
@@ -688,7 +2069,7 @@ void Server::handleInvite(int clientSocket, const std::string& targetNick, const
 void Server::handleTopic(int clientSocket, const std::string& channelName, const std::string& topic) {
     if (channels.find(channelName) == channels.end()) {
         std::string errorMsg = ":irc.42server.com 403 " + clients[clientSocket]->getNickname() + " " + channelName + " :No such channel\r\n";
-        send(clientSocket, errorMsg.c_str(), errorMsg.size(), 0);
+        sendToClient(clientSocket, errorMsg);
         return;
     }
 
@@ -706,110 +2087,228 @@ void Server::handleTopic(int clientSocket, const std::string& channelName, const
                        " " + channelName + " :" + currentTopic + "\r\n";
         }
     
-        std::cout << "📩 Envoi du topic à " << clients[clientSocket]->getNickname() << " : " << response;
-        send(clientSocket, response.c_str(), response.size(), 0);
+        LOG_DEBUG("📩 Envoi du topic à " << clients[clientSocket]->getNickname() << " : " << currentTopic);
+        sendToClient(clientSocket, response);
         return;
     }
     
-    std::cout << "📌 Demande du topic pour " << channelName << std::endl;
+    LOG_DEBUG("📌 Demande du topic pour " << channelName);
 
 
     if (channel->getTopicRestricted() && !channel->isOperator(clientSocket)) {
         std::string errorMsg = ":irc.42server.com 482 " + clients[clientSocket]->getNickname() + " " + channelName + " :You're not a channel operator\r\n";
-        send(clientSocket, errorMsg.c_str(), errorMsg.size(), 0);
+        sendToClient(clientSocket, errorMsg);
         return;
     }
 
-    std::string cleanTopic = topic;
-    if (!cleanTopic.empty() && cleanTopic[0] == ':') {
-        cleanTopic.erase(0, 1);
+    channel->setTopic(topic);
+    markChannelDirty(channel);
+
+    MessageBuffer topicMessage(":" + clients[clientSocket]->getNickname() + "!" + clients[clientSocket]->getUsername() + "@localhost TOPIC " + channelName + " :" + topic + "\r\n");
+    broadcast(channel, topicMessage, -1);
+
+}
+
+
+/* -------------------------------------------------------------------------- */
+/*                              Modes de channel                              */
+/* -------------------------------------------------------------------------- */
+
+/**
+ * @brief Table des modes de channel.
+ *
+ * Ajouter un mode = ajouter une ligne ici et, si besoin, sa fonction.
+ * Champs : lettre, paramètre à l'ajout, paramètre au retrait, bit membre,
+ * fonction d'application.
+ */
+const ChannelModeDef Server::channelModeTable[] = {
+    { 'i', false, false, 0,            &Server::applyInviteOnly },
+    { 'k', true,  false, 0,            &Server::applyKey },
+    { 'l', true,  false, 0,            &Server::applyUserLimit },
+    { 'o', true,  true,  MEMBER_OP,    &Server::applyMemberMode },
+    { 't', false, false, 0,            &Server::applyTopicRestricted },
+    { 'v', true,  true,  MEMBER_VOICE, &Server::applyMemberMode }
+};
+
+const size_t Server::channelModeCount = sizeof(channelModeTable) / sizeof(channelModeTable[0]);
+
+const ChannelModeDef* Server::findChannelMode(char letter) {
+    for (size_t i = 0; i < channelModeCount; ++i) {
+        if (channelModeTable[i].letter == letter)
+            return &channelModeTable[i];
+    }
+    return NULL;
+}
+
+bool Server::applyInviteOnly(Channel* channel, int, const ChannelModeDef&, bool adding, std::string&) {
+    if (channel->getInviteOnly() == adding)
+        return false;
+    channel->setInviteOnly(adding);
+    return true;
+}
+
+bool Server::applyTopicRestricted(Channel* channel, int, const ChannelModeDef&, bool adding, std::string&) {
+    if (channel->getTopicRestricted() == adding)
+        return false;
+    channel->setTopicRestricted(adding);
+    return true;
+}
+
+bool Server::applyKey(Channel* channel, int, const ChannelModeDef&, bool adding, std::string& param) {
+    if (!adding) {
+        if (channel->getPassword().empty())
+            return false;
+        channel->setPassword("");
+        return true;
     }
+    if (param.empty() || param.find(' ') != std::string::npos)
+        return false;
+    channel->setPassword(param);
+    return true;
+}
 
-    std::string topicMessage = ":" + clients[clientSocket]->getNickname() + "!" + clients[clientSocket]->getUsername() + "@localhost TOPIC " + channelName + " :" + cleanTopic + "\r\n";
-    channel->broadcast(topicMessage, -1);
+/**
+ * @brief +l n'accepte qu'un entier strictement positif (sinon 461).
+ */
+bool Server::applyUserLimit(Channel* channel, int clientSocket, const ChannelModeDef&, bool adding, std::string& param) {
+    if (!adding) {
+        if (channel->getUserLimit() == 0)
+            return false;
+        channel->setUserLimit(0);
+        return true;
+    }
+    char* end = NULL;
+    long limit = std::strtol(param.c_str(), &end, 10);
+    if (param.empty() || *end != '\0' || limit <= 0 || limit > 1000000) {
+        sendToClient(clientSocket, ":irc.42server.com 461 " + clients[clientSocket]->getNickname() + " MODE :Invalid user limit\r\n");
+        return false;
+    }
+    channel->setUserLimit(static_cast<int>(limit));
+    std::ostringstream normalized;
+    normalized << limit;
+    param = normalized.str();
+    return true;
+}
 
+/**
+ * @brief +o/-o et +v/-v : la cible doit être membre du channel (sinon 441).
+ * Le paramètre diffusé est le pseudo exact de la cible. -o retire aussi un
+ * opérateur restauré qui n'est pas encore revenu.
+ */
+bool Server::applyMemberMode(Channel* channel, int clientSocket, const ChannelModeDef& mode, bool adding, std::string& param) {
+    if (!adding && mode.memberMode == MEMBER_OP && channel->removeSavedOperator(param))
+        return true;
+    Client* target = nicknames.find(param);
+    if (!target || !channel->isClientInChannel(target->getSocketFd())) {
+        sendToClient(clientSocket, ":irc.42server.com 441 " + clients[clientSocket]->getNickname() + " " + param + " " +
+                                   channel->getName() + " :They aren't on that channel\r\n");
+        return false;
+    }
+    const ChannelMember* member = channel->getClients().find(target->getSocketFd());
+    if (((member->modes & mode.memberMode) != 0) == adding)
+        return false;
+    channel->setMemberMode(target->getSocketFd(), mode.memberMode, adding);
+    param = target->getNickname();
+    return true;
 }
 
+/**
+ * @brief RPL_CHANNELMODEIS (324) : modes courants, clé visible des membres.
+ */
+void Server::sendChannelModes(int clientSocket, Channel* channel) {
+    std::string flags = "+";
+    std::string args;
+    if (channel->getInviteOnly())
+        flags += 'i';
+    if (channel->getTopicRestricted())
+        flags += 't';
+    if (!channel->getPassword().empty()) {
+        flags += 'k';
+        args += " " + (channel->isClientInChannel(clientSocket) ? channel->getPassword() : std::string("*"));
+    }
+    if (channel->getUserLimit() > 0) {
+        std::ostringstream limit;
+        limit << channel->getUserLimit();
+        flags += 'l';
+        args += " " + limit.str();
+    }
+    sendToClient(clientSocket, ":irc.42server.com 324 " + clients[clientSocket]->getNickname() + " " +
+                               channel->getName() + " " + flags + args + "\r\n");
+}
 
 /**
- * @brief Gère la commande MODE pour changer les paramètres d'un channel.
+ * @brief Gère la commande MODE sur un channel.
+ *
+ * - Sans chaîne de modes : renvoie les modes courants (324).
+ * - Sinon la chaîne est lue de gauche à droite ("+tk-l key") : chaque lettre
+ *   est validée contre channelModeTable et consomme au besoin le paramètre
+ *   suivant. Une lettre inconnue (472) ou un paramètre manquant (461) est
+ *   ignoré sans interrompre les suivantes.
+ * - Les changements effectifs sont fusionnés en un seul MODE diffusé au
+ *   channel ; rien n'est diffusé si aucun mode n'a changé.
  */
-void Server::handleMode(int clientSocket, const std::string& channelName, const std::string& mode, const std::string& param) {
-    if (channels.find(channelName) == channels.end()) {
-        std::string errorMsg = ":irc.42server.com 403 " + clients[clientSocket]->getNickname() + " " + channelName + " :No such channel\r\n";
-        send(clientSocket, errorMsg.c_str(), errorMsg.length(), 0);
+void Server::handleMode(int clientSocket, const std::string& channelName, const std::string& modes,
+                        const std::vector<std::string>& params) {
+    std::string nick = clients[clientSocket]->getNickname();
+    std::map<std::string, Channel*>::iterator found = channels.find(channelName);
+    if (found == channels.end()) {
+        sendToClient(clientSocket, ":irc.42server.com 403 " + nick + " " + channelName + " :No such channel\r\n");
         return;
     }
-    Channel* channel = channels[channelName];
+    Channel* channel = found->second;
 
+    if (modes.empty()) {
+        sendChannelModes(clientSocket, channel);
+        return;
+    }
     if (!channel->isOperator(clientSocket)) {
-        std::string errorMsg = ":irc.42server.com 482 " + clients[clientSocket]->getNickname() + " " + channelName + " :You're not a channel operator\r\n";
-        send(clientSocket, errorMsg.c_str(), errorMsg.length(), 0);
-        return;
-    }
-
-    std::string response = ":" + clients[clientSocket]->getNickname() + " MODE " + channelName + " " + mode;
-
-    if (mode == "+i") {
-        channel->setInviteOnly(true);
-        response += "\r\n";
-    } else if (mode == "-i") {
-        channel->setInviteOnly(false);
-        response += "\r\n";
-    } else if (mode == "+t") {
-        channel->setTopicRestricted(true);
-        response += "\r\n";
-    } else if (mode == "-t") {
-        channel->setTopicRestricted(false);
-        response += "\r\n";
-    } else if (mode == "+k") {
-        if (param.empty()) {
-            std::string errorMsg = ":irc.42server.com 461 " + clients[clientSocket]->getNickname() + " MODE :Not enough parameters\r\n";
-            send(clientSocket, errorMsg.c_str(), errorMsg.length(), 0);
-            return;
+        sendToClient(clientSocket, ":irc.42server.com 482 " + nick + " " + channelName + " :You're not a channel operator\r\n");
+        return;
+    }
+
+    std::string applied;
+    std::string appliedArgs;
+    char appliedSign = 0;
+    bool adding = true;
+    size_t nextParam = 0;
+
+    for (size_t i = 0; i < modes.size(); ++i) {
+        char letter = modes[i];
+        if (letter == '+' || letter == '-') {
+            adding = (letter == '+');
+            continue;
         }
-        channel->setPassword(param);
-        response += " " + param + "\r\n";
-    } else if (mode == "-k") {
-        channel->setPassword("");
-        response += "\r\n";
-    } else if (mode == "+o") {
-        int targetSocket = getClientSocketByNickname(param);
-        if (targetSocket == -1 || !channel->isClientInChannel(targetSocket)) {
-            std::string errorMsg = ":irc.42server.com 441 " + clients[clientSocket]->getNickname() + " " + param + " " + channelName + " :They aren't on that channel\r\n";
-            send(clientSocket, errorMsg.c_str(), errorMsg.length(), 0);
-            return;
+        const ChannelModeDef* mode = findChannelMode(letter);
+        if (!mode) {
+            sendToClient(clientSocket, ":irc.42server.com 472 " + nick + " " + std::string(1, letter) + " :is unknown mode char to me\r\n");
+            continue;
         }
-        channel->addOperator(targetSocket);
-        response += " " + param + "\r\n";
-    } else if (mode == "-o") {
-        int targetSocket = getClientSocketByNickname(param);
-        if (targetSocket == -1 || !channel->isClientInChannel(targetSocket)) {
-            std::string errorMsg = ":irc.42server.com 441 " + clients[clientSocket]->getNickname() + " " + param + " " + channelName + " :They aren't on that channel\r\n";
-            send(clientSocket, errorMsg.c_str(), errorMsg.length(), 0);
-            return;
+        std::string param;
+        if (adding ? mode->paramOnSet : mode->paramOnUnset) {
+            if (nextParam >= params.size()) {
+                sendToClient(clientSocket, ":irc.42server.com 461 " + nick + " MODE :Not enough parameters\r\n");
+                continue;
+            }
+            param = params[nextParam++];
         }
-        channel->removeOperator(targetSocket);
-        response += " " + param + "\r\n";
-    } else if (mode == "+l") {
-        if (param.empty() || atoi(param.c_str()) <= 0) {
-            std::string errorMsg = ":irc.42server.com 461 " + clients[clientSocket]->getNickname() + " MODE :Invalid user limit\r\n";
-            send(clientSocket, errorMsg.c_str(), errorMsg.length(), 0);
-            return;
+        if (!(this->*(mode->apply))(channel, clientSocket, *mode, adding, param))
+            continue;
+
+        char sign = adding ? '+' : '-';
+        if (sign != appliedSign) {
+            applied += sign;
+            appliedSign = sign;
         }
-        channel->setUserLimit(atoi(param.c_str()));
-        response += " " + param + "\r\n";
-    } else if (mode == "-l") {
-        channel->setUserLimit(0);
-        response += "\r\n";
-    } else {
-        std::string errorMsg = ":irc.42server.com 472 " + clients[clientSocket]->getNickname() + " " + mode + " :is unknown mode char to me\r\n";
-        send(clientSocket, errorMsg.c_str(), errorMsg.length(), 0);
-        return;
+        applied += letter;
+        if (!param.empty())
+            appliedArgs += " " + param;
     }
 
-    channel->broadcast(response, -1);
-    std::cout << "🔹 Mode appliqué : " << mode << " avec paramètre : " << param << " sur " << channelName << std::endl;
+    if (applied.empty())
+        return;
+    markChannelDirty(channel);
+    broadcast(channel, MessageBuffer(":" + nick + " MODE " + channelName + " " + applied + appliedArgs + "\r\n"), -1);
+    LOG_INFO("🔹 Modes appliqués : " << applied << appliedArgs << " sur " << channelName);
 }
 
 /**
@@ -824,10 +2323,291 @@ void Server::handleMode(int clientSocket, const std::string& channelName, const
  */
 void Server::handlePing(int clientSocket, const std::string& token) {
     std::string pongResponse = ":irc.42server.com PONG irc.42server.com :" + token + "\r\n";
-    send(clientSocket, pongResponse.c_str(), pongResponse.length(), 0);
-    std::cout << "✅ PING-PONG with token: " << token << std::endl;
+    sendToClient(clientSocket, pongResponse);
+    LOG_DEBUG("✅ PING-PONG with token: " << token);
+}
+
+
+/**
+ * @brief Gère la commande WHOIS.
+ *
+ * La liste des channels vient directement de Client::getChannels() :
+ * aucun parcours des channels du serveur.
+ *
+ * @param clientSocket Le descripteur du client demandeur.
+ * @param targetNick Le pseudo recherché.
+ */
+void Server::handleWhois(int clientSocket, const std::string& targetNick) {
+    std::string nick = clients[clientSocket]->getNickname();
+    Client* target = nicknames.find(targetNick);
+
+    if (!target) {
+        sendToClient(clientSocket, ":irc.42server.com 401 " + nick + " " + targetNick + " :No such nick/channel\r\n");
+        sendToClient(clientSocket, ":irc.42server.com 318 " + nick + " " + targetNick + " :End of WHOIS list\r\n");
+        return;
+    }
+
+    sendToClient(clientSocket, ":irc.42server.com 311 " + nick + " " + target->getNickname() + " " +
+                               target->getUsername() + " localhost * :" + target->getRealname() + "\r\n");
+
+    const std::set<Channel*>& joined = target->getChannels();
+    if (!joined.empty()) {
+        std::string channelList;
+        for (std::set<Channel*>::const_iterator it = joined.begin(); it != joined.end(); ++it) {
+            if (!channelList.empty())
+                channelList += " ";
+            if ((*it)->isOperator(target->getSocketFd()))
+                channelList += "@";
+            channelList += (*it)->getName();
+        }
+        sendToClient(clientSocket, ":irc.42server.com 319 " + nick + " " + target->getNickname() + " :" + channelList + "\r\n");
+    }
+
+    sendToClient(clientSocket, ":irc.42server.com 318 " + nick + " " + target->getNickname() + " :End of WHOIS list\r\n");
+}
+
+/**
+ * @brief Gère la commande OPER.
+ *
+ * Les identifiants viennent de l'option --oper=<nom>:<mot de passe> ; sans
+ * cette option, personne ne peut devenir opérateur.
+ *
+ * @param clientSocket Le descripteur du client demandeur.
+ * @param name Le nom d'opérateur.
+ * @param password Le mot de passe d'opérateur.
+ */
+void Server::handleOper(int clientSocket, const std::string& name, const std::string& password) {
+    Client* client = clients[clientSocket];
+    std::string nick = client->getNickname();
+
+    if (operName.empty() || name != operName || password != operPassword) {
+        LOG_WARN("⚠️  OPER refusé pour " << nick << " (fd: " << clientSocket << ")");
+        sendToClient(clientSocket, ":irc.42server.com 464 " + nick + " :Password incorrect\r\n");
+        return;
+    }
+    client->setServerOperator(true);
+    LOG_INFO("👑 " << nick << " est maintenant opérateur du serveur");
+    sendToClient(clientSocket, ":irc.42server.com 381 " + nick + " :You are now an IRC operator\r\n");
+}
+
+/**
+ * @brief Gère la commande STATS (réservée aux opérateurs du serveur).
+ *
+ * - `u` : temps de fonctionnement (242).
+ * - `m` : nombre d'appels par commande (212).
+ * - sans paramètre ou autre lettre : résumé du trafic et latences
+ *   p50/p99/max par commande, en microsecondes (249).
+ *
+ * @param clientSocket Le descripteur du client demandeur.
+ * @param query La lettre de la requête (peut être vide).
+ */
+void Server::handleStats(int clientSocket, const std::string& query) {
+    std::string nick = clients[clientSocket]->getNickname();
+    std::string letter = query.empty() ? "*" : query.substr(0, 1);
+    std::string prefix = ":irc.42server.com ";
+
+    if (!clients[clientSocket]->isServerOperator()) {
+        sendToClient(clientSocket, prefix + "481 " + nick + " :Permission Denied- You're not an IRC operator\r\n");
+        return;
+    }
+
+    MetricsShard* total = new MetricsShard();
+    Metrics::snapshot(*total);
+
+    if (letter == "u") {
+        long uptime = Metrics::getUptimeSeconds();
+        char buffer[64];
+        snprintf(buffer, sizeof(buffer), "%ld days %02ld:%02ld:%02ld",
+                 uptime / 86400, (uptime / 3600) % 24, (uptime / 60) % 60, uptime % 60);
+        sendToClient(clientSocket, prefix + "242 " + nick + " :Server Up " + buffer + "\r\n");
+    } else if (letter == "m") {
+        for (size_t i = 0; i < Metrics::getVerbCount(); ++i) {
+            if (!total->commandCounts[i])
+                continue;
+            std::ostringstream line;
+            line << prefix << "212 " << nick << " " << Metrics::getVerbName(i) << " "
+                 << total->commandCounts[i] << "\r\n";
+            sendToClient(clientSocket, line.str());
+        }
+    } else {
+        std::ostringstream summary;
+        summary << prefix << "249 " << nick << " :clients " << clients.size()
+                << " channels " << channels.size()
+                << " bytes in " << total->counters[METRIC_BYTES_RECEIVED]
+                << " out " << total->counters[METRIC_BYTES_SENT]
+                << " lines " << total->counters[METRIC_LINES_RECEIVED]
+                << " queued " << total->counters[METRIC_MESSAGES_QUEUED] << "\r\n";
+        sendToClient(clientSocket, summary.str());
+        for (size_t i = 0; i < Metrics::getVerbCount(); ++i) {
+            const LatencyHistogram& times = total->commandTimes[i];
+            if (!times.getCount())
+                continue;
+            std::ostringstream line;
+            line << prefix << "249 " << nick << " :" << Metrics::getVerbName(i)
+                 << " count " << times.getCount()
+                 << " p50 " << times.percentile(0.5) / 1000
+                 << "us p99 " << times.percentile(0.99) / 1000
+                 << "us max " << times.getMax() / 1000 << "us\r\n";
+            sendToClient(clientSocket, line.str());
+        }
+    }
+    delete total;
+    sendToClient(clientSocket, prefix + "219 " + nick + " " + letter + " :End of STATS report\r\n");
+}
+
+/**
+ * @brief Gère la commande NAMES (un channel).
+ *
+ * Un channel inexistant ne produit que RPL_ENDOFNAMES.
+ *
+ * @param clientSocket Le descripteur du client demandeur.
+ * @param channelName Le channel demandé (peut être vide).
+ */
+void Server::handleNames(int clientSocket, const std::string& channelName) {
+    std::map<std::string, Channel*>::iterator it = channels.find(channelName);
+    if (it != channels.end()) {
+        sendNames(clientSocket, it->second);
+        return;
+    }
+    std::string nick = clients[clientSocket]->getNickname();
+    std::string target = channelName.empty() ? "*" : channelName;
+    sendToClient(clientSocket, ":irc.42server.com 366 " + nick + " " + target + " :End of NAMES list\r\n");
+}
+
+/**
+ * @brief Positionne une référence `msgid=<id>` ou `timestamp=<server-time>`
+ * dans l'historique par dichotomie.
+ *
+ * @param position Premier message à la référence ou après.
+ * @param after Premier message strictement après la référence.
+ * @return false si la référence est mal formée.
+ */
+bool Server::findHistoryReference(const ChannelHistory& log, const std::string& reference,
+                                  size_t& position, size_t& after) {
+    if (reference.compare(0, 6, "msgid=") == 0) {
+        char* end = NULL;
+        unsigned long msgid = std::strtoul(reference.c_str() + 6, &end, 10);
+        if (reference.size() == 6 || *end != '\0')
+            return false;
+        position = log.lowerBoundId(msgid);
+        after = log.lowerBoundId(msgid + 1);
+        return true;
+    }
+    long time;
+    if (reference.compare(0, 10, "timestamp=") != 0 || !HistoryStore::parseTime(reference.substr(10), time))
+        return false;
+    position = log.lowerBoundTime(time);
+    after = log.lowerBoundTime(time + 1);
+    return true;
 }
 
+/**
+ * @brief Gère la commande IRCv3 CHATHISTORY (LATEST, BEFORE, AFTER, AROUND,
+ * BETWEEN).
+ *
+ * La référence est `*` (LATEST seulement), `msgid=<id>` ou
+ * `timestamp=<server-time>` ; elle est positionnée par dichotomie dans
+ * l'historique du channel. Les messages sont renvoyés du plus ancien au
+ * plus récent dans un BATCH chathistory, chacun avec ses tags time et msgid.
+ * BETWEEN exclut ses deux bornes et part de la première : si elle est la
+ * plus récente, ce sont les messages les plus proches d'elle qui sont
+ * gardés. Seuls les membres du channel peuvent relire son historique.
+ *
+ * @param clientSocket Le descripteur du client demandeur.
+ * @param subcommand LATEST, BEFORE, AFTER, AROUND ou BETWEEN.
+ * @param target Le channel.
+ * @param first La référence (la première borne pour BETWEEN).
+ * @param second La limite (la seconde borne pour BETWEEN).
+ * @param third La limite pour BETWEEN (ignoré sinon).
+ */
+void Server::handleChatHistory(int clientSocket, const std::string& subcommand, const std::string& target,
+                               const std::string& first, const std::string& second,
+                               const std::string& third) {
+    std::string prefix = ":irc.42server.com ";
+    std::string verb = subcommand;
+    for (size_t i = 0; i < verb.size(); ++i)
+        verb[i] = static_cast<char>(std::toupper(static_cast<unsigned char>(verb[i])));
+    if (verb != "LATEST" && verb != "BEFORE" && verb != "AFTER" && verb != "AROUND" && verb != "BETWEEN") {
+        sendToClient(clientSocket, prefix + "FAIL CHATHISTORY INVALID_PARAMS " + subcommand + " :Unknown subcommand\r\n");
+        return;
+    }
+    bool between = (verb == "BETWEEN");
+    const std::string& reference = first;
+    const std::string& limit = between ? third : second;
+
+    std::map<std::string, Channel*>::iterator found = channels.find(target);
+    if (found == channels.end() || !found->second->isClientInChannel(clientSocket)) {
+        sendToClient(clientSocket, prefix + "FAIL CHATHISTORY INVALID_TARGET " + verb + " " + target + " :Messages could not be retrieved\r\n");
+        return;
+    }
+    ChannelHistory& log = found->second->getHistory();
+
+    char* end = NULL;
+    long count = std::strtol(limit.c_str(), &end, 10);
+    if (limit.empty() || *end != '\0' || count <= 0) {
+        sendToClient(clientSocket, prefix + "FAIL CHATHISTORY INVALID_PARAMS " + verb + " " + limit + " :Invalid limit\r\n");
+        return;
+    }
+    size_t wanted = static_cast<size_t>(count);
+    if (wanted > history.maxLines())
+        wanted = history.maxLines();
+
+    size_t size = log.size();
+    size_t position = size;
+    size_t after = size;
+    size_t boundPosition = size;
+    size_t boundAfter = size;
+    if (reference == "*" && verb == "LATEST") {
+        after = 0;
+    } else if (!findHistoryReference(log, reference, position, after)) {
+        sendToClient(clientSocket, prefix + "FAIL CHATHISTORY INVALID_PARAMS " + verb + " " + reference + " :Invalid message reference\r\n");
+        return;
+    } else if (between && !findHistoryReference(log, second, boundPosition, boundAfter)) {
+        sendToClient(clientSocket, prefix + "FAIL CHATHISTORY INVALID_PARAMS " + verb + " " + second + " :Invalid message reference\r\n");
+        return;
+    }
+
+    size_t from = 0;
+    size_t to = 0;
+    if (verb == "LATEST") {
+        to = size;
+        from = (size - after > wanted) ? size - wanted : after;
+    } else if (verb == "BEFORE") {
+        to = position;
+        from = (to > wanted) ? to - wanted : 0;
+    } else if (verb == "AFTER") {
+        from = after;
+        to = (size - from > wanted) ? from + wanted : size;
+    } else if (verb == "AROUND") {
+        from = (position > wanted / 2) ? position - wanted / 2 : 0;
+        to = (size - from > wanted) ? from + wanted : size;
+        from = (to > wanted) ? to - wanted : 0;
+    } else if (position <= boundPosition) {
+        from = after;
+        to = (boundPosition > from) ? boundPosition : from;
+        if (to - from > wanted)
+            to = from + wanted;
+    } else {
+        from = boundAfter;
+        to = (position > from) ? position : from;
+        if (to - from > wanted)
+            from = to - wanted;
+    }
+    history.touch(log);
+
+    std::ostringstream batch;
+    batch << "history" << ++historyBatch;
+    sendToClient(clientSocket, prefix + "BATCH +" + batch.str() + " chathistory " + target + "\r\n");
+    for (size_t i = from; i < to; ++i) {
+        const HistoryEntry& entry = log.at(i);
+        std::ostringstream tags;
+        tags << "@batch=" << batch.str() << ";time=" << HistoryStore::formatTime(entry.time)
+             << ";msgid=" << entry.msgid << " ";
+        sendToClient(clientSocket, MessageBuffer(tags.str() + log.line(entry) + "\r\n"));
+    }
+    sendToClient(clientSocket, prefix + "BATCH -" + batch.str() + "\r\n");
+    LOG_DEBUG("📜 CHATHISTORY " << verb << " " << target << " : " << (to - from) << " messages");
+}
 
 /* -------------------------------------------------------------------------- */
 /*                                Utilitaires                                 */
@@ -836,20 +2616,55 @@ void Server::handlePing(int clientSocket, const std::string& token) {
 /**
  * @brief Trouve le socket d'un client à partir de son pseudo.
  *
+ * Recherche en temps constant dans l'index des pseudos (casemapping RFC 1459).
+ *
  * @param nickname Le pseudo du client à rechercher.
  * @return int Le descripteur de fichier du client, ou -1 si introuvable.
  */
 int Server::getClientSocketByNickname(const std::string& nickname) const {
-    for (std::map<int, Client*>::const_iterator it = clients.begin(); it != clients.end(); ++it) {
-        if (it->second->getNickname() == nickname) {
-            return it->first;
-        }
-    }
-    return -1;
+    Client* client = nicknames.find(nickname);
+    return client ? client->getSocketFd() : -1;
 }
 
-std::map<int, Client*>& Server::getClients() {
+ClientTable& Server::getClients() {
     return clients;
 }
 
+/**
+ * @brief Affiche l'occupation des pools de clients et de channels.
+ */
+void Server::logPoolStats() const {
+    const PoolStats& clientStats = Client::getPoolStats();
+    const PoolStats& channelStats = Channel::getPoolStats();
+
+    LOG_INFO("📊 Pool clients : " << clientStats.inUse << "/" << clientStats.capacity
+             << " utilisés (pic " << clientStats.peak << ", " << clientStats.slabs << " slabs, "
+             << clientStats.reuses << "/" << clientStats.allocations << " réutilisations)");
+    LOG_INFO("📊 Pool channels : " << channelStats.inUse << "/" << channelStats.capacity
+             << " utilisés (pic " << channelStats.peak << ", " << channelStats.slabs << " slabs, "
+             << channelStats.reuses << "/" << channelStats.allocations << " réutilisations)");
+}
 
+/**
+ * @brief Corps de la réponse GET /metrics : jauges propres au serveur
+ * (clients, channels, pools, journal), puis compteurs et histogrammes.
+ */
+std::string Server::renderMetrics() const {
+    const PoolStats& clientStats = Client::getPoolStats();
+    const PoolStats& channelStats = Channel::getPoolStats();
+    std::ostringstream out;
+
+    out << "# TYPE ircserv_clients gauge\n"
+        << "ircserv_clients " << clients.size() << "\n"
+        << "# TYPE ircserv_channels gauge\n"
+        << "ircserv_channels " << channels.size() << "\n"
+        << "# TYPE ircserv_pool_objects gauge\n"
+        << "ircserv_pool_objects{pool=\"client\",state=\"in_use\"} " << clientStats.inUse << "\n"
+        << "ircserv_pool_objects{pool=\"client\",state=\"capacity\"} " << clientStats.capacity << "\n"
+        << "ircserv_pool_objects{pool=\"channel\",state=\"in_use\"} " << channelStats.inUse << "\n"
+        << "ircserv_pool_objects{pool=\"channel\",state=\"capacity\"} " << channelStats.capacity << "\n"
+        << "# TYPE ircserv_log_records_dropped_total counter\n"
+        << "ircserv_log_records_dropped_total " << Logger::getDropped() << "\n"
+        << Metrics::renderPrometheus();
+    return out.str();
+}
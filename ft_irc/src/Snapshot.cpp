@@ -0,0 +1,321 @@
+/* ************************************************************************** */
+/*                                                                            */
+/*                                                        :::      ::::::::   */
+/*   Snapshot.cpp                                       :+:      :+:    :+:   */
+/*                                                    +:+ +:+         +:+     */
+/*   By: kpourcel <marvin@42.fr>                    +#+  +:+       +#+        */
+/*                                                +#+#+#+#+#+   +#+           */
+/*   Created: 2025/04/19 10:12:44 by kpourcel          #+#    #+#             */
+/*   Updated: 2025/04/19 10:12:44 by kpourcel         ###   ########.fr       */
+/*                                                                            */
+/* ************************************************************************** */
+
+#include "../include/Snapshot.hpp"
+#include "../include/ArchiveFormat.hpp"
+#include "../include/Logger.hpp"
+
+#include <cerrno>
+#include <csignal>
+#include <cstdio>
+#include <cstring>
+#include <fcntl.h>
+#include <poll.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+Snapshot::Snapshot(const std::string& path)
+    : path(path), mapped(NULL), mappedSize(0), readOffset(0), running(0) {}
+
+Snapshot::~Snapshot() {
+    stop();
+    unmap();
+}
+
+/* -------------------------------------------------------------------------- */
+/*                                  Encodage                                  */
+/* -------------------------------------------------------------------------- */
+
+/**
+ * @brief Ajoute l'enregistrement d'un channel à `out`.
+ */
+void Snapshot::encode(std::string& out, const std::string& name, unsigned int flags, int userLimit,
+                      const std::string& key, const std::string& topic,
+                      const std::vector<std::string>& operators) {
+    size_t count = operators.size() < ARCHIVE_FIELD_MAX ? operators.size() : ARCHIVE_FIELD_MAX;
+    ArchiveFormat::putField(out, name);
+    ArchiveFormat::putInt(out, flags, 1);
+    ArchiveFormat::putInt(out, static_cast<unsigned long>(userLimit), 4);
+    ArchiveFormat::putField(out, key);
+    ArchiveFormat::putField(out, topic);
+    ArchiveFormat::putInt(out, count, 2);
+    for (size_t i = 0; i < count; ++i)
+        ArchiveFormat::putField(out, operators[i]);
+}
+
+/**
+ * @brief Décode l'enregistrement qui commence à `offset` et avance après lui.
+ */
+bool Snapshot::decode(const char* data, size_t length, size_t& offset, SnapshotChannel& channel) {
+    if (!ArchiveFormat::readField(data, length, offset, channel.name) || offset + 5 > length)
+        return false;
+    channel.flags = static_cast<unsigned int>(ArchiveFormat::readInt(data + offset, 1));
+    channel.userLimit = static_cast<int>(ArchiveFormat::readInt(data + offset + 1, 4));
+    offset += 5;
+    if (!ArchiveFormat::readField(data, length, offset, channel.key)
+        || !ArchiveFormat::readField(data, length, offset, channel.topic)
+        || offset + 2 > length)
+        return false;
+    size_t count = ArchiveFormat::readInt(data + offset, 2);
+    offset += 2;
+    channel.operators.resize(count);
+    for (size_t i = 0; i < count; ++i) {
+        if (!ArchiveFormat::readField(data, length, offset, channel.operators[i]))
+            return false;
+    }
+    return !channel.name.empty() && channel.userLimit >= 0;
+}
+
+/* -------------------------------------------------------------------------- */
+/*                              Thread principal                              */
+/* -------------------------------------------------------------------------- */
+
+/**
+ * @brief Projette l'instantané existant en mémoire et vérifie son CRC.
+ *
+ * Un fichier corrompu (en-tête, taille ou CRC) est mis de côté sous
+ * <path>.corrupt et le serveur démarre sans état, plutôt que de l'écraser
+ * au premier instantané.
+ *
+ * @return false si le fichier existe mais ne peut pas être lu.
+ */
+bool Snapshot::open() {
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0)
+        return errno == ENOENT;
+    struct stat info;
+    if (fstat(fd, &info) < 0) {
+        close(fd);
+        return false;
+    }
+
+    size_t size = static_cast<size_t>(info.st_size);
+    void* region = (size > 0) ? mmap(NULL, size, PROT_READ, MAP_PRIVATE, fd, 0) : NULL;
+    close(fd);
+    if (region == MAP_FAILED)
+        return false;
+
+    const char* data = static_cast<const char*>(region);
+    bool valid = size >= SNAPSHOT_HEADER_SIZE
+        && std::memcmp(data, SNAPSHOT_MAGIC, SNAPSHOT_MAGIC_SIZE) == 0
+        && ArchiveFormat::readU32(data + 12) == size - SNAPSHOT_HEADER_SIZE
+        && ArchiveFormat::readU32(data + 16)
+            == ArchiveFormat::crc32(data + SNAPSHOT_HEADER_SIZE, size - SNAPSHOT_HEADER_SIZE);
+    if (!valid) {
+        if (region)
+            munmap(region, size);
+        std::string aside = path + ".corrupt";
+        rename(path.c_str(), aside.c_str());
+        LOG_ERROR("❌ Snapshot : " << path << " corrompu, mis de côté sous " << aside);
+        return true;
+    }
+    mapped = data;
+    mappedSize = size;
+    readOffset = SNAPSHOT_HEADER_SIZE;
+    return true;
+}
+
+/**
+ * @brief Décode le channel suivant de l'instantané ouvert.
+ *
+ * @return false à la fin du fichier (ou sur un enregistrement illisible,
+ * qui arrête la lecture : l'image de l'écrivain s'arrête au même endroit).
+ */
+bool Snapshot::next(SnapshotChannel& channel) {
+    if (!mapped || readOffset == mappedSize)
+        return false;
+    if (!decode(mapped, mappedSize, readOffset, channel)) {
+        LOG_ERROR("❌ Snapshot : enregistrement illisible à l'octet " << readOffset);
+        readOffset = mappedSize;
+        return false;
+    }
+    return true;
+}
+
+/**
+ * @brief Lance le thread d'écriture (signaux masqués), après la lecture :
+ * la projection de l'instantané lui appartient désormais.
+ */
+bool Snapshot::start() {
+    ArchiveFormat::crc32(NULL, 0);
+    sigset_t all;
+    sigset_t previous;
+    sigfillset(&all);
+    pthread_sigmask(SIG_SETMASK, &all, &previous);
+    __atomic_store_n(&running, 1, __ATOMIC_RELEASE);
+    int err = pthread_create(&writerThread, NULL, &Snapshot::writerMain, this);
+    pthread_sigmask(SIG_SETMASK, &previous, NULL);
+    if (err != 0) {
+        __atomic_store_n(&running, 0, __ATOMIC_RELEASE);
+        return false;
+    }
+    return true;
+}
+
+/**
+ * @brief Attend que l'écrivain ait appliqué et écrit les derniers deltas.
+ */
+void Snapshot::stop() {
+    if (!__atomic_load_n(&running, __ATOMIC_ACQUIRE))
+        return;
+    __atomic_store_n(&running, 0, __ATOMIC_RELEASE);
+    deltas.wake();
+    pthread_join(writerThread, NULL);
+}
+
+/**
+ * @brief Remet un delta au thread d'écriture, qui en devient propriétaire.
+ */
+void Snapshot::publish(SnapshotDelta* delta) {
+    if (!__atomic_load_n(&running, __ATOMIC_ACQUIRE)) {
+        delete delta;
+        return;
+    }
+    deltas.push(delta);
+    deltas.wake();
+}
+
+/* -------------------------------------------------------------------------- */
+/*                             Thread d'écriture                              */
+/* -------------------------------------------------------------------------- */
+
+void* Snapshot::writerMain(void* arg) {
+    static_cast<Snapshot*>(arg)->writerLoop();
+    return NULL;
+}
+
+/**
+ * @brief Attend les deltas ; plusieurs deltas en attente ne coûtent qu'une
+ * réécriture du fichier.
+ */
+void Snapshot::writerLoop() {
+    loadImage();
+    while (true) {
+        bool stopping = !__atomic_load_n(&running, __ATOMIC_ACQUIRE);
+        if (!stopping) {
+            struct pollfd wake;
+            wake.fd = deltas.getWakeFd();
+            wake.events = POLLIN;
+            poll(&wake, 1, -1);
+        }
+        deltas.acknowledge();
+        if (applyDeltas())
+            writeFile();
+        if (stopping)
+            break;
+    }
+}
+
+/**
+ * @brief Construit l'image initiale depuis la projection du fichier :
+ * chaque enregistrement est repris tel quel, sans réencodage. Le fichier
+ * est trié par nom, l'insertion en fin de map est en temps constant.
+ */
+void Snapshot::loadImage() {
+    SnapshotChannel channel;
+    size_t offset = SNAPSHOT_HEADER_SIZE;
+    while (mapped && offset < mappedSize) {
+        size_t start = offset;
+        if (!decode(mapped, mappedSize, offset, channel))
+            break;
+        image.insert(image.end(), std::make_pair(channel.name, std::string(mapped + start, offset - start)));
+    }
+    unmap();
+}
+
+void Snapshot::unmap() {
+    if (mapped)
+        munmap(const_cast<char*>(mapped), mappedSize);
+    mapped = NULL;
+    mappedSize = 0;
+}
+
+/**
+ * @brief Applique les deltas en attente à l'image.
+ *
+ * @return true si au moins un delta a été reçu.
+ */
+bool Snapshot::applyDeltas() {
+    bool changed = false;
+    SnapshotDelta* delta;
+    while (deltas.pop(delta)) {
+        for (size_t i = 0; i < delta->size(); ++i) {
+            SnapshotEntry& entry = (*delta)[i];
+            if (entry.record.empty())
+                image.erase(entry.name);
+            else
+                image[entry.name].swap(entry.record);
+        }
+        delete delta;
+        changed = true;
+    }
+    return changed;
+}
+
+static bool writeAll(int fd, const char* data, size_t length) {
+    while (length > 0) {
+        ssize_t written = write(fd, data, length);
+        if (written < 0) {
+            if (errno == EINTR)
+                continue;
+            return false;
+        }
+        data += written;
+        length -= static_cast<size_t>(written);
+    }
+    return true;
+}
+
+/**
+ * @brief Réécrit le fichier depuis l'image : <path>.tmp, fdatasync, rename,
+ * puis fsync du répertoire pour que le rename survive à une coupure.
+ */
+bool Snapshot::writeFile() {
+    buffer.clear();
+    buffer.append(SNAPSHOT_MAGIC, SNAPSHOT_MAGIC_SIZE);
+    ArchiveFormat::putInt(buffer, image.size(), 4);
+    ArchiveFormat::putInt(buffer, 0, 8);
+    for (std::map<std::string, std::string>::const_iterator it = image.begin(); it != image.end(); ++it)
+        buffer += it->second;
+
+    size_t length = buffer.size() - SNAPSHOT_HEADER_SIZE;
+    unsigned int crc = ArchiveFormat::crc32(buffer.data() + SNAPSHOT_HEADER_SIZE, length);
+    for (size_t i = 0; i < 4; ++i) {
+        buffer[12 + i] = static_cast<char>((length >> (8 * i)) & 0xff);
+        buffer[16 + i] = static_cast<char>((crc >> (8 * i)) & 0xff);
+    }
+
+    std::string temporary = path + ".tmp";
+    int fd = ::open(temporary.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0640);
+    if (fd < 0) {
+        LOG_ERROR("❌ Snapshot : ouverture de " << temporary << " : " << std::strerror(errno));
+        return false;
+    }
+    bool written = writeAll(fd, buffer.data(), buffer.size()) && fdatasync(fd) == 0;
+    close(fd);
+    if (!written || rename(temporary.c_str(), path.c_str()) < 0) {
+        LOG_ERROR("❌ Snapshot : écriture de " << path << " : " << std::strerror(errno));
+        unlink(temporary.c_str());
+        return false;
+    }
+
+    size_t slash = path.rfind('/');
+    std::string directory = (slash == std::string::npos) ? "." : path.substr(0, slash + 1);
+    int dirFd = ::open(directory.c_str(), O_RDONLY);
+    if (dirFd >= 0) {
+        fsync(dirFd);
+        close(dirFd);
+    }
+    LOG_DEBUG("💾 Snapshot : " << image.size() << " channel(s), " << buffer.size() << " octets");
+    return true;
+}
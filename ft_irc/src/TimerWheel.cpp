@@ -0,0 +1,218 @@
+/* ************************************************************************** */
+/*                                                                            */
+/*                                                        :::      ::::::::   */
+/*   TimerWheel.cpp                                     :+:      :+:    :+:   */
+/*                                                    +:+ +:+         +:+     */
+/*   By: kpourcel <marvin@42.fr>                    +#+  +:+       +#+        */
+/*                                                +#+#+#+#+#+   +#+           */
+/*   Created: 2025/04/16 09:41:07 by kpourcel          #+#    #+#             */
+/*   Updated: 2025/04/16 09:41:07 by kpourcel         ###   ########.fr       */
+/*                                                                            */
+/* ************************************************************************** */
+
+#include "../include/TimerWheel.hpp"
+
+#include <ctime>
+
+#define TIMER_SLOT_MASK     (TIMER_SLOTS - 1)
+#define TIMER_MAX_TICKS     ((1UL << (TIMER_LEVEL_BITS * TIMER_LEVELS)) - 1)
+
+/* -------------------------------------------------------------------------- */
+/*  Listes intrusives                                                         */
+/* -------------------------------------------------------------------------- */
+
+TimerLink::TimerLink() : prev(this), next(this) {}
+
+void TimerLink::unlink() {
+    prev->next = next;
+    next->prev = prev;
+    prev = this;
+    next = this;
+}
+
+bool TimerLink::linked() const {
+    return next != this;
+}
+
+static void appendLink(TimerLink& list, TimerLink* link) {
+    link->prev = list.prev;
+    link->next = &list;
+    list.prev->next = link;
+    list.prev = link;
+}
+
+/* -------------------------------------------------------------------------- */
+/*  Timer                                                                     */
+/* -------------------------------------------------------------------------- */
+
+Timer::Timer(int owner, int kind) : wheel(NULL), expires(0), owner(owner), kind(kind) {}
+
+Timer::~Timer() {
+    if (wheel)
+        wheel->cancel(*this);
+}
+
+bool Timer::pending() const {
+    return wheel != NULL;
+}
+
+int Timer::getOwner() const {
+    return owner;
+}
+
+int Timer::getKind() const {
+    return kind;
+}
+
+/* -------------------------------------------------------------------------- */
+/*  TimerWheel                                                                */
+/* -------------------------------------------------------------------------- */
+
+TimerWheel::TimerWheel() : currentTick(0), origin(monotonicMs()), active(0) {}
+
+/**
+ * @brief Horloge monotone en millisecondes.
+ */
+long TimerWheel::monotonicMs() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1000L + ts.tv_nsec / 1000000L;
+}
+
+/**
+ * @brief Heure de la roue (dernier `advance()`), en millisecondes
+ * monotones : lecture gratuite sur les chemins chauds.
+ */
+long TimerWheel::now() const {
+    return origin + static_cast<long>(currentTick) * TIMER_TICK_MS;
+}
+
+/**
+ * @brief Range un timer dans la case correspondant à son échéance : le
+ * niveau est choisi selon l'écart avec le tic courant.
+ */
+void TimerWheel::place(Timer& timer) {
+    unsigned long delta = timer.expires - currentTick;
+    size_t level = 0;
+
+    while (level + 1 < TIMER_LEVELS && delta >= (1UL << (TIMER_LEVEL_BITS * (level + 1))))
+        ++level;
+    size_t slot = (timer.expires >> (TIMER_LEVEL_BITS * level)) & TIMER_SLOT_MASK;
+    appendLink(slots[level][slot], &timer);
+}
+
+/**
+ * @brief Arme (ou réarme) un timer pour dans delayMs millisecondes,
+ * arrondi au tic supérieur.
+ */
+void TimerWheel::schedule(Timer& timer, long delayMs) {
+    cancel(timer);
+
+    unsigned long ticks = delayMs > 0 ? (delayMs + TIMER_TICK_MS - 1) / TIMER_TICK_MS : 1;
+    if (ticks == 0)
+        ticks = 1;
+    if (ticks > TIMER_MAX_TICKS)
+        ticks = TIMER_MAX_TICKS;
+    timer.expires = currentTick + ticks;
+    timer.wheel = this;
+    ++active;
+    place(timer);
+}
+
+/**
+ * @brief Désarme un timer (sans effet s'il ne l'est pas déjà).
+ */
+void TimerWheel::cancel(Timer& timer) {
+    if (timer.wheel != this)
+        return;
+    timer.unlink();
+    timer.wheel = NULL;
+    --active;
+}
+
+/**
+ * @brief Redescend les timers d'une case du niveau donné vers les niveaux
+ * inférieurs (leur échéance est désormais assez proche).
+ */
+void TimerWheel::cascade(size_t level) {
+    size_t slot = (currentTick >> (TIMER_LEVEL_BITS * level)) & TIMER_SLOT_MASK;
+    TimerLink pending;
+
+    if (!slots[level][slot].linked())
+        return;
+    pending.next = slots[level][slot].next;
+    pending.prev = slots[level][slot].prev;
+    pending.next->prev = &pending;
+    pending.prev->next = &pending;
+    slots[level][slot].next = &slots[level][slot];
+    slots[level][slot].prev = &slots[level][slot];
+
+    while (pending.linked()) {
+        Timer* timer = static_cast<Timer*>(pending.next);
+        timer->unlink();
+        place(*timer);
+    }
+}
+
+/**
+ * @brief Fait avancer la roue jusqu'à l'heure courante.
+ *
+ * Les timers échus passent dans la liste des expirés, à vider avec
+ * `popExpired()`. Une roue vide saute directement à l'heure courante.
+ */
+void TimerWheel::advance() {
+    unsigned long target = static_cast<unsigned long>(monotonicMs() - origin) / TIMER_TICK_MS;
+
+    if (active == 0 && !expired.linked()) {
+        currentTick = target;
+        return;
+    }
+    while (currentTick < target) {
+        ++currentTick;
+        for (size_t level = 1; level < TIMER_LEVELS; ++level) {
+            if ((currentTick >> (TIMER_LEVEL_BITS * (level - 1))) & TIMER_SLOT_MASK)
+                break;
+            cascade(level);
+        }
+        TimerLink& slot = slots[0][currentTick & TIMER_SLOT_MASK];
+        while (slot.linked()) {
+            TimerLink* link = slot.next;
+            link->unlink();
+            appendLink(expired, link);
+        }
+    }
+}
+
+/**
+ * @brief Retire et renvoie le prochain timer expiré (NULL s'il n'y en a
+ * plus). Le timer est désarmé : l'appelant peut le réarmer.
+ */
+Timer* TimerWheel::popExpired() {
+    if (!expired.linked())
+        return NULL;
+    Timer* timer = static_cast<Timer*>(expired.next);
+    cancel(*timer);
+    return timer;
+}
+
+/**
+ * @brief Délai d'attente maximal de la boucle d'événements : jusqu'à la
+ * prochaine case non vide du premier niveau, ou jusqu'à la prochaine
+ * cascade. -1 si aucun timer n'est armé.
+ */
+int TimerWheel::nextTimeoutMs() const {
+    if (expired.linked())
+        return 0;
+    if (active == 0)
+        return -1;
+
+    unsigned long ticks = TIMER_SLOTS - (currentTick & TIMER_SLOT_MASK);
+    for (unsigned long i = 1; i < ticks; ++i) {
+        if (slots[0][(currentTick + i) & TIMER_SLOT_MASK].linked()) {
+            ticks = i;
+            break;
+        }
+    }
+    long wait = now() + static_cast<long>(ticks) * TIMER_TICK_MS - monotonicMs();
+    return wait > 0 ? static_cast<int>(wait) : 0;
+}
@@ -0,0 +1,51 @@
+/* ************************************************************************** */
+/*                                                                            */
+/*                                                        :::      ::::::::   */
+/*   TokenBucket.cpp                                    :+:      :+:    :+:   */
+/*                                                    +:+ +:+         +:+     */
+/*   By: kpourcel <marvin@42.fr>                    +#+  +:+       +#+        */
+/*                                                +#+#+#+#+#+   +#+           */
+/*   Created: 2025/04/16 15:26:40 by kpourcel          #+#    #+#             */
+/*   Updated: 2025/04/16 15:26:40 by kpourcel         ###   ########.fr       */
+/*                                                                            */
+/* ************************************************************************** */
+
+#include "../include/TokenBucket.hpp"
+
+/**
+ * @brief Un seau neuf est plein (rempli à la première demande).
+ */
+TokenBucket::TokenBucket() : tokens(0), updated(-1) {}
+
+/**
+ * @brief Consomme `cost` jetons si le seau en contient assez.
+ *
+ * @param now Heure courante (millisecondes monotones).
+ * @param rate Jetons ajoutés par seconde.
+ * @param burst Capacité du seau ; un coût supérieur est ramené à la capacité.
+ * @return 0 si les jetons ont été consommés, sinon le délai (ms) avant
+ *         qu'il y en ait assez (rien n'est consommé).
+ */
+long TokenBucket::take(long now, unsigned int cost, long rate, long burst) {
+    long capacity = burst * 1000;
+
+    if (updated < 0) {
+        tokens = capacity;
+        updated = now;
+    }
+    if (now > updated) {
+        tokens += (now - updated) * rate;
+        if (tokens > capacity)
+            tokens = capacity;
+        updated = now;
+    }
+
+    long needed = static_cast<long>(cost) * 1000;
+    if (needed > capacity)
+        needed = capacity;
+    if (tokens >= needed) {
+        tokens -= needed;
+        return 0;
+    }
+    return (needed - tokens + rate - 1) / rate;
+}
@@ -11,14 +11,27 @@
 /* ************************************************************************** */
 
 #include "../include/Server.hpp"
+#include <climits>
 
 Server* globalServerPtr = NULL;
 
+/**
+ * SIGINT : arrêt, fait par la boucle principale en tête d'itération, avec
+ * les channels dans un état cohérent (rien d'autre n'est sûr dans un
+ * gestionnaire).
+ */
 void signalHandler(int signum) {
-    if (globalServerPtr) {
-        std::cout << "\n🛑 Signal reçu (" << signum << "), arrêt du serveur...\n";
-        globalServerPtr->shutdownServer();
-    }
+    if (globalServerPtr)
+        globalServerPtr->requestShutdown(signum);
+}
+
+/**
+ * SIGUSR2 : mise à jour à chaud, faite par la boucle principale à
+ * l'itération suivante (rien d'autre n'est sûr dans un gestionnaire).
+ */
+void upgradeSignalHandler(int) {
+    if (globalServerPtr)
+        globalServerPtr->requestUpgrade(-1);
 }
 
 bool is_valid_port(const char* str) {
@@ -28,16 +41,35 @@ bool is_valid_port(const char* str) {
 }
 
 int main(int argc, char **argv) {
-    if (argc != 3 || !is_valid_port(argv[1])) {
-        std::cerr << "Usage: ./ircserv <port(1024-65535)> <password>" << std::endl;
+    ServerConfig config;
+    bool validOptions = true;
+    for (int i = 3; i < argc; ++i) {
+        if (!parseConfigOption(argv[i], config)) {
+            std::cerr << "Option invalide : " << argv[i] << std::endl;
+            validOptions = false;
+        }
+    }
+
+    if (argc < 3 || !is_valid_port(argv[1]) || !validOptions) {
+        std::cerr << "Usage: ./ircserv <port(1024-65535)> <password> [--backend=epoll|poll] [--sendq=<bytes>] [--threads=<1-64>] [--log-level=debug|info|warn|error] [--log-file=<path>] [--metrics-port=<port>] [--oper=<name>:<password>] [--ping-interval=<s>] [--ping-timeout=<s>] [--register-timeout=<s>] [--flood-rate=<n>] [--flood-burst=<n>] [--history-lines=<n>] [--history-memory=<bytes>] [--archive-dir=<path>] [--archive-segment-size=<bytes>] [--archive-segment-age=<s>] [--archive-sync-ms=<ms>] [--snapshot-file=<path>] [--snapshot-interval=<s>]" << std::endl;
         return 1;
     }
 
     int port = std::atoi(argv[1]);
     std::string password = argv[2];
 
+    char executable[PATH_MAX];
+    config.commandLine.assign(argv, argv + argc);
+    if (realpath(argv[0], executable))
+        config.commandLine[0] = executable;
+
+    if (!Logger::start(config.logLevel, config.logFile)) {
+        perror("Erreur Logger::start()");
+        return 1;
+    }
+
     try {
-        Server server(port, password);
+        Server server(port, password, config);
         globalServerPtr = &server;
 
         struct sigaction sigIntHandler;
@@ -46,11 +78,17 @@ int main(int argc, char **argv) {
         sigIntHandler.sa_flags = 0;
         sigaction(SIGINT, &sigIntHandler, NULL);
 
-        std::cout << "IRC Server started on port " << port << std::endl;
+        struct sigaction upgradeHandler;
+        upgradeHandler.sa_handler = upgradeSignalHandler;
+        sigemptyset(&upgradeHandler.sa_mask);
+        upgradeHandler.sa_flags = 0;
+        sigaction(SIGUSR2, &upgradeHandler, NULL);
+
+        LOG_INFO("IRC Server started on port " << port);
         server.run();
     }
     catch (std::exception &e) {
-        std::cerr << "Server exception: " << e.what() << std::endl;
+        LOG_ERROR("Server exception: " << e.what());
         return 1;
     }
 
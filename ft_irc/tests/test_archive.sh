@@ -0,0 +1,108 @@
+#!/bin/bash
+
+# Tests de l'archive des channels : le serveur écrit des segments,
+# ./irc_archive les relit et vérifie leur CRC.
+#
+# Usage : ./tests/test_archive.sh [port]
+
+source "$(dirname "$0")/test_lib.sh"
+
+PORT=${1:-6680}
+ARCHIVE_DIR="/tmp/ircserv_archive_$$"
+
+cleanup() {
+    stop_server
+    rm -rf "$ARCHIVE_DIR"
+}
+trap 'cleanup' EXIT
+
+echo "🚀 Compilation du projet et des outils..."
+build_server all tools
+rm -rf "$ARCHIVE_DIR"
+start_server "$PORT" --flood-rate=0 --archive-dir="$ARCHIVE_DIR" --archive-segment-size=4096
+
+connect_client alice "$PORT" alice
+connect_client bob "$PORT" bob
+
+# Chaque étape attend les réponses : l'ordre de l'archive est celui du serveur
+send_lines "$alice" "JOIN #arc"
+receive "$alice" > /dev/null
+send_lines "$bob" "JOIN #arc"
+receive "$bob" > /dev/null
+send_lines "$alice" "PRIVMSG #arc :bonjour bob" "PRIVMSG bob :message privé"
+receive "$alice" > /dev/null
+send_lines "$bob" "PART #arc :à plus" "JOIN #arc"
+receive "$bob" > /dev/null
+send_lines "$alice" "KICK #arc bob :dehors"
+filler=$(printf 'y%.0s' $(seq 1 200))
+for i in $(seq 1 30); do
+    send_lines "$alice" "PRIVMSG #arc :r$i $filler"
+done
+send_lines "$alice" "PRIVMSG #arc :dernier"
+receive "$alice" > /dev/null
+receive "$bob" > /dev/null
+stop_server
+
+# ---------------------------------------------------------------------------
+echo ""
+echo "📦 Relecture des segments écrits par le serveur"
+
+segments=$(ls "$ARCHIVE_DIR" 2> /dev/null | grep -cE '^segment-.*\.arc$')
+expect "rotation : plusieurs segments de 4 Ko" "$segments" "^([2-9]|[1-9][0-9]+)$"
+
+out=$(./irc_archive --format=text "$ARCHIVE_DIR" 2>&1)
+status=$?
+expect "archive valide : code de sortie 0" "$status" "^0$"
+expect "JOIN archivé" "$out" "^[0-9T:.-]+Z #arc JOIN alice$"
+expect "PRIVMSG de channel archivé" "$out" "^[0-9T:.-]+Z #arc PRIVMSG alice :bonjour bob$"
+expect_not "message privé non archivé" "$out" "message privé"
+expect "PART archivé" "$out" "^[0-9T:.-]+Z #arc PART bob$"
+expect "KICK archivé avec sa cible" "$out" "^[0-9T:.-]+Z #arc KICK alice bob$"
+expect "séquence JOIN, PRIVMSG, PART, JOIN, KICK" \
+    "$(grep -oE '#arc (JOIN|PART|KICK|PRIVMSG alice :bonjour)' <<< "$out" | cut -d' ' -f2 | tr '\n' ' ')" \
+    "^JOIN JOIN PRIVMSG PART JOIN KICK $"
+expect "événements dans l'ordre, à travers les segments" \
+    "$(grep -oE 'PRIVMSG alice :(r[0-9]+|dernier)' <<< "$out" | sed 's/.*://' | tr '\n' ' ')" \
+    "^(r[0-9]+ ){30}dernier $"
+expect "aucune perte : 30 messages de remplissage" "$(grep -c " :r[0-9]* $filler$" <<< "$out")" "^30$"
+
+json=$(./irc_archive --format=jsonl --channel=#arc "$ARCHIVE_DIR" 2>&1)
+expect "export JSON" "$json" '^\{"seq":[0-9]+,"time":"[^"]+Z","type":"KICK","channel":"#arc","nick":"alice","text":"bob"\}$'
+expect "filtre --channel" "$(./irc_archive --channel=#autre "$ARCHIVE_DIR" 2>&1)" "^$"
+
+# ---------------------------------------------------------------------------
+echo ""
+echo "🧨 Segments abîmés"
+
+last=$(ls "$ARCHIVE_DIR"/segment-*.arc | tail -n 1)
+broken="$ARCHIVE_DIR/broken.arc"
+
+cp "$last" "$broken"
+size=$(stat -c %s "$broken")
+printf 'Z' | dd of="$broken" bs=1 seek=$((size - 3)) conv=notrunc status=none
+out=$(./irc_archive "$broken" 2>&1)
+status=$?
+expect "CRC faux : code de sortie 1" "$status" "^1$"
+expect "CRC faux : enregistrement corrompu signalé" "$out" "enregistrement corrompu à l'offset [0-9]+$"
+expect_not "CRC faux : le dernier message n'est pas exporté" "$out" ":dernier$"
+
+cp "$last" "$broken"
+truncate -s $((size - 2)) "$broken"
+out=$(./irc_archive "$broken" 2>&1)
+status=$?
+expect "fin tronquée : code de sortie 1" "$status" "^1$"
+expect "fin tronquée : signalée" "$out" "enregistrement tronqué à l'offset [0-9]+$"
+expect "fin tronquée : les enregistrements précédents sont exportés" "$out" " :r30 "
+
+printf 'PASUNARC' > "$broken"
+out=$(./irc_archive "$broken" 2>&1)
+status=$?
+expect "en-tête invalide : code de sortie 1" "$status" "^1$"
+expect "en-tête invalide : signalé" "$out" "en-tête de segment invalide"
+
+./irc_archive "$ARCHIVE_DIR/absent.arc" > /dev/null 2>&1
+expect "segment absent : code de sortie 2" "$?" "^2$"
+./irc_archive --format=xml "$ARCHIVE_DIR" > /dev/null 2>&1
+expect "option inconnue : code de sortie 2" "$?" "^2$"
+
+finish_tests
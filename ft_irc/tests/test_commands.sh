@@ -0,0 +1,211 @@
+#!/bin/bash
+
+# Tests des commandes IRC (réponses attendues du serveur).
+#
+# Usage : ./tests/test_commands.sh [port] [options du serveur...]
+#         (depuis ft_irc/ ou tests/ ; utilise aussi port+1)
+#         ex. : ./tests/test_commands.sh 6670 --threads=2
+
+source "$(dirname "$0")/test_lib.sh"
+
+PORT=${1:-6670}
+SERVER_OPTIONS=("${@:2}")
+
+# pipeline_case <port> <mode> : 1500 PRIVMSG envoyés d'un bloc, un sur deux
+# au channel et un sur deux en privé, à un destinataire qui ne lit pas
+# encore, puis 200 PING en rafale
+pipeline_case() {
+    local sender receiver payload out lines i
+    connect_client sender "$1" "send$2"
+    connect_client receiver "$1" "recv$2"
+    send_lines "$sender" "JOIN #pipe$2"
+    send_lines "$receiver" "JOIN #pipe$2"
+    receive "$receiver" > /dev/null
+    receive "$sender" > /dev/null
+    payload=$(printf 'p%.0s' $(seq 1 250))
+    lines=()
+    for i in $(seq 1 1500); do
+        if [ $((i % 2)) -eq 0 ]; then
+            lines+=("PRIVMSG recv$2 :$i $payload")
+        else
+            lines+=("PRIVMSG #pipe$2 :$i $payload")
+        fi
+    done
+    send_lines "$sender" "${lines[@]}"
+    sleep 0.5
+    out=$(receive "$receiver")
+    expect "[$2] 1500 réponses reçues, aucune perdue" "$(grep -c " :[0-9]* $payload$" <<< "$out")" "^1500$"
+    expect "[$2] channel et privé dans l'ordre d'envoi" \
+        "$(grep -oE ' :[0-9]+ ' <<< "$out" | tr -d ' :' | awk '$1 != NR { bad = 1 } END { print bad ? "désordre" : "ordre" }')" "^ordre$"
+    expect "[$2] aucune ligne coupée ou mêlée" \
+        "$(grep -cvE "^:send$2(!\S+)? PRIVMSG (recv|#pipe)$2 :[0-9]+ p{250}$" <<< "$out")" "^0$"
+    lines=()
+    for i in $(seq 1 200); do
+        lines+=("PING :t$i")
+    done
+    send_lines "$sender" "${lines[@]}"
+    out=$(receive "$sender")
+    expect "[$2] 200 PONG dans l'ordre" \
+        "$(grep -oE 'PONG .*:t[0-9]+$' <<< "$out" | grep -oE '[0-9]+$' | awk '$1 != NR { bad = 1 } END { print (NR == 200 && !bad) ? "ordre" : "désordre" }')" "^ordre$"
+    close_client "$sender"
+    close_client "$receiver"
+}
+
+echo "🚀 Compilation du projet..."
+build_server
+start_server "$PORT" --flood-rate=0 "${SERVER_OPTIONS[@]}"
+
+connect_client alice "$PORT" alice
+connect_client bob "$PORT" bob
+connect_client carol "$PORT" carol
+
+# ---------------------------------------------------------------------------
+echo ""
+echo "🔧 MODE"
+
+send_lines "$alice" "JOIN #modes"
+receive "$alice" > /dev/null
+
+send_lines "$alice" "MODE #modes +kl secret 2"
+out=$(receive "$alice")
+expect "+kl appliqué et diffusé en une ligne" "$out" "^:alice MODE #modes \+kl secret 2$"
+
+send_lines "$alice" "MODE #modes"
+out=$(receive "$alice")
+expect "324 liste +kl avec leurs paramètres" "$out" " 324 alice #modes \+[kl]{2} "
+
+send_lines "$bob" "JOIN #modes"
+out=$(receive "$bob")
+expect "JOIN sans clé refusé (475)" "$out" " 475 bob #modes "
+
+send_lines "$bob" "JOIN #modes secret"
+out=$(receive "$bob")
+expect "JOIN avec la clé accepté" "$out" "^:bob(!\S+)? JOIN #modes"
+receive "$alice" > /dev/null
+
+send_lines "$carol" "JOIN #modes secret"
+out=$(receive "$carol")
+expect "JOIN au-delà de +l refusé (471)" "$out" " 471 carol #modes "
+
+send_lines "$alice" "MODE #modes -l+i"
+out=$(receive "$alice")
+expect "-l+i appliqué et diffusé en une ligne" "$out" "^:alice MODE #modes -l\+i$"
+out=$(receive "$bob")
+expect "-l+i reçu par les membres" "$out" "^:alice MODE #modes -l\+i$"
+
+send_lines "$carol" "JOIN #modes secret"
+out=$(receive "$carol")
+expect "JOIN sur +i sans invitation refusé (473)" "$out" " 473 carol #modes "
+
+send_lines "$alice" "MODE #modes +l abc" "MODE #modes +l -5" "MODE #modes +l 0"
+out=$(receive "$alice")
+expect "+l non numérique, négatif ou nul refusé (461)" "$(grep -c ' 461 alice MODE :Invalid user limit' <<< "$out")" "^3$"
+expect_not "aucune limite invalide diffusée" "$out" "MODE #modes \+l"
+
+send_lines "$alice" "MODE #modes +l"
+out=$(receive "$alice")
+expect "+l sans paramètre refusé (461)" "$out" " 461 alice MODE :Not enough parameters"
+
+send_lines "$alice" "MODE #modes +z"
+out=$(receive "$alice")
+expect "lettre inconnue refusée (472)" "$out" " 472 alice z "
+
+send_lines "$bob" "MODE #modes +t"
+out=$(receive "$bob")
+expect "MODE par un non-opérateur refusé (482)" "$out" " 482 bob #modes "
+
+send_lines "$alice" "MODE #modes +o-k+t bob"
+out=$(receive "$alice")
+expect "+o-k+t fusionné en une seule diffusion" "$out" "^:alice MODE #modes \+o-k\+t bob$"
+
+send_lines "$alice" "MODE #modes +t"
+out=$(receive "$alice")
+expect_not "mode déjà actif non rediffusé" "$out" "MODE #modes"
+
+# ---------------------------------------------------------------------------
+echo ""
+echo "👋 PART, KICK et QUIT"
+
+connect_client dave "$PORT" dave
+connect_client erin "$PORT" erin
+connect_client frank "$PORT" frank
+
+send_lines "$dave" "JOIN #a" "JOIN #b" "JOIN #c"
+receive "$dave" > /dev/null
+send_lines "$erin" "JOIN #a" "JOIN #b"
+receive "$erin" > /dev/null
+send_lines "$frank" "JOIN #a"
+receive "$frank" > /dev/null
+receive "$dave" > /dev/null
+receive "$erin" > /dev/null
+
+send_lines "$erin" "WHOIS dave"
+out=$(receive "$erin")
+expect "WHOIS liste les channels du client (319)" "$(grep ' 319 ' <<< "$out" | grep -oE '#[abc]' | sort | tr '\n' ' ')" "^#a #b #c $"
+expect "WHOIS terminé (318)" "$out" " 318 erin dave :End of WHOIS list$"
+
+send_lines "$dave" "PART #b :salut"
+expect "PART diffusé aux membres" "$(receive "$erin")" "^:dave(!\S+)? PART #b"
+receive "$dave" > /dev/null
+send_lines "$erin" "WHOIS dave"
+expect "channel quitté retiré du WHOIS" "$(receive "$erin" | grep ' 319 ' | grep -oE '#[abc]' | sort | tr '\n' ' ')" "^#a #c $"
+send_lines "$dave" "PART #b"
+expect "PART d'un channel quitté refusé" "$(receive "$dave")" "You're not in this channel"
+
+send_lines "$dave" "QUIT :au revoir"
+out=$(receive "$erin")
+expect "QUIT reçu une seule fois malgré plusieurs channels communs" "$(grep -c '^:dave.* QUIT :au revoir' <<< "$out")" "^1$"
+expect "QUIT reçu par les autres membres" "$(receive "$frank")" "^:dave(!\S+)? QUIT :au revoir"
+close_client "$dave"
+
+send_lines "$erin" "NAMES #a"
+expect "droits d'opérateur transmis au membre suivant" "$(receive "$erin")" " 353 erin = #a :(@erin frank|frank @erin)$"
+send_lines "$frank" "JOIN #c"
+expect "channel vidé par QUIT supprimé puis recréé" "$(receive "$frank")" " 353 frank = #c :@frank$"
+send_lines "$erin" "WHOIS dave"
+expect_not "client parti absent du WHOIS" "$(receive "$erin")" " 311 erin dave "
+
+send_lines "$erin" "KICK #a frank :dehors"
+expect "KICK reçu par la cible" "$(receive "$frank")" "^:erin(!\S+)? KICK #a frank"
+receive "$erin" > /dev/null
+send_lines "$frank" "WHOIS frank"
+expect "channel du KICK retiré du WHOIS" "$(receive "$frank" | grep ' 319 ' | grep -oE '#[abc]' | tr '\n' ' ')" "^#c $"
+send_lines "$frank" "PRIVMSG #a :encore là ?"
+expect "membre exclu : plus de PRIVMSG sur le channel" "$(receive "$frank")" " (404|442) frank #a "
+
+# ---------------------------------------------------------------------------
+echo ""
+echo "📨 Réponses en rafale"
+
+pipeline_case "$PORT" main
+stop_server
+start_server $((PORT + 1)) --flood-rate=0 --threads=2
+pipeline_case $((PORT + 1)) threads
+
+# ---------------------------------------------------------------------------
+echo ""
+echo "🛑 Arrêt du serveur"
+
+connect_client grace $((PORT + 1)) grace
+send_lines "$grace" "JOIN #fin"
+receive "$grace" > /dev/null
+stop_server
+expect "ERROR reçu à l'arrêt en multi-thread" "$(receive "$grace")" "^ERROR :Server shutting down$"
+expect_not "aucune erreur de fermeture à l'arrêt" "$(cat "$SERVER_LOG")" "Bad file descriptor"
+close_client "$grace"
+
+# ---------------------------------------------------------------------------
+echo ""
+echo "🚦 Contrôle de flood"
+
+start_server $((PORT + 2)) --flood-rate=1 --flood-burst=5
+connect_client henry $((PORT + 2))
+lines=()
+for i in $(seq 1 20); do
+    lines+=("CAP LS")
+done
+send_lines "$henry" "${lines[@]}" "PING :apres-cap"
+expect_not "rafale de CAP freinée comme les autres commandes" "$(receive "$henry")" "PONG .*apres-cap"
+close_client "$henry"
+
+finish_tests
@@ -0,0 +1,125 @@
+#!/bin/bash
+
+# Tests de l'historique des channels (CHATHISTORY, anneau, budget mémoire).
+#
+# Le serveur garde 4 lignes par channel et son budget ne couvre que deux
+# historiques (2 x 736 octets) : les évictions sont faciles à provoquer.
+#
+# Usage : ./tests/test_history.sh [port] [options du serveur...]
+
+source "$(dirname "$0")/test_lib.sh"
+
+PORT=${1:-6675}
+SERVER_OPTIONS=("${@:2}")
+
+# Textes des PRIVMSG relus, dans l'ordre : "m1 m2 "
+texts() {
+    grep -oE "PRIVMSG $1 :[^ ]+" | sed 's/.* ://' | tr '\n' ' '
+}
+
+# msgid du message <texte> dans une relecture
+msgid_of() {
+    grep -E "PRIVMSG $1 :$2$" | grep -oE 'msgid=[0-9]+' | cut -d= -f2
+}
+
+echo "🚀 Compilation du projet..."
+build_server
+start_server "$PORT" --flood-rate=0 --history-lines=4 --history-memory=1500 "${SERVER_OPTIONS[@]}"
+
+connect_client alice "$PORT" alice
+connect_client bob "$PORT" bob
+
+# ---------------------------------------------------------------------------
+echo ""
+echo "📜 CHATHISTORY : sélecteurs"
+
+send_lines "$alice" "JOIN #s" "PRIVMSG #s :m1" "PRIVMSG #s :m2" "PRIVMSG #s :m3" "PRIVMSG #s :m4"
+receive "$alice" > /dev/null
+send_lines "$alice" "CHATHISTORY LATEST #s * 10"
+out=$(receive "$alice")
+expect "LATEST * renvoie tout, du plus ancien au plus récent" "$(texts '#s' <<< "$out")" "^m1 m2 m3 m4 $"
+expect "relecture encadrée par BATCH +/- préfixés" "$out" "^:irc.42server.com BATCH \+history[0-9]+ chathistory #s$"
+expect "BATCH de fin préfixé" "$out" "^:irc.42server.com BATCH -history[0-9]+$"
+expect "tags batch, time et msgid" "$out" "^@batch=history[0-9]+;time=[0-9]{4}-[0-9]{2}-[0-9]{2}T[0-9:.]{12}Z;msgid=[0-9]+ :alice"
+id1=$(msgid_of '#s' m1 <<< "$out")
+id2=$(msgid_of '#s' m2 <<< "$out")
+id3=$(msgid_of '#s' m3 <<< "$out")
+id4=$(msgid_of '#s' m4 <<< "$out")
+
+send_lines "$alice" "CHATHISTORY LATEST #s * 2"
+expect "LATEST * 2 : les deux derniers" "$(receive "$alice" | texts '#s')" "^m3 m4 $"
+send_lines "$alice" "CHATHISTORY LATEST #s msgid=$id2 10"
+expect "LATEST msgid : seulement après la référence" "$(receive "$alice" | texts '#s')" "^m3 m4 $"
+send_lines "$alice" "CHATHISTORY BEFORE #s msgid=$id3 10"
+expect "BEFORE msgid exclut la référence" "$(receive "$alice" | texts '#s')" "^m1 m2 $"
+send_lines "$alice" "CHATHISTORY BEFORE #s msgid=$id4 1"
+expect "BEFORE garde les plus proches" "$(receive "$alice" | texts '#s')" "^m3 $"
+send_lines "$alice" "CHATHISTORY AFTER #s msgid=$id1 2"
+expect "AFTER msgid, limité" "$(receive "$alice" | texts '#s')" "^m2 m3 $"
+send_lines "$alice" "CHATHISTORY AROUND #s msgid=$id3 2"
+expect "AROUND centré sur la référence" "$(receive "$alice" | texts '#s')" "^m2 m3 $"
+send_lines "$alice" "CHATHISTORY BETWEEN #s msgid=$id1 msgid=$id4 10"
+expect "BETWEEN exclut ses deux bornes" "$(receive "$alice" | texts '#s')" "^m2 m3 $"
+send_lines "$alice" "CHATHISTORY BETWEEN #s msgid=$id4 msgid=$id1 1"
+expect "BETWEEN à rebours garde le plus proche de la première borne" "$(receive "$alice" | texts '#s')" "^m3 $"
+send_lines "$alice" "CHATHISTORY AFTER #s timestamp=2000-01-01T00:00:00.000Z 2"
+expect "AFTER timestamp" "$(receive "$alice" | texts '#s')" "^m1 m2 $"
+send_lines "$alice" "CHATHISTORY BEFORE #s timestamp=2000-01-01T00:00:00.000Z 2"
+out=$(receive "$alice")
+expect "BEFORE un timestamp passé : BATCH vide" "$(texts '#s' <<< "$out")" "^$"
+expect "BATCH vide quand même envoyé" "$out" "BATCH -history"
+
+# ---------------------------------------------------------------------------
+echo ""
+echo "🚫 CHATHISTORY : erreurs"
+
+send_lines "$alice" "CHATHISTORY LATEST #s * 0"
+expect "limite nulle refusée" "$(receive "$alice")" "^:irc.42server.com FAIL CHATHISTORY INVALID_PARAMS LATEST 0 :Invalid limit$"
+send_lines "$alice" "CHATHISTORY LATEST #s * abc"
+expect "limite non numérique refusée" "$(receive "$alice")" "^:irc.42server.com FAIL CHATHISTORY INVALID_PARAMS LATEST abc :Invalid limit$"
+send_lines "$alice" "CHATHISTORY BEFORE #s * 2"
+expect "* refusé hors LATEST" "$(receive "$alice")" "^:irc.42server.com FAIL CHATHISTORY INVALID_PARAMS BEFORE \* :Invalid message reference$"
+send_lines "$alice" "CHATHISTORY AFTER #s msgid=x 2"
+expect "msgid mal formé refusé" "$(receive "$alice")" "FAIL CHATHISTORY INVALID_PARAMS AFTER msgid=x "
+send_lines "$alice" "CHATHISTORY BETWEEN #s msgid=$id1 nope 2"
+expect "seconde borne BETWEEN mal formée refusée" "$(receive "$alice")" "FAIL CHATHISTORY INVALID_PARAMS BETWEEN nope "
+send_lines "$alice" "CHATHISTORY SINCE #s * 2"
+expect "sous-commande inconnue refusée" "$(receive "$alice")" "^:irc.42server.com FAIL CHATHISTORY INVALID_PARAMS SINCE :Unknown subcommand$"
+send_lines "$bob" "CHATHISTORY LATEST #s * 2"
+expect "non-membre refusé" "$(receive "$bob")" "^:irc.42server.com FAIL CHATHISTORY INVALID_TARGET LATEST #s "
+send_lines "$alice" "CHATHISTORY LATEST #s *"
+expect "paramètres manquants (461)" "$(receive "$alice")" " 461 alice CHATHISTORY "
+
+# ---------------------------------------------------------------------------
+echo ""
+echo "🔁 Anneau et arène"
+
+send_lines "$alice" "PRIVMSG #s :m5" "PRIVMSG #s :m6" "CHATHISTORY LATEST #s * 10"
+out=$(receive "$alice")
+expect "anneau de 4 : les plus anciens écrasés" "$(texts '#s' <<< "$out")" "^m3 m4 m5 m6 $"
+expect "msgid conservés après écrasement" "$(msgid_of '#s' m3 <<< "$out")" "^$id3$"
+
+long=$(printf 'x%.0s' $(seq 1 250))
+send_lines "$alice" "JOIN #arena" "PRIVMSG #arena :a1$long" "PRIVMSG #arena :a2$long" "PRIVMSG #arena :a3$long"
+receive "$alice" > /dev/null
+send_lines "$alice" "CHATHISTORY LATEST #arena * 10"
+out=$(receive "$alice")
+expect "arène pleine : la ligne la plus ancienne libère sa place" "$(grep -oE 'PRIVMSG #arena :a[0-9]' <<< "$out" | tr '\n' ' ')" "^PRIVMSG #arena :a2 PRIVMSG #arena :a3 $"
+expect "lignes relues intactes après bouclage de l'arène" "$(grep -c "PRIVMSG #arena :a[23]$long$" <<< "$out")" "^2$"
+
+# ---------------------------------------------------------------------------
+echo ""
+echo "🧊 Budget mémoire (LRU)"
+
+send_lines "$alice" "CHATHISTORY LATEST #s * 1"
+receive "$alice" > /dev/null
+send_lines "$alice" "JOIN #c" "PRIVMSG #c :c1"
+receive "$alice" > /dev/null
+send_lines "$alice" "CHATHISTORY LATEST #arena * 10"
+expect "le channel le plus froid perd son historique" "$(receive "$alice" | grep -c 'PRIVMSG #arena')" "^0$"
+send_lines "$alice" "CHATHISTORY LATEST #s * 10"
+expect "le channel relu récemment garde le sien" "$(receive "$alice" | texts '#s')" "^m3 m4 m5 m6 $"
+send_lines "$alice" "CHATHISTORY LATEST #c * 10"
+expect "le nouveau channel a son historique" "$(receive "$alice" | texts '#c')" "^c1 $"
+
+finish_tests
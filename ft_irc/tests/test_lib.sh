@@ -0,0 +1,120 @@
+#!/bin/bash
+
+# Outils communs aux tests scriptés (à sourcer depuis tests/test_*.sh).
+#
+# Les clients sont des descripteurs /dev/tcp ouverts par bash : plusieurs
+# clients peuvent être tenus ouverts en même temps, sans dépendre de nc.
+
+SERVER_IP="127.0.0.1"
+PASSWORD="mypassword"
+TESTS_PASSED=0
+TESTS_FAILED=0
+SERVER_PID=""
+SERVER_LOG="/tmp/ircserv_test_$$.log"
+
+cd "$(dirname "$0")/.." || exit 1
+
+# Compile le serveur (et les outils si demandés : build_server tools)
+build_server() {
+    if ! make "$@" > /dev/null 2>&1 && ! make > /dev/null 2>&1; then
+        echo "❌ Erreur : la compilation a échoué."
+        exit 1
+    fi
+}
+
+# start_server <port> [options...] : lance ./ircserv et attend qu'il écoute
+start_server() {
+    local port=$1
+    shift
+    ./ircserv "$port" "$PASSWORD" "$@" >> "$SERVER_LOG" 2>&1 &
+    SERVER_PID=$!
+    for _ in $(seq 1 50); do
+        if (exec 9<>"/dev/tcp/$SERVER_IP/$port") 2> /dev/null; then
+            return 0
+        fi
+        sleep 0.1
+    done
+    echo "❌ Erreur : le serveur n'écoute pas sur le port $port (voir $SERVER_LOG)."
+    exit 1
+}
+
+# Arrête le serveur par SIGINT (arrêt propre, instantané final compris)
+stop_server() {
+    if [ -n "$SERVER_PID" ]; then
+        kill -INT "$SERVER_PID" 2> /dev/null
+        wait "$SERVER_PID" 2> /dev/null
+        SERVER_PID=""
+    fi
+}
+
+# connect_client <variable> <port> [pseudo] : ouvre une connexion et
+# l'enregistre (PASS/NICK/USER) si un pseudo est donné
+connect_client() {
+    local fd
+    exec {fd}<>"/dev/tcp/$SERVER_IP/$2" || exit 1
+    printf -v "$1" '%s' "$fd"
+    if [ -n "$3" ]; then
+        send_lines "$fd" "PASS $PASSWORD" "NICK $3" "USER $3 0 * :Test $3"
+        receive "$fd" > /dev/null
+    fi
+}
+
+close_client() {
+    eval "exec $1>&-"
+}
+
+# send_lines <fd> <ligne>... : envoie chaque ligne terminée par CRLF
+send_lines() {
+    local fd=$1
+    shift
+    printf '%s\r\n' "$@" >&"$fd"
+}
+
+# receive <fd> : affiche (sans CR) tout ce qui arrive avant un silence
+# de 0,3 s
+receive() {
+    local line
+    while IFS= read -r -t 0.3 line <&"$1"; do
+        printf '%s\n' "${line%$'\r'}"
+    done
+}
+
+# expect <description> <texte> <motif> : le texte contient le motif (ERE)
+expect() {
+    if grep -qE -- "$3" <<< "$2"; then
+        echo "✅ $1"
+        TESTS_PASSED=$((TESTS_PASSED + 1))
+    else
+        echo "❌ $1"
+        echo "   attendu : $3"
+        echo "   reçu    : $(head -c 400 <<< "$2" | tr '\n' '|')"
+        TESTS_FAILED=$((TESTS_FAILED + 1))
+    fi
+}
+
+# expect_not <description> <texte> <motif> : le motif est absent
+expect_not() {
+    if grep -qE -- "$3" <<< "$2"; then
+        echo "❌ $1"
+        echo "   inattendu : $(grep -E -- "$3" <<< "$2" | head -n 3 | tr '\n' '|')"
+        TESTS_FAILED=$((TESTS_FAILED + 1))
+    else
+        echo "✅ $1"
+        TESTS_PASSED=$((TESTS_PASSED + 1))
+    fi
+}
+
+# Bilan ; code de sortie 1 si un test a échoué
+finish_tests() {
+    stop_server
+    echo ""
+    echo "📋 $TESTS_PASSED réussi(s), $TESTS_FAILED échoué(s)"
+    if [ "$TESTS_FAILED" -ne 0 ]; then
+        echo "   journal du serveur : $SERVER_LOG"
+        exit 1
+    fi
+    rm -f "$SERVER_LOG"
+    exit 0
+}
+
+trap 'stop_server' EXIT
@@ -0,0 +1,98 @@
+#!/bin/bash
+
+# Tests des instantanés : l'état des channels (topic, modes, opérateurs)
+# survit à un arrêt par SIGINT, et un fichier abîmé est mis de côté.
+#
+# Usage : ./tests/test_snapshot.sh [port]   (utilise aussi port+1 et port+2)
+
+source "$(dirname "$0")/test_lib.sh"
+
+PORT=${1:-6685}
+SNAPSHOT_FILE="/tmp/ircserv_snapshot_$$.bin"
+
+cleanup() {
+    stop_server
+    rm -f "$SNAPSHOT_FILE" "$SNAPSHOT_FILE.corrupt"
+}
+trap 'cleanup' EXIT
+
+echo "🚀 Compilation du projet..."
+build_server
+rm -f "$SNAPSHOT_FILE" "$SNAPSHOT_FILE.corrupt"
+start_server "$PORT" --flood-rate=0 --snapshot-file="$SNAPSHOT_FILE" --snapshot-interval=1
+
+connect_client alice "$PORT" alice
+connect_client bob "$PORT" bob
+
+send_lines "$alice" "JOIN #keep" "TOPIC #keep :sujet conservé" "MODE #keep +tkl secret 5"
+receive "$alice" > /dev/null
+send_lines "$bob" "JOIN #keep secret"
+receive "$bob" > /dev/null
+send_lines "$alice" "MODE #keep +o bob" "JOIN #closed" "MODE #closed +i" "JOIN #gone" "PART #gone"
+receive "$alice" > /dev/null
+
+# ---------------------------------------------------------------------------
+echo ""
+echo "💾 Écriture"
+
+sleep 1.5
+expect "instantané écrit par le minuteur, avant l'arrêt" "$(test -s "$SNAPSHOT_FILE" && echo oui)" "^oui$"
+send_lines "$alice" "TOPIC #keep :dernier sujet"
+receive "$alice" > /dev/null
+stop_server
+expect "arrêt par SIGINT journalisé" "$(cat "$SERVER_LOG")" "Signal reçu"
+
+# ---------------------------------------------------------------------------
+echo ""
+echo "♻️  Restauration"
+
+start_server $((PORT + 1)) --flood-rate=0 --snapshot-file="$SNAPSHOT_FILE"
+expect "channels restaurés au démarrage" "$(cat "$SERVER_LOG")" "Snapshot : 2 channel\(s\) restauré\(s\)"
+
+connect_client carol $((PORT + 1)) carol
+send_lines "$carol" "JOIN #keep"
+expect "clé restaurée (475)" "$(receive "$carol")" " 475 carol #keep "
+send_lines "$carol" "JOIN #keep secret"
+out=$(receive "$carol")
+expect "topic du dernier arrêt restauré (332)" "$out" " 332 carol #keep :dernier sujet$"
+expect "premier arrivé sans droit : pas opérateur" "$out" " 353 carol = #keep :carol$"
+send_lines "$carol" "MODE #keep" "TOPIC #keep :volé"
+out=$(receive "$carol")
+expect "modes restaurés (324)" "$out" " 324 carol #keep \+tkl secret 5$"
+expect "+t restauré (482)" "$out" " 482 carol #keep "
+send_lines "$carol" "JOIN #closed"
+expect "+i restauré (473)" "$(receive "$carol")" " 473 carol #closed "
+
+connect_client bob $((PORT + 1)) bob
+send_lines "$bob" "JOIN #keep secret"
+out=$(receive "$bob")
+expect "opérateur restauré à son retour" "$out" " 353 bob = #keep :(carol @bob|@bob carol)$"
+connect_client alice $((PORT + 1)) alice
+send_lines "$alice" "JOIN #closed"
+out=$(receive "$alice")
+expect "opérateur sauvegardé : passe le +i" "$out" "^:alice JOIN #closed$"
+expect "opérateur sauvegardé : retrouve @" "$out" " 353 alice = #closed :@alice$"
+
+send_lines "$carol" "JOIN #gone"
+expect "channel vidé avant l'arrêt non restauré" "$(receive "$carol")" " 353 carol = #gone :@carol$"
+
+close_client "$alice"
+close_client "$bob"
+close_client "$carol"
+stop_server
+
+# ---------------------------------------------------------------------------
+echo ""
+echo "🧨 Fichier abîmé"
+
+size=$(stat -c %s "$SNAPSHOT_FILE")
+printf 'Z' | dd of="$SNAPSHOT_FILE" bs=1 seek=$((size - 2)) conv=notrunc status=none
+: > "$SERVER_LOG"
+start_server $((PORT + 2)) --flood-rate=0 --snapshot-file="$SNAPSHOT_FILE"
+expect "CRC faux : signalé" "$(cat "$SERVER_LOG")" "corrompu, mis de côté"
+expect "CRC faux : fichier mis de côté" "$(test -s "$SNAPSHOT_FILE.corrupt" && echo oui)" "^oui$"
+connect_client carol $((PORT + 2)) carol
+send_lines "$carol" "JOIN #keep"
+expect "CRC faux : démarrage sans état" "$(receive "$carol")" " 353 carol = #keep :@carol$"
+
+finish_tests
@@ -0,0 +1,133 @@
+#!/bin/bash
+
+# Tests de la mise à jour à chaud : après SIGUSR2 (puis la commande
+# UPGRADE), le nouveau processus garde les connexions, les lignes
+# incomplètes, l'état des channels, l'historique et les invitations.
+#
+# Usage : ./tests/test_upgrade.sh [port]   (utilise aussi port+1)
+
+source "$(dirname "$0")/test_lib.sh"
+
+PORT=${1:-6695}
+
+# Le processus repris n'est plus notre fils : on l'arrête à la main
+stop_upgraded() {
+    if [ -n "$UPGRADED_PID" ]; then
+        kill -INT "$UPGRADED_PID" 2> /dev/null
+        for _ in $(seq 1 50); do
+            kill -0 "$UPGRADED_PID" 2> /dev/null || break
+            sleep 0.1
+        done
+        UPGRADED_PID=""
+    fi
+}
+
+cleanup() {
+    stop_upgraded
+    stop_server
+}
+trap 'cleanup' EXIT
+
+# wait_upgrade <n> : attend la n-ième reprise et affiche le pid repreneur
+wait_upgrade() {
+    for _ in $(seq 1 50); do
+        pid=$(grep -oE 'remis au pid [0-9]+' "$SERVER_LOG" | sed -n "$1p" | grep -oE '[0-9]+$')
+        if [ -n "$pid" ]; then
+            echo "$pid"
+            return 0
+        fi
+        sleep 0.1
+    done
+}
+
+echo "🚀 Compilation du projet..."
+build_server
+start_server "$PORT" --flood-rate=0 --oper=admin:secret
+
+connect_client alice "$PORT" alice
+connect_client bob "$PORT" bob
+connect_client carol "$PORT" carol
+
+send_lines "$alice" "JOIN #up" "TOPIC #up :avant la mise à jour" "MODE #up +kl clef 5" "JOIN #inv" "MODE #inv +i" "INVITE carol #inv"
+send_lines "$bob" "JOIN #up clef"
+receive "$bob" > /dev/null
+send_lines "$alice" "PRIVMSG #up :m1" "PRIVMSG #up :m2" "CHATHISTORY LATEST #up * 10"
+before=$(receive "$alice")
+id2=$(grep -E 'PRIVMSG #up :m2$' <<< "$before" | grep -oE 'msgid=[0-9]+' | cut -d= -f2)
+batch1=$(grep -oE 'BATCH \+history[0-9]+' <<< "$before" | grep -oE '[0-9]+$')
+receive "$carol" > /dev/null
+
+# ---------------------------------------------------------------------------
+echo ""
+echo "🔒 Commande UPGRADE"
+
+send_lines "$bob" "UPGRADE"
+expect "UPGRADE réservé aux opérateurs (481)" "$(receive "$bob")" " 481 bob :Permission Denied"
+
+# ---------------------------------------------------------------------------
+echo ""
+echo "🔄 SIGUSR2"
+
+old_pid=$SERVER_PID
+printf 'PRIVMSG #up :moi' >&"$bob"
+sleep 0.2
+kill -USR2 "$old_pid"
+UPGRADED_PID=$(wait_upgrade 1)
+wait "$old_pid" 2> /dev/null
+SERVER_PID=""
+expect "reprise par un nouveau processus" "$UPGRADED_PID" "^[0-9]+$"
+expect_not "pid différent de l'ancien" "$UPGRADED_PID" "^$old_pid$"
+expect "ancien processus terminé" "$(kill -0 "$old_pid" 2> /dev/null || echo fini)" "^fini$"
+
+send_lines "$bob" " toujours là"
+expect "ligne incomplète complétée après la reprise" "$(receive "$alice")" "^:bob PRIVMSG #up :moi toujours là$"
+send_lines "$alice" "MODE #up" "TOPIC #up"
+out=$(receive "$alice")
+expect "modes conservés (324)" "$out" " 324 alice #up \+kl clef 5$"
+expect "topic conservé (332)" "$out" " 332 alice #up :avant la mise à jour$"
+send_lines "$alice" "CHATHISTORY LATEST #up * 10"
+after=$(receive "$alice")
+expect "historique conservé" "$(grep -oE 'PRIVMSG #up :[^ ]+' <<< "$after" | sed 's/.* ://' | tr '\n' ' ')" "^m1 m2 moi "
+expect "msgid conservés" "$(grep -E 'PRIVMSG #up :m2$' <<< "$after")" "msgid=$id2 "
+batch2=$(grep -oE 'BATCH \+history[0-9]+' <<< "$after" | grep -oE '[0-9]+$')
+expect "compteur de BATCH continué" "$([ "$batch2" -gt "$batch1" ] && echo oui)" "^oui$"
+send_lines "$carol" "JOIN #inv"
+expect "invitation conservée" "$(receive "$carol")" "^:carol JOIN #inv$"
+
+# ---------------------------------------------------------------------------
+echo ""
+echo "🔄 UPGRADE par un opérateur"
+
+send_lines "$alice" "OPER admin secret"
+expect "OPER accepté (381)" "$(receive "$alice")" " 381 alice "
+send_lines "$alice" "UPGRADE"
+expect "UPGRADE annoncé" "$(receive "$alice")" "NOTICE alice :Upgrading server$"
+first_pid=$UPGRADED_PID
+UPGRADED_PID=$(wait_upgrade 2)
+expect "deuxième reprise" "$UPGRADED_PID" "^[0-9]+$"
+expect_not "encore un nouveau processus" "$UPGRADED_PID" "^$first_pid$"
+send_lines "$alice" "PRIVMSG #up :m3"
+expect "messages relayés après deux reprises" "$(receive "$bob")" "^:alice PRIVMSG #up :m3$"
+send_lines "$alice" "CHATHISTORY LATEST #up * 1"
+out=$(receive "$alice")
+id3=$(grep -oE 'msgid=[0-9]+' <<< "$out" | cut -d= -f2)
+expect "msgid toujours croissants" "$([ "$id3" -gt "$id2" ] && echo oui)" "^oui$"
+close_client "$alice"
+close_client "$bob"
+close_client "$carol"
+stop_upgraded
+
+# ---------------------------------------------------------------------------
+echo ""
+echo "🧵 Mode réacteurs"
+
+start_server $((PORT + 1)) --flood-rate=0 --oper=admin:secret --threads=2
+connect_client alice $((PORT + 1)) alice
+send_lines "$alice" "OPER admin secret"
+receive "$alice" > /dev/null
+send_lines "$alice" "UPGRADE"
+expect "refusée avec --threads, le serveur continue" "$(receive "$alice")" "NOTICE alice :Upgrade failed: not supported with --threads$"
+send_lines "$alice" "PING :encore"
+expect "toujours servi" "$(receive "$alice")" "PONG .*encore"
+
+finish_tests
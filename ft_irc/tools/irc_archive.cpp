@@ -0,0 +1,189 @@
+/* ************************************************************************** */
+/*                                                                            */
+/*                                                        :::      ::::::::   */
+/*   irc_archive.cpp                                    :+:      :+:    :+:   */
+/*                                                    +:+ +:+         +:+     */
+/*   By: kpourcel <marvin@42.fr>                    +#+  +:+       +#+        */
+/*                                                +#+#+#+#+#+   +#+           */
+/*   Created: 2025/04/18 15:02:55 by kpourcel          #+#    #+#             */
+/*   Updated: 2025/04/18 15:02:55 by kpourcel         ###   ########.fr       */
+/*                                                                            */
+/* ************************************************************************** */
+
+#include "../include/ArchiveFormat.hpp"
+
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <ctime>
+#include <dirent.h>
+#include <sys/stat.h>
+
+/**
+ * Lecteur / exporteur des segments d'archive de ircserv.
+ *
+ * Vérifie chaque enregistrement (longueur et CRC32) et l'affiche en texte
+ * ou en JSON (une ligne par événement). Un répertoire est lu segment par
+ * segment, dans l'ordre des noms (donc de création).
+ *
+ * Usage : ./irc_archive [--format=text|jsonl] [--channel=<#chan>] <segment|répertoire>...
+ * Code de sortie : 0 si tout est valide, 1 si un segment est corrompu ou
+ * tronqué (les enregistrements valides qui précèdent sont tout de même
+ * exportés), 2 en cas d'erreur d'usage ou de lecture.
+ */
+
+static std::string formatTime(long time) {
+    time_t seconds = static_cast<time_t>(time / 1000);
+    struct tm utc;
+    gmtime_r(&seconds, &utc);
+    char out[32];
+    size_t used = strftime(out, sizeof(out), "%Y-%m-%dT%H:%M:%S", &utc);
+    snprintf(out + used, sizeof(out) - used, ".%03ldZ", time % 1000);
+    return out;
+}
+
+static std::string jsonString(const std::string& value) {
+    std::string out = "\"";
+    for (size_t i = 0; i < value.size(); ++i) {
+        unsigned char c = static_cast<unsigned char>(value[i]);
+        if (c == '"' || c == '\\') {
+            out += '\\';
+            out += static_cast<char>(c);
+        } else if (c < 0x20) {
+            char escaped[8];
+            snprintf(escaped, sizeof(escaped), "\\u%04x", c);
+            out += escaped;
+        } else {
+            out += static_cast<char>(c);
+        }
+    }
+    return out + "\"";
+}
+
+static void printRecord(const ArchiveRecord& record, bool json) {
+    const char* type = ArchiveFormat::typeName(record.type);
+    if (json) {
+        std::cout << "{\"seq\":" << record.sequence << ",\"time\":" << jsonString(formatTime(record.time))
+                  << ",\"type\":" << jsonString(type) << ",\"channel\":" << jsonString(record.channel)
+                  << ",\"nick\":" << jsonString(record.nick) << ",\"text\":" << jsonString(record.text)
+                  << "}\n";
+        return;
+    }
+    std::cout << formatTime(record.time) << " " << record.channel << " " << type << " " << record.nick;
+    if (!record.text.empty())
+        std::cout << (record.type == ARCHIVE_KICK ? " " : " :") << record.text;
+    std::cout << "\n";
+}
+
+/**
+ * @brief Exporte un segment.
+ *
+ * @return 0 si valide, 1 si corrompu ou tronqué, 2 si illisible.
+ */
+static int readSegment(const std::string& path, bool json, const std::string& channel) {
+    std::ifstream in(path.c_str(), std::ios::binary);
+    if (!in) {
+        std::cerr << path << " : lecture impossible" << std::endl;
+        return 2;
+    }
+    std::ostringstream content;
+    content << in.rdbuf();
+    std::string data = content.str();
+
+    if (data.size() < ARCHIVE_MAGIC_SIZE || data.compare(0, ARCHIVE_MAGIC_SIZE, ARCHIVE_MAGIC) != 0) {
+        std::cerr << path << " : en-tête de segment invalide" << std::endl;
+        return 1;
+    }
+
+    size_t offset = ARCHIVE_MAGIC_SIZE;
+    ArchiveRecord record;
+    while (offset < data.size()) {
+        if (data.size() - offset < ARCHIVE_HEADER_SIZE) {
+            std::cerr << path << " : enregistrement tronqué à l'offset " << offset << std::endl;
+            return 1;
+        }
+        size_t length = ArchiveFormat::readU32(&data[offset]);
+        unsigned int crc = ArchiveFormat::readU32(&data[offset + 4]);
+        if (length > ARCHIVE_RECORD_MAX || data.size() - offset - ARCHIVE_HEADER_SIZE < length) {
+            std::cerr << path << " : enregistrement tronqué à l'offset " << offset << std::endl;
+            return 1;
+        }
+        const char* payload = &data[offset + ARCHIVE_HEADER_SIZE];
+        if (ArchiveFormat::crc32(payload, length) != crc || !ArchiveFormat::decode(payload, length, record)) {
+            std::cerr << path << " : enregistrement corrompu à l'offset " << offset << std::endl;
+            return 1;
+        }
+        if (channel.empty() || record.channel == channel)
+            printRecord(record, json);
+        offset += ARCHIVE_HEADER_SIZE + length;
+    }
+    return 0;
+}
+
+/**
+ * @brief Segments d'un répertoire (segment-*.arc), triés par nom.
+ */
+static bool listSegments(const std::string& directory, std::vector<std::string>& out) {
+    DIR* dir = opendir(directory.c_str());
+    if (!dir)
+        return false;
+    std::vector<std::string> names;
+    while (struct dirent* entry = readdir(dir)) {
+        std::string name = entry->d_name;
+        if (name.compare(0, 8, "segment-") == 0 && name.size() > 4 && name.compare(name.size() - 4, 4, ".arc") == 0)
+            names.push_back(name);
+    }
+    closedir(dir);
+    std::sort(names.begin(), names.end());
+    for (size_t i = 0; i < names.size(); ++i)
+        out.push_back(directory + "/" + names[i]);
+    return true;
+}
+
+int main(int argc, char** argv) {
+    bool json = false;
+    std::string channel;
+    std::vector<std::string> segments;
+
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--format=jsonl") {
+            json = true;
+        } else if (arg == "--format=text") {
+            json = false;
+        } else if (arg.compare(0, 10, "--channel=") == 0) {
+            channel = arg.substr(10);
+        } else if (arg.compare(0, 2, "--") == 0) {
+            std::cerr << "Option inconnue : " << arg << std::endl;
+            return 2;
+        } else {
+            struct stat info;
+            if (stat(arg.c_str(), &info) == 0 && S_ISDIR(info.st_mode)) {
+                if (!listSegments(arg, segments)) {
+                    std::cerr << arg << " : lecture du répertoire impossible" << std::endl;
+                    return 2;
+                }
+            } else {
+                segments.push_back(arg);
+            }
+        }
+    }
+    if (segments.empty()) {
+        std::cerr << "Usage : ./irc_archive [--format=text|jsonl] [--channel=<#chan>] <segment|répertoire>..." << std::endl;
+        return 2;
+    }
+
+    int status = 0;
+    for (size_t i = 0; i < segments.size(); ++i) {
+        int result = readSegment(segments[i], json, channel);
+        if (result > status)
+            status = result;
+    }
+    std::cout.flush();
+    return status;
+}